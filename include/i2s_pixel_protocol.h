@@ -1,35 +1,320 @@
-/* I2S Pixel Protocol for WS2812/WS2812B LED strips
- * This file defines the protocol constants and lookup tables for
- * driving WS2812/WS2812B RGB and RGBW LED strips using I2S peripheral
+/* I2S Pixel Protocol for single-wire LED strips
+ * Chipset timing profiles and the I2S bitstream tables generated from them at
+ * compile time. Every LED data bit is sent as `subbits` I2S bits, so one 8-bit
+ * color value encodes to exactly `subbits` bytes of I2S data.
  */
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include "pixel_core.h"
+#include "pixel_color16.h"
 
-#ifdef __cplusplus
-extern "C" {
-#endif
+enum class PixelChipset : uint8_t {
+    WS2812B,
+    SK6812,
+    WS2811,        // 400 kHz low-speed mode
+    WS2815,
+    TM1814,        // Idle-high line, per-channel current setting header
+    WS2812B_FAST,  // Overclocked: shorter bit period, still inside the WS2812B pulse windows
+    SK6812_FAST,   // Overclocked: shorter bit period, still inside the SK6812 pulse windows
+};
 
-    // WS2812B timing constants
-#define WS2812B_ZERO 0b100  // Encoding for bit 0
-#define WS2812B_ONE  0b110  // Encoding for bit 1
+// Pulse windows a chipset accepts, in nanoseconds
+struct PixelTiming {
+    uint16_t t0h_min_ns, t0h_max_ns;  // High time read as a 0 bit
+    uint16_t t1h_min_ns, t1h_max_ns;  // High time read as a 1 bit
+    uint16_t tl_min_ns;               // Shortest low time after a bit
+    uint16_t bit_min_ns;              // Shortest bit period
+    uint16_t reset_us;                // Idle time that latches the frame
+};
 
-#define WS2812B_BYTES_PER_COLOR  3   // 3 bytes per color channel (24 bits encoded as 3 bytes)
-#define WS2812B_COLORS_PER_RGB   3   // RGB = 3 colors
-#define WS2812B_COLORS_PER_RGBW  4   // RGBW = 4 colors
-#define WS2812B_BYTES_PER_RGB    (WS2812B_BYTES_PER_COLOR * WS2812B_COLORS_PER_RGB)    // 9 bytes
-#define WS2812B_BYTES_PER_RGBW   (WS2812B_BYTES_PER_COLOR * WS2812B_COLORS_PER_RGBW)  // 12 bytes
+struct PixelProfile {
+    const char* name;
+    PixelTiming timing;
+    uint32_t bitrate;   // I2S bit clock
+    uint8_t subbits;    // I2S bits per LED data bit
+    bool inverted;      // Line idles high
+};
 
-#define WS2812B_BITRATE      2600000UL   // 2.6 Mbps = 385 ns/bit
-#define WS2812B_RESET_BITS   ((50 * WS2812B_BITRATE / 1000000UL) + 1) // 50 uS of zero bits
-#define WS2812B_RESET_BYTES  ((WS2812B_RESET_BITS + 7) / 8) // Zero bytes for reset
+inline constexpr std::array<PixelProfile, 7> PIXEL_PROFILES = {{
+    //               t0h        t1h       tl   bit  reset   bitrate sub inverted
+    {"WS2812B",      {250, 550, 650, 950, 300, 650,  50}, 2600000, 3, false},
+    {"SK6812",       {150, 450, 450, 750, 450, 650,  80}, 3200000, 4, false},
+    {"WS2811",       {350, 650, 1050, 1350, 1150, 1900, 50}, 1600000, 4, false},
+    {"WS2815",       {220, 380, 580, 1600, 220, 800, 280}, 3200000, 3, false},
+    {"TM1814",       {250, 450, 600, 900, 300, 1100, 200}, 2400000, 3, true},
+    {"WS2812B_FAST", {250, 550, 650, 950, 300, 650,  50}, 3000000, 3, false},
+    {"SK6812_FAST",  {150, 450, 450, 750, 450, 650,  80}, 4000000, 4, false},
+}};
 
-// Lookup table type for color encoding
-    typedef uint8_t ws2812b_color_encoding[WS2812B_BYTES_PER_COLOR];
+[[nodiscard]] constexpr const PixelProfile& pixelProfile(PixelChipset chipset) noexcept {
+    return PIXEL_PROFILES[static_cast<size_t>(chipset)];
+}
+
+// Subbits of high level needed to reach the minimum high time
+[[nodiscard]] constexpr uint8_t pixelHighSubbits(const PixelProfile& p, uint16_t min_ns) noexcept {
+    return static_cast<uint8_t>((static_cast<uint64_t>(min_ns) * p.bitrate + 999999999) / 1000000000);
+}
+
+[[nodiscard]] constexpr uint32_t pixelSubbitsToNs(const PixelProfile& p, uint32_t subbits) noexcept {
+    return static_cast<uint32_t>(static_cast<uint64_t>(subbits) * 1000000000 / p.bitrate);
+}
+
+// True if the generated waveform lands inside every pulse window of the chipset
+[[nodiscard]] constexpr bool pixelProfileValid(const PixelProfile& p) noexcept {
+    const uint8_t h0 = pixelHighSubbits(p, p.timing.t0h_min_ns);
+    const uint8_t h1 = pixelHighSubbits(p, p.timing.t1h_min_ns);
+    return h0 >= 1 && h0 < h1 && h1 < p.subbits &&
+           pixelSubbitsToNs(p, h0) <= p.timing.t0h_max_ns &&
+           pixelSubbitsToNs(p, h1) <= p.timing.t1h_max_ns &&
+           pixelSubbitsToNs(p, p.subbits - h1) >= p.timing.tl_min_ns &&
+           pixelSubbitsToNs(p, p.subbits) >= p.timing.bit_min_ns;
+}
+
+// Idle bytes that hold the line in reset long enough to latch
+[[nodiscard]] constexpr uint32_t pixelResetBytes(const PixelProfile& p) noexcept {
+    const uint64_t bits = static_cast<uint64_t>(p.timing.reset_us) * p.bitrate / 1000000 + 1;
+    return static_cast<uint32_t>((bits + 7) / 8);
+}
+
+static_assert(pixelProfileValid(pixelProfile(PixelChipset::WS2812B)));
+static_assert(pixelProfileValid(pixelProfile(PixelChipset::SK6812)));
+static_assert(pixelProfileValid(pixelProfile(PixelChipset::WS2811)));
+static_assert(pixelProfileValid(pixelProfile(PixelChipset::WS2815)));
+static_assert(pixelProfileValid(pixelProfile(PixelChipset::TM1814)));
+static_assert(pixelProfileValid(pixelProfile(PixelChipset::WS2812B_FAST)));
+static_assert(pixelProfileValid(pixelProfile(PixelChipset::SK6812_FAST)));
+
+// 256-entry table: value -> `subbits` bytes of MSB-first I2S bitstream
+template <PixelChipset C>
+constexpr std::array<uint8_t, 256 * pixelProfile(C).subbits> generateSymbolTable() {
+    constexpr const PixelProfile& p = pixelProfile(C);
+    constexpr uint8_t h0 = pixelHighSubbits(p, p.timing.t0h_min_ns);
+    constexpr uint8_t h1 = pixelHighSubbits(p, p.timing.t1h_min_ns);
+
+    std::array<uint8_t, 256 * p.subbits> table{};
+    for (uint32_t value = 0; value < 256; ++value) {
+        uint32_t bit_pos = 0;
+        for (int data_bit = 7; data_bit >= 0; --data_bit) {
+            const uint8_t high = ((value >> data_bit) & 1) ? h1 : h0;
+            for (uint8_t sub = 0; sub < p.subbits; ++sub, ++bit_pos) {
+                if ((sub < high) != p.inverted) {
+                    table[value * p.subbits + bit_pos / 8] |= static_cast<uint8_t>(0x80 >> (bit_pos % 8));
+                }
+            }
+        }
+    }
+    return table;
+}
+
+template <PixelChipset C>
+inline constexpr auto PIXEL_SYMBOL_TABLE = generateSymbolTable<C>();
+
+// The classic hand-written WS2812B table: 0 -> 100, 1 -> 110
+static_assert(PIXEL_SYMBOL_TABLE<PixelChipset::WS2812B>[0] == 0x92 &&
+              PIXEL_SYMBOL_TABLE<PixelChipset::WS2812B>[1] == 0x49 &&
+              PIXEL_SYMBOL_TABLE<PixelChipset::WS2812B>[2] == 0x24);
+static_assert(PIXEL_SYMBOL_TABLE<PixelChipset::WS2812B>[255 * 3] == 0xdb &&
+              PIXEL_SYMBOL_TABLE<PixelChipset::WS2812B>[255 * 3 + 1] == 0x6d &&
+              PIXEL_SYMBOL_TABLE<PixelChipset::WS2812B>[255 * 3 + 2] == 0xb6);
+
+// Runtime view of a chipset used by channels
+struct PixelProtocol {
+    const PixelProfile* profile;
+    const uint8_t* table;        // 256 * bytes_per_color entries
+    uint8_t bytes_per_color;
+    uint32_t reset_bytes;
+    uint8_t idle_byte;           // Reset/idle level of the line
+    const uint8_t* header;       // Raw values sent before the pixels (may be null)
+    uint8_t header_len;
+};
+
+[[nodiscard]] const PixelProtocol& getPixelProtocol(PixelChipset chipset) noexcept;
+
+// Encodes count pixels into out starting at byte pos, returns the end position.
+// Bytes are swapped pairwise for the 16-bit stereo slot order.
+using I2sEncodeFn = size_t (*)(const PixelColor* pixels, size_t count,
+                               const uint8_t* table, uint8_t* out, size_t pos);
+
+// Same, scaling each component to 8.8 fixed point and temporally dithering it: residue
+// holds the fraction left over per component from the previous frame, which is added
+// before rounding down, so over a few frames each LED averages to the unquantized level
+template <typename Pixel>
+using I2sDitherEncodeFn = size_t (*)(const Pixel* pixels, size_t count, uint16_t scale, uint8_t* residue,
+                                     const uint8_t* table, uint8_t* out, size_t pos);
+
+// Encodes a frame between two rendered keyframes: each component is lerped from -> to
+// at weight/256 (0..256) in 8.8 fixed point and scaled by 0..65535 in the same pass as
+// the table lookup. residue is only used by the temporally dithered variant.
+using I2sLerpEncodeFn = size_t (*)(const PixelColor* from, const PixelColor* to, size_t count,
+                                   uint16_t weight, uint16_t scale, uint8_t* residue,
+                                   const uint8_t* table, uint8_t* out, size_t pos);
+
+// Component between two keyframes at weight/256, in 8.8 fixed point
+[[nodiscard]] constexpr uint32_t lerpLevel(uint8_t from, uint8_t to, uint16_t weight) noexcept {
+    return static_cast<uint32_t>(from) * (256u - weight) + static_cast<uint32_t>(to) * weight;
+}
+
+// Component level in 8.8 fixed point after a 0..65535 scale (at most 255.0)
+[[nodiscard]] constexpr uint32_t ditherLevel(const PixelColor& pixel, uint8_t index, uint16_t scale) noexcept {
+    return (static_cast<uint32_t>(pixel.component(index)) * (static_cast<uint32_t>(scale) + 1)) >> 8;
+}
+[[nodiscard]] constexpr uint32_t ditherLevel(const PixelColor16& pixel, uint8_t index, uint16_t scale) noexcept {
+    return (static_cast<uint32_t>(scale16(pixel.component(index), scale)) * 255) >> 8;
+}
 
-    // Color lookup table - converts a single color value (0-255) to its I2S bitstream
-    extern const ws2812b_color_encoding ws2812b_color_lookup[256];
+// Encoder specialized on color order, format and encoded bytes per color: the
+// component order and all loop bounds are compile-time constants, so the inner
+// loop is a straight sequence of table lookups and stores
+template <ColorOrder Order, PixelFormat Format, uint8_t BytesPerColor>
+size_t encodePixels(const PixelColor* pixels, size_t count,
+                    const uint8_t* table, uint8_t* out, size_t pos) {
+    constexpr std::array<uint8_t, 4> order = colorOrderIndices(Order, Format);
+    constexpr size_t colors = static_cast<size_t>(Format);
 
-#ifdef __cplusplus
+    for (size_t i = 0; i < count; ++i) {
+        const PixelColor& pixel = pixels[i];
+        for (size_t c = 0; c < colors; ++c) {
+            const uint8_t* seq = &table[pixel.component(order[c]) * BytesPerColor];
+            for (size_t j = 0; j < BytesPerColor; ++j) {
+                out[(pos + j) ^ 1] = seq[j];
+            }
+            pos += BytesPerColor;
+        }
+    }
+    return pos;
 }
-#endif
+
+// The temporal dither fused into the encoder, so it costs one add and one mask per
+// component on top of the table lookup instead of a separate pass over the frame.
+// residue holds count * colors bytes in wire order.
+template <ColorOrder Order, PixelFormat Format, uint8_t BytesPerColor, typename Pixel>
+size_t encodePixelsDithered(const Pixel* pixels, size_t count, uint16_t scale, uint8_t* residue,
+                            const uint8_t* table, uint8_t* out, size_t pos) {
+    constexpr std::array<uint8_t, 4> order = colorOrderIndices(Order, Format);
+    constexpr size_t colors = static_cast<size_t>(Format);
+
+    for (size_t i = 0; i < count; ++i) {
+        const Pixel& pixel = pixels[i];
+        for (size_t c = 0; c < colors; ++c, ++residue) {
+            // At most 255.0 + 0.996, so the integer part never exceeds 255
+            const uint32_t level = ditherLevel(pixel, order[c], scale) + *residue;
+            *residue = static_cast<uint8_t>(level);
+            const uint8_t* seq = &table[(level >> 8) * BytesPerColor];
+            for (size_t j = 0; j < BytesPerColor; ++j) {
+                out[(pos + j) ^ 1] = seq[j];
+            }
+            pos += BytesPerColor;
+        }
+    }
+    return pos;
+}
+
+// Interpolation fused into the encoder: the in-between frame never exists as pixels.
+// 8.8 lerp times a 16-bit scale still fits 32 bits (65280 * 65536 < 2^32).
+template <ColorOrder Order, PixelFormat Format, uint8_t BytesPerColor, bool Dither>
+size_t encodePixelsLerp(const PixelColor* from, const PixelColor* to, size_t count, uint16_t weight,
+                        uint16_t scale, uint8_t* residue, const uint8_t* table, uint8_t* out, size_t pos) {
+    constexpr std::array<uint8_t, 4> order = colorOrderIndices(Order, Format);
+    constexpr size_t colors = static_cast<size_t>(Format);
+    const uint32_t factor = static_cast<uint32_t>(scale) + 1;
+
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t c = 0; c < colors; ++c) {
+            uint32_t level = (lerpLevel(from[i].component(order[c]), to[i].component(order[c]), weight) * factor) >> 16;
+            if constexpr (Dither) {
+                level += *residue;
+                *residue++ = static_cast<uint8_t>(level);
+            }
+            const uint8_t* seq = &table[(level >> 8) * BytesPerColor];
+            for (size_t j = 0; j < BytesPerColor; ++j) {
+                out[(pos + j) ^ 1] = seq[j];
+            }
+            pos += BytesPerColor;
+        }
+    }
+    return pos;
+}
+
+// Every encoder variant for one order/format/bytes-per-color combination
+struct I2sEncoderSet {
+    I2sEncodeFn plain;
+    I2sDitherEncodeFn<PixelColor> dither;
+    I2sDitherEncodeFn<PixelColor16> dither16;
+    I2sLerpEncodeFn lerp;
+    I2sLerpEncodeFn lerp_dither;
+};
+
+// Pick the specializations for a channel; done once when the channel is created
+[[nodiscard]] I2sEncoderSet selectI2sEncoders(ColorOrder order, PixelFormat format,
+                                              uint8_t bytes_per_color) noexcept;
+
+// I2S DMA sizing for a channel. The I2S driver raises one on_sent interrupt per
+// descriptor, so descriptor size sets the interrupt rate while descriptor count sets
+// how much of the frame can be preloaded before the DMA starts.
+struct I2sDmaConfig {
+    uint32_t desc_num = 0;        // Descriptors in the DMA ring (dma_desc_num)
+    uint32_t frame_num = 0;       // I2S frames per descriptor (dma_frame_num)
+    uint32_t desc_bytes = 0;      // Bytes per descriptor buffer
+    uint32_t dma_bytes = 0;       // Total DMA RAM used by the ring
+    uint32_t irqs_per_frame = 0;  // on_sent interrupts per encoded frame
+    bool whole_frame = false;     // Entire frame fits in the ring (no refills needed)
+};
+
+inline constexpr uint32_t I2S_DMA_BYTES_PER_FRAME = 4;       // 16-bit stereo slot pair
+inline constexpr uint32_t I2S_DMA_MAX_DESC_BYTES = 4092;     // Hardware descriptor limit
+inline constexpr uint32_t I2S_DMA_MIN_DESC_NUM = 2;
+
+// Size the DMA ring for an encoded frame of frame_bytes sent at bitrate (bits/s).
+// Descriptors are sized for roughly target_irq_hz interrupts while streaming and the
+// ring is made large enough to hold the whole frame when max_dma_bytes allows it.
+[[nodiscard]] constexpr I2sDmaConfig computeI2sDmaConfig(size_t frame_bytes, uint32_t bitrate,
+                                                         uint32_t target_irq_hz,
+                                                         size_t max_dma_bytes) noexcept {
+    constexpr uint32_t align = I2S_DMA_BYTES_PER_FRAME;
+    const auto round_up = [](uint64_t value, uint64_t multiple) {
+        return ((value + multiple - 1) / multiple) * multiple;
+    };
+
+    const uint64_t frame = std::max<uint64_t>(frame_bytes, align);
+    const uint64_t byte_rate = std::max<uint64_t>(bitrate / 8, 1);
+    const uint64_t irq_hz = std::max<uint32_t>(target_irq_hz, 1);
+
+    // Descriptor size from the interrupt budget, but never larger than an even split
+    // of the frame across the minimum ring, so short strips do not waste DMA RAM
+    uint64_t desc = round_up((byte_rate + irq_hz - 1) / irq_hz, align);
+    desc = std::min<uint64_t>(desc, round_up((frame + I2S_DMA_MIN_DESC_NUM - 1) / I2S_DMA_MIN_DESC_NUM, align));
+    desc = std::clamp<uint64_t>(desc, align, I2S_DMA_MAX_DESC_BYTES);
+
+    const uint64_t descs_for_frame = (frame + desc - 1) / desc;
+    const uint64_t descs_for_budget = std::max<uint64_t>(max_dma_bytes / desc, I2S_DMA_MIN_DESC_NUM);
+    const uint64_t desc_num = std::clamp<uint64_t>(descs_for_frame, I2S_DMA_MIN_DESC_NUM, descs_for_budget);
+
+    I2sDmaConfig config;
+    config.desc_num = static_cast<uint32_t>(desc_num);
+    config.frame_num = static_cast<uint32_t>(desc / align);
+    config.desc_bytes = static_cast<uint32_t>(desc);
+    config.dma_bytes = static_cast<uint32_t>(desc * desc_num);
+    config.irqs_per_frame = static_cast<uint32_t>(descs_for_frame);
+    config.whole_frame = desc_num >= descs_for_frame;
+    return config;
+}
+
+// Sizing model checks: 300 RGB pixels at 1 kHz fit whole, 3000 stream within budget,
+// a 10 pixel strip uses two small descriptors, descriptors never exceed the hardware limit
+namespace i2s_dma_checks {
+inline constexpr const PixelProfile& WS = pixelProfile(PixelChipset::WS2812B);
+inline constexpr size_t RGB_BYTES = 3 * WS.subbits;
+inline constexpr size_t RESET = pixelResetBytes(WS);
+static_assert(computeI2sDmaConfig(300 * RGB_BYTES + RESET, WS.bitrate, 1000, 16384).whole_frame);
+static_assert(computeI2sDmaConfig(300 * RGB_BYTES + RESET, WS.bitrate, 1000, 16384).desc_bytes == 328);
+static_assert(!computeI2sDmaConfig(3000 * RGB_BYTES + RESET, WS.bitrate, 1000, 16384).whole_frame);
+static_assert(computeI2sDmaConfig(3000 * RGB_BYTES + RESET, WS.bitrate, 1000, 16384).dma_bytes <= 16384);
+static_assert(computeI2sDmaConfig(10 * RGB_BYTES + RESET, WS.bitrate, 1000, 16384).desc_num
+              == I2S_DMA_MIN_DESC_NUM);
+static_assert(computeI2sDmaConfig(10 * RGB_BYTES + RESET, WS.bitrate, 1000, 16384).dma_bytes < 128);
+static_assert(computeI2sDmaConfig(100000, WS.bitrate, 1, 1 << 20).desc_bytes == I2S_DMA_MAX_DESC_BYTES);
+} // namespace i2s_dma_checks
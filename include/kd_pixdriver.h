@@ -1,32 +1,68 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <vector>
 #include <functional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include "driver/gpio.h"
-#include "driver/i2s_std.h"
 #include "esp_http_server.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/event_groups.h"
 #include "pixel_core.h"
+#include "pixel_color16.h"
+#include "pixel_transmit.h"
+#include "i2s_pixel_protocol.h"
+#include "pixel_transport.h"
+#include "pixel_cycle_cache.h"
+#include "pixel_sync.h"
+#include "pixel_timeline.h"
+#include "pixel_transform.h"
+#include "pixel_budget.h"
+#include "pixel_audio.h"
 
 // Forward declarations
 class PixelChannel;
 class PixelEffectEngine;
+class PixelImage;
+class PixelShowPlayer;
+class PixelShowRecorder;
 
-// I2S callback function
-extern "C" bool i2s_tx_callback(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx);
+// Temporal dithering of the 8-bit output quantization
+enum class TemporalDither : uint8_t {
+    Off,
+    On,
+    Auto,  // On while the channel refreshes at dither_min_refresh_hz or faster
+};
 
 struct ChannelConfig {
     gpio_num_t pin;
     uint16_t pixel_count;
     PixelFormat format = PixelFormat::RGB;
-    uint32_t resolution_hz = 10000000;  // 10MHz default
+    PixelChipset chipset = PixelChipset::WS2812B;  // Timing profile and encoding table
+    ColorOrder color_order = ColorOrder::Default;   // Component order on the wire
+    PixelBus bus = PixelBus::I2S;                   // Output backend
+    ClockedChipset clocked_chipset = ClockedChipset::APA102;  // Frame format on PixelBus::SPI
+    gpio_num_t clock_pin = GPIO_NUM_NC;             // Clock line on PixelBus::SPI
+    uint32_t resolution_hz = 10000000;  // SPI clock on PixelBus::SPI, tick rate on PixelBus::RMT
     std::string name;
+    uint32_t dma_irq_hz = 1000;         // Target DMA interrupt rate while streaming a frame
+    uint32_t max_dma_bytes = 16384;     // DMA RAM budget for this channel's descriptor ring
+    ColorDepth color_depth = ColorDepth::Bits8;  // Bits16: scale/limit/gamma at 16 bits, then dither or native output
+    bool gamma_correct = false;         // Gamma 2.8 in the 16-bit output pass (Bits16 only)
+    TemporalDither temporal_dither = TemporalDither::Auto;
+    uint16_t dither_min_refresh_hz = 100;  // Below this the dither pattern becomes visible flicker
+    uint32_t cycle_cache_bytes = 0;     // RAM for baking one period of a periodic effect, 0 = off
+    uint8_t render_divider = 1;         // Effects render every Nth frame, the frames between are interpolated
+    uint8_t render_downsample = 1;      // Effects render one pixel in N, the output interpolates between them
+    uint8_t priority = 0;               // Under frame overload, lower priorities degrade first
+    OutputTransform transform;          // Reverse, mirror, rotate, stride or remap on the way out
 
     ChannelConfig(gpio_num_t gpio_pin, uint16_t count,
                   PixelFormat fmt = PixelFormat::RGB,
@@ -46,66 +82,328 @@ struct EffectConfig {
     std::function<void(std::vector<PixelColor>&, uint32_t)> custom_effect;
 };
 
-class PixelDriver {
+// Invoked once per frame after every channel in it has latched (see FrameInfo)
+using FramePresentedCallback = std::function<void(const FrameInfo&)>;
+
+// Fills up to count mono samples, returns how many it wrote (see PixelDriver::enableAudio)
+using AudioSource = std::function<size_t(int16_t* samples, size_t count)>;
+
+// Settings of one pipeline, fixed at initialize()
+struct PipelineConfig {
+    uint32_t update_rate_hz = 60;
+    BaseType_t core = tskNO_AFFINITY;        // Core the pipeline's tasks are pinned to
+    UBaseType_t driver_priority = 7;         // Render task; the transmit task runs above it
+    std::string nvs_namespace = "pixdriver"; // Saved channel settings, one per pipeline
+};
+
+// One frame pipeline: its own channels, effect engine, frame clock, and driver and transmit
+// tasks. Pipelines share nothing, so two can run at different rates on different cores.
+// PixelDriver is the static API of a default pipeline.
+class PixelPipeline {
 public:
     static constexpr uint8_t CURRENT_PER_CHANNEL_MA = 20;
     static constexpr uint32_t SYSTEM_RESERVE_MA = 400;
 
+    PixelPipeline();
+    ~PixelPipeline();
+    PixelPipeline(const PixelPipeline&) = delete;
+    PixelPipeline& operator=(const PixelPipeline&) = delete;
+
+    // Initialization
+    void initialize(uint32_t update_rate_hz = 60);
+    void initialize(const PipelineConfig& config);
+    void shutdown();
+    [[nodiscard]] const PipelineConfig& getConfig() const noexcept { return config_; }
+
+    // Channel management
+    int32_t addChannel(const ChannelConfig& config);
+    bool removeChannel(int32_t channel_id);
+    [[nodiscard]] PixelChannel* getChannel(int32_t channel_id);
+    [[nodiscard]] PixelChannel* getMainChannel();
+    [[nodiscard]] std::vector<int32_t> getChannelIds();
+    [[nodiscard]] PixelEffectEngine* getEffectEngine() noexcept { return effect_engine_.get(); }
+
+    // Global settings
+    void setCurrentLimit(int32_t limit_ma);
+    [[nodiscard]] int32_t getCurrentLimit() const noexcept;
+    void setUpdateRate(uint32_t rate_hz);
+    [[nodiscard]] uint32_t getUpdateRate() const noexcept;
+
+    // Control
+    void start();
+    void stop();
+    [[nodiscard]] bool isRunning() const noexcept;
+
+    // Batch operations
+    void setAllChannelsEffect(std::string_view effect_id);
+    void setAllChannelsColor(const PixelColor& color);
+    void setAllChannelsBrightness(uint8_t brightness);
+    void setAllChannelsEnabled(bool enabled);
+
+    // Multi-channel sync: all channels queued in a frame start their DMA back to back
+    void setMaxStartSkew(uint32_t skew_us) noexcept;
+    [[nodiscard]] uint32_t getMaxStartSkew() const noexcept;
+    [[nodiscard]] StartSkewStats getStartSkewStats() const noexcept;
+    void resetStartSkewStats() noexcept;
+
+    // Error recovery applied to every channel (see UnderrunPolicy)
+    void setUnderrunPolicy(const UnderrunPolicy& policy) noexcept;
+    [[nodiscard]] UnderrunPolicy getUnderrunPolicy() const noexcept;
+
+    // Render sharing: a channel whose effect, settings and size match an earlier channel's
+    // copies that channel's frame instead of rendering, and its wire data when the encoding
+    // matches too. On by default; shared channels stay phase-locked.
+    void setRenderSharing(bool enabled) noexcept;
+    [[nodiscard]] bool getRenderSharing() const noexcept;
+
+    // Frame-budget admission control (see pixel_budget.h): under sustained overload the
+    // lowest-priority channels shed dither, rate and resolution first
+    void setBudgetPolicy(const BudgetPolicy& policy);
+    [[nodiscard]] BudgetPolicy getBudgetPolicy() const noexcept;
+    [[nodiscard]] FrameBudgetStats getFrameBudgetStats() const noexcept;
+    void resetFrameBudgetStats() noexcept;
+
+    // Frame presentation (vsync). Callbacks run in the transmit service task right after
+    // a frame latches, so keep them short and never block in them. A callback may add or
+    // remove callbacks; once removeFramePresentedCallback() returns on another task, the
+    // removed callback is not called again.
+    int32_t addFramePresentedCallback(FramePresentedCallback callback);
+    bool removeFramePresentedCallback(int32_t callback_id);
+    bool waitForVsync(FrameInfo* info = nullptr, uint32_t timeout_ms = UINT32_MAX);
+    [[nodiscard]] FrameInfo getLastFrameInfo() noexcept;
+
+    // Multi-controller sync over UDP (see pixel_sync.h). Followers lock their frame clock,
+    // and with it the effect time base, to the leader's beacons.
+    bool enableSync(const SyncConfig& config);
+    void disableSync();
+    [[nodiscard]] bool isSyncEnabled() const noexcept;
+    [[nodiscard]] SyncStats getSyncStats();
+
+    // Keyframed brightness/speed/color animation (see pixel_timeline.h). The timeline
+    // starts on the next frame and overrides the parameters it has tracks for.
+    bool setTimeline(int32_t channel_id, PixelTimeline timeline);
+    bool clearTimeline(int32_t channel_id);
+
+    // Column-scanned image for the channel's IMAGE effect (see PixelImage in pixel_show.h)
+    bool setImage(int32_t channel_id, std::unique_ptr<PixelImage> image);
+    bool clearImage(int32_t channel_id);
+
+    // Audio analysis for the sound-reactive effects (see pixel_audio.h). A task reads
+    // hop_samples at a time from the source, which should block until they are there and
+    // return the count read. getAudioFrame() is the snapshot the current frame renders with.
+    bool enableAudio(const AudioConfig& config, AudioSource source);
+    void disableAudio();
+    [[nodiscard]] bool isAudioEnabled() const noexcept;
+    [[nodiscard]] AudioFrame getAudioFrame() noexcept;
+    [[nodiscard]] AudioStats getAudioStats() noexcept;
+
+    // Power management
+    [[nodiscard]] uint32_t getTotalCurrentConsumption() const;
+    [[nodiscard]] uint32_t getScaledCurrentConsumption() const;
+    [[nodiscard]] float getCurrentScaleFactor() const;
+
+    // HTTP API. The handlers serve this pipeline, so a second pipeline needs its own server.
+    void attach_api(httpd_handle_t server);
+
+private:
+    // Show playback and recording hook into the frame loop (see pixel_show.h)
+    friend class PixelShowPlayer;
+    friend class PixelShowRecorder;
+
+    // Task entry points; param is the pipeline
+    static void driverTask(void* param);
+    static void transmitTask(void* param);
+    static void frameTimerCallback(void* arg);
+    static void syncTask(void* param);
+    static void audioTask(void* param);
+
+    void runDriver();
+    void runTransmit();
+    void runSync();
+    void runAudio();
+    BaseType_t createTask(TaskFunction_t fn, const char* name, uint32_t stack, UBaseType_t priority,
+                          TaskHandle_t* handle);
+    void startFrame(uint32_t submitted);
+    void retireSlot(int32_t slot, int64_t done_time_us);
+    void presentFrame(const FrameInfo& info);
+    void applyCurrentLimiting(uint32_t tick);
+    void renderFrame(uint32_t tick);
+    void balanceLoad(uint32_t work_us);
+    void groupIdenticalRenders();
+
+    // Show hooks; clear*() returns once the driver task is out of the hook
+    void setShowPlayer(PixelShowPlayer* player);
+    void clearShowPlayer(const PixelShowPlayer* player);
+    void setShowRecorder(PixelShowRecorder* recorder);
+    void clearShowRecorder(const PixelShowRecorder* recorder);
+
+    PipelineConfig config_;
+    std::vector<std::unique_ptr<PixelChannel>> channels_;
+    std::unique_ptr<PixelEffectEngine> effect_engine_;
+    int32_t main_channel_id_ = -1;
+    TaskHandle_t task_handle_ = nullptr;
+    int32_t current_limit_ma_ = -1;
+    uint32_t update_rate_hz_ = 60;
+    bool running_ = false;
+    int32_t next_channel_id_ = 0;
+    bool initialized_ = false;
+
+    // Single transmit service task shared by all channels
+    TaskHandle_t tx_task_handle_ = nullptr;
+    TransmitScheduler tx_scheduler_;
+    std::array<PixelChannel*, TransmitScheduler::MAX_SLOTS> tx_slots_{};
+    uint32_t max_start_skew_us_ = 100;
+    StartSkewStats start_skew_;
+    UnderrunPolicy underrun_policy_;
+    BudgetPolicy budget_policy_;
+    bool render_sharing_ = true;
+    FrameBudget frame_budget_;
+
+    // Frame presentation
+    FramePresentTracker present_tracker_;
+    FrameInfo last_frame_;
+    portMUX_TYPE frame_lock_ = portMUX_INITIALIZER_UNLOCKED;
+    EventGroupHandle_t vsync_event_ = nullptr;
+    SemaphoreHandle_t callback_mutex_ = nullptr;
+    std::vector<std::pair<int32_t, FramePresentedCallback>> frame_callbacks_;
+    std::vector<std::pair<int32_t, FramePresentedCallback>> dispatch_callbacks_;  // Transmit task's copy
+    bool callbacks_changed_ = false;
+    SemaphoreHandle_t dispatch_mutex_ = nullptr;  // Held while the copy is being called
+    int32_t next_callback_id_ = 0;
+
+    // Frame clock, disciplined by the sync leader on followers
+    FrameClock frame_clock_;
+    esp_timer_handle_t frame_timer_ = nullptr;
+    std::unique_ptr<SyncNode> sync_;
+    SemaphoreHandle_t sync_mutex_ = nullptr;
+    TaskHandle_t sync_task_ = nullptr;
+    volatile bool sync_running_ = false;
+
+    // Audio analysis; the task publishes into audio_latest_, renderFrame() snapshots it
+    TaskHandle_t audio_task_ = nullptr;
+    volatile bool audio_running_ = false;
+    AudioSource audio_source_;
+    std::unique_ptr<AudioAnalyzer> audio_analyzer_;
+    AudioFrame audio_latest_;
+    AudioFrame audio_frame_;
+    AudioStats audio_stats_;
+    portMUX_TYPE audio_lock_ = portMUX_INITIALIZER_UNLOCKED;
+
+    // Show playback/recording, one of each at a time
+    SemaphoreHandle_t show_mutex_ = nullptr;
+    PixelShowPlayer* show_player_ = nullptr;
+    PixelShowRecorder* show_recorder_ = nullptr;
+};
+
+// Static API over the default pipeline, which is created on first use. Code written for a
+// single pipeline keeps using this; further pipelines are PixelPipeline instances.
+class PixelDriver {
+public:
+    static constexpr uint8_t CURRENT_PER_CHANNEL_MA = PixelPipeline::CURRENT_PER_CHANNEL_MA;
+    static constexpr uint32_t SYSTEM_RESERVE_MA = PixelPipeline::SYSTEM_RESERVE_MA;
+
+    [[nodiscard]] static PixelPipeline& pipeline();
+
     // Initialization
-    static void initialize(uint32_t update_rate_hz = 60);
-    static void shutdown();
+    static void initialize(uint32_t update_rate_hz = 60) { pipeline().initialize(update_rate_hz); }
+    static void initialize(const PipelineConfig& config) { pipeline().initialize(config); }
+    static void shutdown() { pipeline().shutdown(); }
 
     // Channel management
-    static int32_t addChannel(const ChannelConfig& config);
-    static bool removeChannel(int32_t channel_id);
-    [[nodiscard]] static PixelChannel* getChannel(int32_t channel_id);
-    [[nodiscard]] static PixelChannel* getMainChannel();
-    [[nodiscard]] static std::vector<int32_t> getChannelIds();
-    [[nodiscard]] static PixelEffectEngine* getEffectEngine() noexcept { return effect_engine_.get(); }
+    static int32_t addChannel(const ChannelConfig& config) { return pipeline().addChannel(config); }
+    static bool removeChannel(int32_t channel_id) { return pipeline().removeChannel(channel_id); }
+    [[nodiscard]] static PixelChannel* getChannel(int32_t channel_id) { return pipeline().getChannel(channel_id); }
+    [[nodiscard]] static PixelChannel* getMainChannel() { return pipeline().getMainChannel(); }
+    [[nodiscard]] static std::vector<int32_t> getChannelIds() { return pipeline().getChannelIds(); }
+    [[nodiscard]] static PixelEffectEngine* getEffectEngine() noexcept { return pipeline().getEffectEngine(); }
 
     // Global settings
-    static void setCurrentLimit(int32_t limit_ma);
-    [[nodiscard]] static int32_t getCurrentLimit() noexcept;
-    static void setUpdateRate(uint32_t rate_hz);
-    [[nodiscard]] static uint32_t getUpdateRate() noexcept;
+    static void setCurrentLimit(int32_t limit_ma) { pipeline().setCurrentLimit(limit_ma); }
+    [[nodiscard]] static int32_t getCurrentLimit() noexcept { return pipeline().getCurrentLimit(); }
+    static void setUpdateRate(uint32_t rate_hz) { pipeline().setUpdateRate(rate_hz); }
+    [[nodiscard]] static uint32_t getUpdateRate() noexcept { return pipeline().getUpdateRate(); }
 
     // Control
-    static void start();
-    static void stop();
-    [[nodiscard]] static bool isRunning() noexcept;
+    static void start() { pipeline().start(); }
+    static void stop() { pipeline().stop(); }
+    [[nodiscard]] static bool isRunning() noexcept { return pipeline().isRunning(); }
 
     // Batch operations
-    static void setAllChannelsEffect(std::string_view effect_id);
-    static void setAllChannelsColor(const PixelColor& color);
-    static void setAllChannelsBrightness(uint8_t brightness);
-    static void setAllChannelsEnabled(bool enabled);
+    static void setAllChannelsEffect(std::string_view effect_id) { pipeline().setAllChannelsEffect(effect_id); }
+    static void setAllChannelsColor(const PixelColor& color) { pipeline().setAllChannelsColor(color); }
+    static void setAllChannelsBrightness(uint8_t brightness) { pipeline().setAllChannelsBrightness(brightness); }
+    static void setAllChannelsEnabled(bool enabled) { pipeline().setAllChannelsEnabled(enabled); }
+
+    // Multi-channel sync
+    static void setMaxStartSkew(uint32_t skew_us) noexcept { pipeline().setMaxStartSkew(skew_us); }
+    [[nodiscard]] static uint32_t getMaxStartSkew() noexcept { return pipeline().getMaxStartSkew(); }
+    [[nodiscard]] static StartSkewStats getStartSkewStats() noexcept { return pipeline().getStartSkewStats(); }
+    static void resetStartSkewStats() noexcept { pipeline().resetStartSkewStats(); }
+
+    // Error recovery
+    static void setUnderrunPolicy(const UnderrunPolicy& policy) noexcept { pipeline().setUnderrunPolicy(policy); }
+    [[nodiscard]] static UnderrunPolicy getUnderrunPolicy() noexcept { return pipeline().getUnderrunPolicy(); }
+
+    // Render sharing
+    static void setRenderSharing(bool enabled) noexcept { pipeline().setRenderSharing(enabled); }
+    [[nodiscard]] static bool getRenderSharing() noexcept { return pipeline().getRenderSharing(); }
+
+    // Frame budget
+    static void setBudgetPolicy(const BudgetPolicy& policy) { pipeline().setBudgetPolicy(policy); }
+    [[nodiscard]] static BudgetPolicy getBudgetPolicy() noexcept { return pipeline().getBudgetPolicy(); }
+    [[nodiscard]] static FrameBudgetStats getFrameBudgetStats() noexcept { return pipeline().getFrameBudgetStats(); }
+    static void resetFrameBudgetStats() noexcept { pipeline().resetFrameBudgetStats(); }
+
+    // Frame presentation
+    static int32_t addFramePresentedCallback(FramePresentedCallback callback) {
+        return pipeline().addFramePresentedCallback(std::move(callback));
+    }
+    static bool removeFramePresentedCallback(int32_t callback_id) {
+        return pipeline().removeFramePresentedCallback(callback_id);
+    }
+    static bool waitForVsync(FrameInfo* info = nullptr, uint32_t timeout_ms = UINT32_MAX) {
+        return pipeline().waitForVsync(info, timeout_ms);
+    }
+    [[nodiscard]] static FrameInfo getLastFrameInfo() noexcept { return pipeline().getLastFrameInfo(); }
+
+    // Multi-controller sync
+    static bool enableSync(const SyncConfig& config) { return pipeline().enableSync(config); }
+    static void disableSync() { pipeline().disableSync(); }
+    [[nodiscard]] static bool isSyncEnabled() noexcept { return pipeline().isSyncEnabled(); }
+    [[nodiscard]] static SyncStats getSyncStats() { return pipeline().getSyncStats(); }
+
+    // Parameter timelines
+    static bool setTimeline(int32_t channel_id, PixelTimeline timeline) {
+        return pipeline().setTimeline(channel_id, std::move(timeline));
+    }
+    static bool clearTimeline(int32_t channel_id) { return pipeline().clearTimeline(channel_id); }
+
+    // Images
+    static bool setImage(int32_t channel_id, std::unique_ptr<PixelImage> image);
+    static bool clearImage(int32_t channel_id) { return pipeline().clearImage(channel_id); }
+
+    // Audio analysis
+    static bool enableAudio(const AudioConfig& config, AudioSource source) {
+        return pipeline().enableAudio(config, std::move(source));
+    }
+    static void disableAudio() { pipeline().disableAudio(); }
+    [[nodiscard]] static bool isAudioEnabled() noexcept { return pipeline().isAudioEnabled(); }
+    [[nodiscard]] static AudioFrame getAudioFrame() noexcept { return pipeline().getAudioFrame(); }
+    [[nodiscard]] static AudioStats getAudioStats() noexcept { return pipeline().getAudioStats(); }
 
     // Power management
-    [[nodiscard]] static uint32_t getTotalCurrentConsumption();
-    [[nodiscard]] static uint32_t getScaledCurrentConsumption();
-    [[nodiscard]] static float getCurrentScaleFactor();
+    [[nodiscard]] static uint32_t getTotalCurrentConsumption() { return pipeline().getTotalCurrentConsumption(); }
+    [[nodiscard]] static uint32_t getScaledCurrentConsumption() { return pipeline().getScaledCurrentConsumption(); }
+    [[nodiscard]] static float getCurrentScaleFactor() { return pipeline().getCurrentScaleFactor(); }
 
     // HTTP API
-    static void attach_api(httpd_handle_t server);
+    static void attach_api(httpd_handle_t server) { pipeline().attach_api(server); }
 
 private:
     PixelDriver() = delete;
     ~PixelDriver() = delete;
     PixelDriver(const PixelDriver&) = delete;
     PixelDriver& operator=(const PixelDriver&) = delete;
-
-    static void driverTask(void* param);
-    static void applyCurrentLimiting();
-
-    static std::vector<std::unique_ptr<PixelChannel>> channels_;
-    static std::unique_ptr<PixelEffectEngine> effect_engine_;
-    static int32_t main_channel_id_;
-    static TaskHandle_t task_handle_;
-    static int32_t current_limit_ma_;
-    static uint32_t update_rate_hz_;
-    static bool running_;
-    static int32_t next_channel_id_;
-    static bool initialized_;
 };
 
 class PixelChannel {
@@ -119,8 +417,8 @@ public:
     PixelChannel(PixelChannel&&) = default;
     PixelChannel& operator=(PixelChannel&&) = default;
 
-    // Friend for I2S callback
-    friend bool i2s_tx_callback(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx);
+    // Transmit service task drives startTransmit()/serviceTransmit()
+    friend class PixelPipeline;
 
     // Getters
     [[nodiscard]] int32_t getId() const noexcept { return id_; }
@@ -137,40 +435,141 @@ public:
     void setMask(const std::vector<uint8_t>& mask);
     void clearMask() noexcept;
 
-    // Buffer access
+    // Buffer access. The pixel buffer is at render resolution: with render_downsample > 1
+    // it holds one sample per N output pixels (getRenderPixelCount()).
     [[nodiscard]] const std::vector<PixelColor>& getPixelBuffer() const noexcept { return pixel_buffer_; }
     [[nodiscard]] std::vector<PixelColor>& getPixelBuffer() noexcept { return pixel_buffer_; }
+    // 16-bit render target, only allocated with ColorDepth::Bits16. It is what gets output
+    // while the effect is "RAW16"; every other effect renders 8-bit and is widened.
+    [[nodiscard]] const std::vector<PixelColor16>& getPixelBuffer16() const noexcept { return pixel_buffer16_; }
+    [[nodiscard]] std::vector<PixelColor16>& getPixelBuffer16() noexcept { return pixel_buffer16_; }
 
     // Hardware interface
-    bool initialize();
-    void transmit();
+    bool initialize(int32_t tx_slot, TaskHandle_t tx_task);
+    void transmit();  // Encode the scaled buffer; the service task sends it once submitted
+    [[nodiscard]] int32_t getTransmitSlot() const noexcept { return tx_slot_; }
+    [[nodiscard]] TransmitStats getTransmitStats() const noexcept { return tx_health_.stats(); }
+    [[nodiscard]] const PixelTransport* getTransport() const noexcept { return transport_.get(); }
+    [[nodiscard]] bool shouldTransmit(uint32_t frame) const noexcept { return tx_health_.shouldTransmit(frame); }
+    // False while an aborted transfer may still read the encode buffer
+    [[nodiscard]] bool transportIdle() { return !initialized_ || !transport_->inFlight(); }
+    [[nodiscard]] uint32_t getRefreshRate() const noexcept;  // Driver rate over the error divider
+    [[nodiscard]] uint32_t getRenderRate() const noexcept;   // Driver rate over render_divider
+    [[nodiscard]] uint32_t getRenderCount() const noexcept { return renders_; }
+    [[nodiscard]] size_t getRenderPixelCount() const noexcept { return pixel_buffer_.size(); }
+    [[nodiscard]] bool rendersFrame(uint32_t tick) const noexcept {
+        return config_.render_divider <= 1 || tick % config_.render_divider == 0;
+    }
+    void resetTransmitStats() noexcept { tx_health_.reset(); }
+    [[nodiscard]] DegradeLevel getDegradeLevel() const noexcept { return load_.level; }
+    [[nodiscard]] uint32_t getFrameCostUs() const noexcept { return load_.costUs(); }  // Render + scale + encode
+    // Channel this one copies its frame from this frame, -1 if it renders its own
+    [[nodiscard]] int32_t getRenderSource() const noexcept { return render_source_ ? render_source_->id_ : -1; }
+    [[nodiscard]] uint32_t getSharedFrameCount() const noexcept { return shared_frames_; }
+    // Whether ChannelConfig::transform reorders the output (identity compiles to nothing)
+    [[nodiscard]] bool hasOutputTransform() const noexcept { return !output_map_.empty(); }
+    // Whether the channel renders and transmits this frame at its degrade level
+    [[nodiscard]] bool activeFrame(uint32_t tick) const noexcept {
+        return load_.level < DegradeLevel::HalfRate || (tick & 1) == load_.parity;
+    }
     [[nodiscard]] uint32_t getCurrentConsumption() const noexcept;
     void applyCurrentScaling(float scale_factor);
 
+    // Periodic effects report their position in the cycle before rendering. True when the
+    // frame was restored from the cycle cache, in which case there is nothing to render.
+    bool restoreCycleFrame(uint16_t position, uint16_t period);
+    [[nodiscard]] CycleCacheStats getCycleCacheStats() const noexcept { return cycle_cache_.stats(); }
+
+    // Timeline set through PixelDriver::setTimeline()
+    [[nodiscard]] bool hasTimeline() const noexcept { return !timeline_.empty(); }
+    [[nodiscard]] const PixelTimeline& getTimeline() const noexcept { return timeline_; }
+    [[nodiscard]] uint32_t getTimelinePositionMs() const noexcept { return timeline_position_ms_; }
+
+    // Image set through PixelDriver::setImage(), played by the IMAGE effect
+    [[nodiscard]] bool hasImage() const noexcept { return image_ != nullptr; }
+    [[nodiscard]] PixelImage* getImage() const noexcept { return image_.get(); }
+
     // Persistence
     void saveToNVS() const;
     void loadFromNVS();
 
 private:
-    void setupI2S();
     void cleanup();
-    void convertToI2SBuffer(const std::vector<PixelColor>& pixels);
-    static void i2sTaskWrapper(void* param);
-    void i2sTask();
+    void applyScaling16(float combined_scale);
+    [[nodiscard]] bool temporalDitherWanted() const noexcept;
+    [[nodiscard]] bool rendersRaw16() const noexcept;
+    void resetCycleFrame() noexcept;
+    void advanceKeyframes(uint32_t tick);
+    void applyTimeline(uint32_t tick);
+    [[nodiscard]] bool downsampled() const noexcept { return pixel_buffer_.size() != config_.pixel_count; }
+    void upsample(std::vector<PixelColor>& out, uint16_t scale) const noexcept;
+    void applyDegradeLevel();
+    [[nodiscard]] bool rendersSameAs(const PixelChannel& other) const noexcept;
+    [[nodiscard]] bool encodesSameAs(const PixelChannel& other) const noexcept;
+    void copyRender();
+    [[nodiscard]] bool interpolating() const noexcept { return !key_to_.empty() && !rendersRaw16(); }
+    void effectChanged() noexcept { ++effect_generation_; }
+    [[nodiscard]] const PixelPipeline& owner() const noexcept;
+
+    // Called from the transmit service task only
+    bool prepareTransmit();
+    bool startTransmit();
+    bool serviceTransmit() { return transport_->service(); }
+    void refillTransmit() { transport_->refill(); }
+    void abortTransmit() { transport_->abort(); }
+    bool finishTransmit(bool timed_out, const UnderrunPolicy& policy);
+    [[nodiscard]] bool pastDeadline(int64_t now_us) const noexcept { return now_us > deadline_us_; }
+    [[nodiscard]] int64_t doneTimeUs() const noexcept { return transport_->doneTimeUs(); }
 
     int32_t id_;
     ChannelConfig config_;
     EffectConfig effect_config_;
+    const PixelPipeline* owner_ = nullptr;  // Set by PixelPipeline::addChannel(), else the default pipeline
 
     std::vector<PixelColor> pixel_buffer_;
     std::vector<PixelColor> scaled_buffer_;
-    std::vector<uint8_t> i2s_buffer_;
+    uint16_t output_scale_ = UINT16_MAX;  // Scale left to transports that apply it while encoding
+    uint8_t downsample_ = 1;              // render_downsample, doubled at DegradeLevel::HalfResolution
+    std::vector<uint16_t> output_map_;    // Compiled transform, physical -> logical pixel; empty = identity
+    uint64_t output_map_hash_ = 0;        // outputMapHash(output_map_), compared instead of the table
+
+    // ColorDepth::Bits16 only
+    std::vector<PixelColor16> pixel_buffer16_;
+    std::vector<PixelColor16> scaled_buffer16_;
+
+    // render_divider > 1: the last two rendered frames (masked) and where between them
+    // this output frame lies, as weight/256
+    std::vector<PixelColor> key_from_;
+    std::vector<PixelColor> key_to_;
+    uint16_t lerp_weight_ = 256;
+    uint32_t key_current_ma_ = 0;  // The larger of the two keyframes' draw
+    uint32_t renders_ = 0;
 
-    i2s_chan_handle_t i2s_channel_ = nullptr;
-    SemaphoreHandle_t transmit_semaphore_ = nullptr;
-    SemaphoreHandle_t complete_semaphore_ = nullptr;
-    TaskHandle_t i2s_task_handle_ = nullptr;
+    // Parameter timeline, timed from the frame it started on
+    PixelTimeline timeline_;
+    uint32_t timeline_start_ = 0;
+    uint32_t timeline_position_ms_ = 0;
+    bool timeline_restart_ = false;
+
+    std::unique_ptr<PixelImage> image_;
+
+    // Cycle cache: position of this frame in the effect's cycle, and whether it was restored
+    CycleCache cycle_cache_;
+    uint32_t effect_generation_ = 0;  // Bumped by every change that alters rendered frames
+    uint16_t cycle_position_ = CycleCache::NO_POSITION;
+    uint16_t cycle_scale_ = 0;
+    bool cycle_hit_ = false;
+
+    std::unique_ptr<PixelTransport> transport_;
+    int32_t tx_slot_ = -1;
     bool initialized_ = false;
-    bool terminate_task_ = false;
-    size_t bytes_sent_ = 0;
+    int64_t deadline_us_ = 0;          // Frame counts as timed out after this
+    bool resending_ = false;
+    TransmitHealth tx_health_;
+    ChannelLoad load_;
+
+    // Render sharing, regrouped every frame
+    PixelChannel* render_source_ = nullptr;
+    bool encoded_ = false;          // transmit() ran this frame
+    uint32_t shared_frames_ = 0;    // Frames sent as a copy of the source's wire data
 };
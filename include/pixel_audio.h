@@ -0,0 +1,406 @@
+/* Audio analysis for sound-reactive effects
+ * PCM from a caller-supplied source is cut into overlapping blocks, Hann windowed and run
+ * through a fixed-point FFT: the N real samples are packed into N/2 complex points,
+ * transformed with radix-4 stages (plus one radix-2 stage when log2(N/2) is odd) and split
+ * back into the real spectrum. Each block then updates log-spaced band envelopes, an
+ * overall level, a bass onset (beat) detector with a tempo estimate and the strongest
+ * frequency, published as one AudioFrame. Integer arithmetic only after configure(), so
+ * the per-block cost is the same on cores without an FPU. Portable: tools/pixaudio.cpp
+ * runs it on synthetic PCM.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+inline constexpr double AUDIO_PI = 3.14159265358979323846;
+inline constexpr size_t AUDIO_MAX_BANDS = 16;
+inline constexpr uint16_t AUDIO_MIN_FFT = 64;
+inline constexpr uint16_t AUDIO_MAX_FFT = 2048;
+inline constexpr uint16_t AUDIO_BEAT_MAX_HZ = 200;   // Bins up to here feed the onset detector
+inline constexpr int32_t AUDIO_RANGE_Q8 = 16 << 8;   // Level range below the gain reference: 16 octaves of power, 48 dB
+inline constexpr int32_t AUDIO_REF_FLOOR_Q8 = 20 << 8;  // Lowest gain reference, so silence reads as 0
+inline constexpr int32_t AUDIO_BEAT_FLOOR_Q8 = 384;      // Smallest bass rise that is a beat: 1.5 octaves of power
+inline constexpr int32_t AUDIO_BEAT_RANGE_Q8 = 3 << 8;   // A beat's bass is within 3 octaves (9 dB) of the recent peak
+
+struct AudioConfig {
+    uint32_t sample_rate_hz = 16000;
+    uint16_t fft_size = 512;       // Power of two, AUDIO_MIN_FFT to AUDIO_MAX_FFT
+    uint16_t hop_samples = 256;    // New samples per block; fft_size / 2 overlaps blocks by half
+    uint8_t band_count = 8;        // Log-spaced from min_hz to max_hz, at most AUDIO_MAX_BANDS
+    uint16_t min_hz = 60;
+    uint16_t max_hz = 8000;        // Clamped to the Nyquist frequency
+    uint16_t attack_ms = 10;       // Envelope rise time constant
+    uint16_t release_ms = 250;     // Envelope fall time constant, also the beat pulse decay
+    uint16_t gain_release_ms = 4000;    // How fast the automatic gain recovers after a loud passage
+    uint16_t beat_threshold_pct = 150;  // Onset strength over its running mean that counts as a beat
+    uint16_t beat_min_interval_ms = 250;
+    uint8_t task_priority = 5;     // PixelDriver's analysis task
+};
+
+// The analysis as of the latest block. Levels are 0-255 after automatic gain.
+struct AudioFrame {
+    uint32_t block = 0;        // Blocks analysed since the source started, 0 = no audio yet
+    uint8_t level = 0;         // Overall loudness envelope
+    uint8_t band_count = 0;
+    std::array<uint8_t, AUDIO_MAX_BANDS> bands{};  // Band envelopes, lowest band first
+    bool beat = false;         // A beat started in this block (PixelDriver: since the last frame)
+    uint8_t beat_pulse = 0;    // 255 at each beat, decaying with release_ms
+    uint16_t bpm = 0;          // Tempo from steady beat intervals, 0 until there is one
+    uint16_t peak_hz = 0;      // Frequency of the strongest bin
+};
+
+struct AudioStats {
+    uint32_t blocks = 0;
+    uint32_t read_errors = 0;           // Source reads that returned no samples
+    uint32_t mean_cycles_per_block = 0; // Window, FFT and analysis
+    uint32_t max_cycles_per_block = 0;
+    uint32_t mean_us_per_block = 0;
+};
+
+namespace audio_detail {
+
+struct Complex {
+    int32_t re;
+    int32_t im;
+};
+
+// (a * w) in Q15; |a| < 2^16 and |w| <= 2^15 - 1 keep each product sum inside 32 bits
+inline Complex mulQ15(Complex a, Complex w) noexcept {
+    return {(a.re * w.re - a.im * w.im + (1 << 14)) >> 15, (a.re * w.im + a.im * w.re + (1 << 14)) >> 15};
+}
+
+// log2(v) in Q8, mantissa linearly interpolated (within 0.09 of an octave)
+inline int32_t log2Q8(uint64_t v) noexcept {
+    if (v == 0) return 0;
+    const int msb = 63 - __builtin_clzll(v);
+    const uint32_t frac = msb >= 8 ? static_cast<uint32_t>(v >> (msb - 8)) & 0xFF
+                                   : static_cast<uint32_t>(v << (8 - msb)) & 0xFF;
+    return (msb << 8) | static_cast<int32_t>(frac);
+}
+
+// One-pole smoothing factor in Q15 for a time constant, applied once per block
+inline int32_t smoothingQ15(uint32_t time_ms, uint32_t hop, uint32_t rate_hz) {
+    if (time_ms == 0) return 1 << 15;
+    const double per_block = 1.0 - std::exp(-1000.0 * hop / (static_cast<double>(rate_hz) * time_ms));
+    return std::clamp(static_cast<int32_t>(per_block * 32768.0 + 0.5), 1, 1 << 15);
+}
+
+} // namespace audio_detail
+
+// Fixed-point real FFT of a power-of-two size: windowed int16 PCM in, power per bin out
+class AudioFft {
+public:
+    bool configure(uint16_t size) {
+        if (size < AUDIO_MIN_FFT || size > AUDIO_MAX_FFT || (size & (size - 1))) return false;
+        size_ = size;
+        const size_t m = size / 2;
+        log2m_ = 0;
+        while ((size_t(1) << log2m_) < m) ++log2m_;
+
+        // Twiddles W_N^t for t < 3N/4: the real split uses t < N/2, the radix-4 stages
+        // W_M^(j, 2j, 3j) = W_N^(2j, 4j, 6j) with j < M/4
+        twiddles_.resize(size * 3 / 4);
+        for (size_t t = 0; t < twiddles_.size(); ++t) {
+            const double angle = 2.0 * AUDIO_PI * static_cast<double>(t) / size;
+            twiddles_[t] = {static_cast<int32_t>(std::lround(std::cos(angle) * 32767.0)),
+                            static_cast<int32_t>(std::lround(-std::sin(angle) * 32767.0))};
+        }
+        window_.resize(size);
+        for (size_t n = 0; n < size; ++n) {
+            window_[n] = static_cast<int16_t>(std::lround(32767.0 * 0.5 * (1.0 - std::cos(2.0 * AUDIO_PI * n / size))));
+        }
+        bit_reverse_.resize(m);
+        for (size_t i = 0; i < m; ++i) {
+            size_t r = 0;
+            for (uint32_t b = 0; b < log2m_; ++b) r |= ((i >> b) & 1) << (log2m_ - 1 - b);
+            bit_reverse_[i] = static_cast<uint16_t>(r);
+        }
+        work_.resize(m);
+        return true;
+    }
+
+    [[nodiscard]] uint16_t size() const noexcept { return size_; }
+
+    // Power of bins 0 .. N/2 - 1 of the windowed block, scaled by 4^shift / N^2 where
+    // shift is the return value (a full-scale sine reads about 2^28 in its bin at shift 0).
+    // Quiet blocks are shifted up to full scale first, so they keep their precision
+    // through the stages' scaling; take log2 of the power and subtract 2 * shift.
+    int transform(const int16_t* pcm, uint32_t* power) noexcept {
+        using audio_detail::Complex;
+        const size_t m = size_ / 2;
+
+        // Even samples as real, odd as imaginary parts, in bit-reversed order
+        int32_t peak = 0;
+        for (size_t i = 0; i < m; ++i) {
+            const size_t n = 2 * i;
+            const Complex x = {(pcm[n] * window_[n] + (1 << 14)) >> 15, (pcm[n + 1] * window_[n + 1] + (1 << 14)) >> 15};
+            peak = std::max({peak, std::abs(x.re), std::abs(x.im)});
+            work_[bit_reverse_[i]] = x;
+        }
+        const int shift = peak ? std::max(0, 14 - (31 - __builtin_clz(static_cast<uint32_t>(peak)))) : 0;
+        if (shift) {
+            for (Complex& x : work_) x = {x.re * (1 << shift), x.im * (1 << shift)};
+        }
+
+        // Each stage scales by 1/2 (radix-2) or 1/4 (radix-4) so values stay in range
+        size_t h = 1;
+        if (log2m_ & 1) {
+            for (size_t k = 0; k < m; k += 2) {
+                const Complex a = work_[k];
+                const Complex b = work_[k + 1];
+                work_[k] = {(a.re + b.re) >> 1, (a.im + b.im) >> 1};
+                work_[k + 1] = {(a.re - b.re) >> 1, (a.im - b.im) >> 1};
+            }
+            h = 2;
+        }
+        for (; h < m; h *= 4) {
+            const size_t step = 2 * m / (4 * h);  // W_4h^j = W_N^(j * step)
+            for (size_t base = 0; base < m; base += 4 * h) {
+                for (size_t j = 0; j < h; ++j) {
+                    Complex* x = &work_[base + j];
+                    const Complex a0 = x[0];
+                    const Complex c1 = audio_detail::mulQ15(x[h], twiddles_[2 * j * step]);
+                    const Complex c2 = audio_detail::mulQ15(x[2 * h], twiddles_[j * step]);
+                    const Complex c3 = audio_detail::mulQ15(x[3 * h], twiddles_[3 * j * step]);
+                    const Complex s = {c2.re + c3.re, c2.im + c3.im};
+                    const Complex d = {c2.im - c3.im, c3.re - c2.re};  // -i * (c2 - c3)
+                    const Complex e = {a0.re + c1.re, a0.im + c1.im};
+                    const Complex f = {a0.re - c1.re, a0.im - c1.im};
+                    x[0] = {(e.re + s.re + 2) >> 2, (e.im + s.im + 2) >> 2};
+                    x[2 * h] = {(e.re - s.re + 2) >> 2, (e.im - s.im + 2) >> 2};
+                    x[h] = {(f.re + d.re + 2) >> 2, (f.im + d.im + 2) >> 2};
+                    x[3 * h] = {(f.re - d.re + 2) >> 2, (f.im - d.im + 2) >> 2};
+                }
+            }
+        }
+
+        // Split the packed transform: X[k] = Fe[k] + W_N^k Fo[k]
+        for (size_t k = 0; k < m; ++k) {
+            const Complex z = work_[k];
+            const Complex w = work_[k ? m - k : 0];
+            const Complex even = {(z.re + w.re) >> 1, (z.im - w.im) >> 1};
+            const Complex odd = {(z.im + w.im) >> 1, (w.re - z.re) >> 1};
+            const Complex t = audio_detail::mulQ15(odd, twiddles_[k]);
+            const int64_t re = even.re + t.re;
+            const int64_t im = even.im + t.im;
+            power[k] = static_cast<uint32_t>(std::min<int64_t>((re * re + im * im), UINT32_MAX));
+        }
+        return shift;
+    }
+
+private:
+    uint16_t size_ = 0;
+    uint32_t log2m_ = 0;
+    std::vector<audio_detail::Complex> twiddles_;
+    std::vector<int16_t> window_;
+    std::vector<uint16_t> bit_reverse_;
+    std::vector<audio_detail::Complex> work_;
+};
+
+// Block analysis on top of AudioFft. push() takes PCM in any amount and analyses every
+// time hop_samples new samples have come in.
+class AudioAnalyzer {
+public:
+    bool configure(const AudioConfig& config) {
+        if (config.sample_rate_hz == 0 || config.hop_samples == 0 || config.hop_samples > config.fft_size ||
+            config.band_count == 0 || config.band_count > AUDIO_MAX_BANDS || !fft_.configure(config.fft_size)) {
+            return false;
+        }
+        config_ = config;
+        const size_t bins = config.fft_size / 2;
+        const double bin_hz = static_cast<double>(config.sample_rate_hz) / config.fft_size;
+
+        // Log-spaced band edges in bins, every band at least one bin wide
+        const double lo = std::max<double>(config.min_hz, bin_hz);
+        const double hi = std::clamp<double>(config.max_hz, lo * 2, config.sample_rate_hz / 2.0);
+        band_edges_.assign(config.band_count + 1, 0);
+        for (size_t b = 0; b <= config.band_count; ++b) {
+            const double hz = lo * std::pow(hi / lo, static_cast<double>(b) / config.band_count);
+            band_edges_[b] = static_cast<uint16_t>(std::clamp<double>(std::lround(hz / bin_hz), 1, bins));
+            if (b > 0 && band_edges_[b] <= band_edges_[b - 1]) band_edges_[b] = band_edges_[b - 1] + 1;
+        }
+        if (band_edges_.back() > bins) return false;  // More bands than bins
+        beat_bins_ = std::clamp<size_t>(static_cast<size_t>(AUDIO_BEAT_MAX_HZ / bin_hz) + 1, 2, bins);
+
+        const uint32_t hop = config.hop_samples;
+        attack_q15_ = audio_detail::smoothingQ15(config.attack_ms, hop, config.sample_rate_hz);
+        release_q15_ = audio_detail::smoothingQ15(config.release_ms, hop, config.sample_rate_hz);
+        gain_release_q15_ = audio_detail::smoothingQ15(config.gain_release_ms, hop, config.sample_rate_hz);
+        mean_q15_ = audio_detail::smoothingQ15(1000, hop, config.sample_rate_hz);
+        block_ms_q8_ = static_cast<uint32_t>((256000ull * hop) / config.sample_rate_hz);
+        beat_gap_blocks_ = static_cast<uint32_t>(
+            (static_cast<uint64_t>(config.beat_min_interval_ms) * config.sample_rate_hz) / (1000ull * hop));
+
+        samples_.assign(config.fft_size, 0);
+        power_.assign(bins, 0);
+        reset();
+        return true;
+    }
+
+    void reset() noexcept {
+        std::fill(samples_.begin(), samples_.end(), 0);
+        filled_ = 0;
+        pending_ = 0;
+        frame_ = AudioFrame{};
+        frame_.band_count = config_.band_count;
+        band_env_.fill(0);
+        band_ref_.fill(AUDIO_REF_FLOOR_Q8);
+        level_env_ = 0;
+        level_ref_ = AUDIO_REF_FLOOR_Q8;
+        pulse_env_ = 0;
+        flux_mean_ = 0;
+        bass_log_ = 0;
+        bass_peak_ = AUDIO_REF_FLOOR_Q8;
+        last_beat_block_ = 0;
+        beat_interval_ = 0;
+        steady_beats_ = 0;
+    }
+
+    // Returns the number of blocks analysed; frame() is the newest
+    size_t push(const int16_t* pcm, size_t count) {
+        size_t blocks = 0;
+        bool beat = false;
+        const size_t size = samples_.size();
+        while (count > 0) {
+            // Samples slide through a buffer of one block; the newest hop goes at the end
+            const size_t n = std::min(count, static_cast<size_t>(config_.hop_samples) - pending_);
+            std::memmove(samples_.data(), samples_.data() + n, (size - n) * sizeof(int16_t));
+            std::memcpy(samples_.data() + size - n, pcm, n * sizeof(int16_t));
+            pcm += n;
+            count -= n;
+            pending_ += n;
+            filled_ = std::min(filled_ + n, size);
+            if (pending_ == config_.hop_samples) {
+                pending_ = 0;
+                analyse();
+                beat = beat || frame_.beat;
+                ++blocks;
+            }
+        }
+        frame_.beat = beat;
+        return blocks;
+    }
+
+    [[nodiscard]] const AudioFrame& frame() const noexcept { return frame_; }
+    [[nodiscard]] const AudioConfig& config() const noexcept { return config_; }
+    [[nodiscard]] const std::vector<uint32_t>& power() const noexcept { return power_; }
+
+private:
+    // Envelope follower in Q8 of the 0-255 scale
+    void follow(int32_t& env, int32_t target) const noexcept {
+        const int32_t q15 = target > env ? attack_q15_ : release_q15_;
+        env += static_cast<int32_t>((static_cast<int64_t>(target - env) * q15) >> 15);
+    }
+
+    // Gain reference: jumps up to a louder block and decays with gain_release_ms
+    void trackPeak(int32_t& ref, int32_t log_power) const noexcept {
+        ref = log_power > ref ? log_power
+                              : ref - static_cast<int32_t>((static_cast<int64_t>(ref - log_power) * gain_release_q15_) >> 15);
+        ref = std::max(ref, AUDIO_REF_FLOOR_Q8);
+    }
+
+    // Level of a log power under its gain reference
+    [[nodiscard]] uint8_t gainLevel(int32_t& ref, int32_t log_power) const noexcept {
+        trackPeak(ref, log_power);
+        const int32_t above = log_power - (ref - AUDIO_RANGE_Q8);
+        return static_cast<uint8_t>(std::clamp(above * 255 / AUDIO_RANGE_Q8, 0, 255));
+    }
+
+    void analyse() {
+        const int32_t shift_q8 = fft_.transform(samples_.data(), power_.data()) * (2 << 8);
+        const auto logPower = [shift_q8](uint64_t p) { return audio_detail::log2Q8(p) - shift_q8; };
+        ++frame_.block;
+
+        uint64_t total = 0;
+        size_t peak = 1;
+        for (size_t k = 1; k < power_.size(); ++k) {
+            total += power_[k];
+            if (power_[k] > power_[peak]) peak = k;
+        }
+        frame_.peak_hz = static_cast<uint16_t>(peak * config_.sample_rate_hz / config_.fft_size);
+
+        for (size_t b = 0; b < config_.band_count; ++b) {
+            uint64_t energy = 0;
+            for (size_t k = band_edges_[b]; k < band_edges_[b + 1]; ++k) energy += power_[k];
+            follow(band_env_[b], gainLevel(band_ref_[b], logPower(energy)) << 8);
+            frame_.bands[b] = static_cast<uint8_t>(band_env_[b] >> 8);
+        }
+        follow(level_env_, gainLevel(level_ref_, logPower(total)) << 8);
+        frame_.level = static_cast<uint8_t>(level_env_ >> 8);
+
+        // Onset: the bass log power rises faster than it usually does, to near the loudest
+        // recent bass, so noise wobbling between the beats does not count
+        uint64_t bass = 0;
+        for (size_t k = 1; k < beat_bins_; ++k) bass += power_[k];
+        const int32_t bass_log = logPower(bass);
+        const int32_t flux = std::max(0, bass_log - bass_log_);
+        const int64_t threshold = (static_cast<int64_t>(flux_mean_) * config_.beat_threshold_pct) / 100 + AUDIO_BEAT_FLOOR_Q8;
+        const bool full = filled_ == samples_.size();
+        const uint32_t since = frame_.block - last_beat_block_;
+        trackPeak(bass_peak_, bass_log);
+        frame_.beat = full && flux > threshold && bass_log > bass_peak_ - AUDIO_BEAT_RANGE_Q8 &&
+                      (last_beat_block_ == 0 || since > beat_gap_blocks_);
+        bass_log_ = bass_log;
+        flux_mean_ += static_cast<int32_t>((static_cast<int64_t>(flux - flux_mean_) * mean_q15_) >> 15);
+
+        if (frame_.beat) {
+            updateTempo(since);
+            last_beat_block_ = frame_.block;
+            pulse_env_ = 255 << 8;
+        } else {
+            pulse_env_ -= static_cast<int32_t>((static_cast<int64_t>(pulse_env_) * release_q15_) >> 15);
+        }
+        frame_.beat_pulse = static_cast<uint8_t>(pulse_env_ >> 8);
+    }
+
+    // Tempo from beat intervals that agree within 20%; four in a row make it steady
+    void updateTempo(uint32_t since) noexcept {
+        if (last_beat_block_ == 0) return;
+        const uint32_t interval = since << 8;  // Blocks, Q8
+        if (beat_interval_ != 0 && interval * 5 > beat_interval_ * 4 && interval * 5 < beat_interval_ * 6) {
+            beat_interval_ += (static_cast<int32_t>(interval) - static_cast<int32_t>(beat_interval_)) / 4;
+            ++steady_beats_;
+        } else {
+            beat_interval_ = interval;
+            steady_beats_ = 0;
+        }
+        const uint64_t interval_ms_q16 = static_cast<uint64_t>(beat_interval_) * block_ms_q8_;
+        frame_.bpm = steady_beats_ >= 3 && interval_ms_q16
+                   ? static_cast<uint16_t>((60000ull << 16) / interval_ms_q16) : 0;
+    }
+
+    AudioConfig config_;
+    AudioFft fft_;
+    std::vector<int16_t> samples_;
+    std::vector<uint32_t> power_;
+    std::vector<uint16_t> band_edges_;
+    size_t beat_bins_ = 0;
+    size_t filled_ = 0;
+    size_t pending_ = 0;
+
+    int32_t attack_q15_ = 0;
+    int32_t release_q15_ = 0;
+    int32_t gain_release_q15_ = 0;
+    int32_t mean_q15_ = 0;
+    uint32_t block_ms_q8_ = 0;
+    uint32_t beat_gap_blocks_ = 0;
+
+    AudioFrame frame_;
+    std::array<int32_t, AUDIO_MAX_BANDS> band_env_{};
+    std::array<int32_t, AUDIO_MAX_BANDS> band_ref_{};
+    int32_t level_env_ = 0;
+    int32_t level_ref_ = AUDIO_REF_FLOOR_Q8;
+    int32_t pulse_env_ = 0;
+    int32_t flux_mean_ = 0;
+    int32_t bass_log_ = 0;
+    int32_t bass_peak_ = AUDIO_REF_FLOOR_Q8;
+    uint32_t last_beat_block_ = 0;
+    uint32_t beat_interval_ = 0;  // Blocks between beats, Q8
+    uint32_t steady_beats_ = 0;
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Portable frame-budget bookkeeping for the driver task: measures how much of each frame
+// the render, scaling and encode work takes, and decides when to shed load. Under
+// sustained overload the lowest-priority channel steps down one DegradeLevel at a time;
+// with sustained headroom the highest-priority degraded channel steps back up.
+// It only sees the microsecond costs it is handed, which lets `pixbench budget` replay
+// overload and recovery sequences without a board.
+
+// What a channel gives up, cumulatively, at each step
+enum class DegradeLevel : uint8_t {
+    Full,
+    NoDither,        // Temporal dither off
+    HalfRate,        // Renders and transmits every other frame
+    HalfResolution,  // Renders half the samples (on top of render_downsample)
+};
+
+[[nodiscard]] constexpr const char* degradeLevelName(DegradeLevel level) noexcept {
+    switch (level) {
+        case DegradeLevel::Full:           return "full";
+        case DegradeLevel::NoDither:       return "no_dither";
+        case DegradeLevel::HalfRate:       return "half_rate";
+        case DegradeLevel::HalfResolution: return "half_resolution";
+    }
+    return "unknown";
+}
+
+struct BudgetPolicy {
+    bool enabled = true;
+    uint8_t high_water_pct = 90;   // Work above this share of the frame counts as overload
+    uint8_t low_water_pct = 60;    // Work below this share counts as headroom
+    uint16_t degrade_after = 8;    // Consecutive overloaded frames before a channel steps down
+    uint16_t recover_after = 180;  // Consecutive frames with headroom before one steps up
+    DegradeLevel max_level = DegradeLevel::HalfRate;
+};
+
+struct FrameBudgetStats {
+    uint32_t budget_us = 0;     // One frame at the driver rate
+    uint32_t work_us = 0;       // Average work per frame
+    uint32_t peak_work_us = 0;  // Worst frame since reset
+    uint32_t overruns = 0;      // Frames whose work did not fit the frame
+    uint32_t degrades = 0;      // Steps down taken
+    uint32_t restores = 0;      // Steps back up taken
+};
+
+// Per-channel share of the frame: render plus scaling plus encode, averaged over frames
+class ChannelLoad {
+public:
+    void add(uint32_t us) noexcept { frame_us_ += us; }
+
+    // Fold the frame's work into the running average (1/8 weight) and start the next
+    void endFrame() noexcept {
+        cost_x8_ += frame_us_ - (cost_x8_ >> 3);
+        frame_us_ = 0;
+    }
+
+    [[nodiscard]] uint32_t costUs() const noexcept { return cost_x8_ >> 3; }
+
+    DegradeLevel level = DegradeLevel::Full;
+    uint8_t priority = 0;
+    uint8_t parity = 0;  // At HalfRate, the channel runs on frames with this parity
+    // Renders on even frames only (an even render_divider), so at HalfRate it must keep
+    // parity 0: on odd frames it would never render
+    bool even_renders = false;
+
+private:
+    uint32_t frame_us_ = 0;
+    uint32_t cost_x8_ = 0;
+};
+
+class FrameBudget {
+public:
+    enum class Action : uint8_t { Hold, Degrade, Restore };
+
+    // Record one frame's work; the action is for the caller to apply to a channel. Decisions
+    // go by the running average, so half-rate channels alternating heavy and light frames
+    // do not reset the count.
+    Action record(uint32_t work_us, uint32_t budget_us, const BudgetPolicy& policy) noexcept {
+        stats_.budget_us = budget_us;
+        work_x8_ += work_us - (work_x8_ >> 3);
+        stats_.work_us = work_x8_ >> 3;
+        if (work_us > stats_.peak_work_us) stats_.peak_work_us = work_us;
+        if (work_us > budget_us) ++stats_.overruns;
+        if (!policy.enabled) return Action::Hold;
+
+        const uint64_t scaled = static_cast<uint64_t>(stats_.work_us) * 100;
+        if (scaled > static_cast<uint64_t>(budget_us) * policy.high_water_pct) {
+            headroom_frames_ = 0;
+            if (++overload_frames_ >= policy.degrade_after) {
+                overload_frames_ = 0;
+                return Action::Degrade;
+            }
+        } else if (scaled < static_cast<uint64_t>(budget_us) * policy.low_water_pct) {
+            overload_frames_ = 0;
+            if (++headroom_frames_ >= policy.recover_after) {
+                headroom_frames_ = 0;
+                return Action::Restore;
+            }
+        } else {
+            overload_frames_ = 0;
+            headroom_frames_ = 0;
+        }
+        return Action::Hold;
+    }
+
+    // Apply an action to one of `count` channels: a step down goes to the lowest priority
+    // channel that can still degrade (the costliest on a tie), a step up to the highest
+    // priority degraded one whose cost, if it doubled, would still stay under high water.
+    // Returns the channel's index, or -1 if none qualified.
+    int32_t apply(Action action, ChannelLoad* const* loads, size_t count, const BudgetPolicy& policy) noexcept {
+        const uint64_t high_water_us = static_cast<uint64_t>(stats_.budget_us) * policy.high_water_pct / 100;
+        const uint64_t headroom_us = high_water_us > stats_.work_us ? high_water_us - stats_.work_us : 0;
+        int32_t pick = -1;
+        for (size_t i = 0; i < count; ++i) {
+            const ChannelLoad& load = *loads[i];
+            if (action == Action::Degrade) {
+                if (load.level >= policy.max_level) continue;
+                if (pick < 0 || load.priority < loads[pick]->priority ||
+                    (load.priority == loads[pick]->priority && load.costUs() > loads[pick]->costUs())) {
+                    pick = static_cast<int32_t>(i);
+                }
+            } else if (action == Action::Restore) {
+                if (load.level == DegradeLevel::Full || load.costUs() >= headroom_us) continue;
+                if (pick < 0 || load.priority > loads[pick]->priority) {
+                    pick = static_cast<int32_t>(i);
+                }
+            }
+        }
+        if (pick < 0) return -1;
+
+        auto& level = loads[pick]->level;
+        if (action == Action::Degrade) {
+            level = static_cast<DegradeLevel>(static_cast<uint8_t>(level) + 1);
+            if (level == DegradeLevel::HalfRate) {
+                loads[pick]->parity = loads[pick]->even_renders ? 0 : lighterParity(loads, count, pick);
+            }
+            ++stats_.degrades;
+        } else {
+            level = static_cast<DegradeLevel>(static_cast<uint8_t>(level) - 1);
+            ++stats_.restores;
+        }
+        return pick;
+    }
+
+    [[nodiscard]] const FrameBudgetStats& stats() const noexcept { return stats_; }
+
+    void reset() noexcept {
+        stats_ = FrameBudgetStats{};
+        work_x8_ = 0;
+        overload_frames_ = 0;
+        headroom_frames_ = 0;
+    }
+
+private:
+    // Half-rate channels are spread over even and odd frames by cost
+    static uint8_t lighterParity(ChannelLoad* const* loads, size_t count, int32_t except) noexcept {
+        uint32_t cost[2] = {0, 0};
+        for (size_t i = 0; i < count; ++i) {
+            if (static_cast<int32_t>(i) == except || loads[i]->level < DegradeLevel::HalfRate) continue;
+            cost[loads[i]->parity & 1] += loads[i]->costUs();
+        }
+        return cost[1] < cost[0] ? 1 : 0;
+    }
+
+    FrameBudgetStats stats_;
+    uint32_t work_x8_ = 0;
+    uint16_t overload_frames_ = 0;
+    uint16_t headroom_frames_ = 0;
+};
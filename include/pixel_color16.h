@@ -0,0 +1,232 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "pixel_core.h"
+
+// Portable 16-bit color path: scaling, blending and gamma keep 16 bits per component
+// so low-brightness fades do not collapse onto a handful of 8-bit codes. Output is
+// either dithered back to 8 bits or sent natively to 16-bit chips (HD108).
+
+enum class ColorDepth : uint8_t {
+    Bits8 = 8,
+    Bits16 = 16,
+};
+
+// Scale a 16-bit level by a 0..65535 factor (65535 = unchanged)
+[[nodiscard]] constexpr uint16_t scale16(uint16_t value, uint16_t scale) noexcept {
+    return static_cast<uint16_t>((static_cast<uint32_t>(value) * (static_cast<uint32_t>(scale) + 1)) >> 16);
+}
+
+// Widen an 8-bit level so 255 maps to 65535
+[[nodiscard]] constexpr uint16_t widen8(uint8_t value) noexcept {
+    return static_cast<uint16_t>(value * 257);
+}
+
+struct PixelColor16 {
+    uint16_t r = 0;
+    uint16_t g = 0;
+    uint16_t b = 0;
+    uint16_t w = 0;
+
+    constexpr PixelColor16() = default;
+    constexpr PixelColor16(uint16_t red, uint16_t green, uint16_t blue, uint16_t white = 0) noexcept
+        : r(red), g(green), b(blue), w(white) {}
+
+    static constexpr PixelColor16 from8(const PixelColor& c) noexcept {
+        return PixelColor16(widen8(c.r), widen8(c.g), widen8(c.b), widen8(c.w));
+    }
+
+    // Nearest 8-bit color, no dithering
+    [[nodiscard]] constexpr PixelColor to8() const noexcept {
+        const auto narrow = [](uint16_t v) {
+            return static_cast<uint8_t>((static_cast<uint32_t>(v) * 255 + 32767) / 65535);
+        };
+        return PixelColor(narrow(r), narrow(g), narrow(b), narrow(w));
+    }
+
+    [[nodiscard]] constexpr PixelColor16 scale(uint16_t factor) const noexcept {
+        return PixelColor16(scale16(r, factor), scale16(g, factor), scale16(b, factor), scale16(w, factor));
+    }
+
+    // amount 0 keeps this color, 65535 gives other
+    [[nodiscard]] constexpr PixelColor16 blend(const PixelColor16& other, uint16_t amount) const noexcept {
+        const uint16_t inv = static_cast<uint16_t>(65535 - amount);
+        return PixelColor16(
+            static_cast<uint16_t>(scale16(r, inv) + scale16(other.r, amount)),
+            static_cast<uint16_t>(scale16(g, inv) + scale16(other.g, amount)),
+            static_cast<uint16_t>(scale16(b, inv) + scale16(other.b, amount)),
+            static_cast<uint16_t>(scale16(w, inv) + scale16(other.w, amount))
+        );
+    }
+
+    // Component by index (0=r, 1=g, 2=b, 3=w)
+    [[nodiscard]] constexpr uint16_t component(uint8_t index) const noexcept {
+        switch (index) {
+            case 0:  return r;
+            case 1:  return g;
+            case 2:  return b;
+            default: return w;
+        }
+    }
+
+    constexpr bool operator==(const PixelColor16& other) const noexcept {
+        return r == other.r && g == other.g && b == other.b && w == other.w;
+    }
+    constexpr bool operator!=(const PixelColor16& other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+static_assert(PixelColor16::from8(PixelColor::White()).to8() == PixelColor::White());
+static_assert(PixelColor16(65535, 0, 0).scale(65535) == PixelColor16(65535, 0, 0));
+
+// Gamma 2.8, the curve GAMMA_TABLE approximates, sampled at 257 points for interpolation
+constexpr std::array<uint16_t, 257> generateGamma16Table() {
+    std::array<uint16_t, 257> table{};
+    for (int i = 0; i <= 256; ++i) {
+        const double x = i / 256.0;
+        // x^2.8 = x^2 * (x^0.2)^4, fifth root by Newton iteration
+        double root = 1.0;
+        if (x > 0.0) {
+            for (int n = 0; n < 40; ++n) {
+                root = (4.0 * root + x / (root * root * root * root)) / 5.0;
+            }
+        }
+        const double root4 = root * root * root * root;
+        const double y = (x > 0.0) ? x * x * root4 : 0.0;
+        table[i] = static_cast<uint16_t>(y * 65535.0 + 0.5);
+    }
+    return table;
+}
+
+inline constexpr std::array<uint16_t, 257> GAMMA16_TABLE = generateGamma16Table();
+
+static_assert(GAMMA16_TABLE[0] == 0 && GAMMA16_TABLE[256] == 65535);
+// Midpoint rounds to the 8-bit table's entry
+static_assert((GAMMA16_TABLE[128] + 128) / 257 == GAMMA_TABLE[128]);
+
+[[nodiscard]] constexpr uint16_t gammaCorrect16(uint16_t value) noexcept {
+    const uint32_t index = value >> 8;
+    const uint32_t frac = value & 0xFF;
+    const uint32_t a = GAMMA16_TABLE[index];
+    const uint32_t b = GAMMA16_TABLE[index + 1];
+    return static_cast<uint16_t>(a + (((b - a) * frac) >> 8));
+}
+
+// 1D ordered dither thresholds (8-entry bit-reversal pattern), centred in each step
+inline constexpr std::array<uint8_t, 8> DITHER_THRESHOLDS = {16, 144, 80, 208, 48, 176, 112, 240};
+
+// Span kernels. Each is a flat loop over a contiguous buffer with no per-pixel branches,
+// which keeps the 16-bit output pass within about 2x of the 8-bit scaling loop.
+
+inline void widenSpan(const PixelColor* in, PixelColor16* out, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = PixelColor16::from8(in[i]);
+    }
+}
+
+// Frame between two 8-bit keyframes at weight/256 (0..256), keeping the fraction
+inline void lerpSpan16(const PixelColor* from, const PixelColor* to, uint16_t weight,
+                       PixelColor16* out, size_t count) noexcept {
+    const uint32_t w = weight;
+    const uint32_t inv = 256 - w;
+    const auto lerp = [&](uint8_t a, uint8_t b) {
+        return static_cast<uint16_t>(((a * inv + b * w) * 257) >> 8);
+    };
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = PixelColor16(lerp(from[i].r, to[i].r), lerp(from[i].g, to[i].g),
+                              lerp(from[i].b, to[i].b), lerp(from[i].w, to[i].w));
+    }
+}
+
+// Reduced render resolution: `in` holds one sample per `factor` output pixels. Each output
+// pixel is the lerp of the samples either side of it; past the last sample it holds.
+// Calls emit(index, a, b, inv, w) with weights out of 256 for every output pixel.
+template <typename Emit>
+inline void upsampleSpan(const PixelColor* in, size_t in_count, uint8_t factor, size_t count, Emit&& emit) noexcept {
+    if (in_count == 0 || factor == 0) return;
+    const uint32_t step = (256u << 8) / factor;  // Weight per pixel in 8.8
+    size_t i = 0;
+    for (size_t j = 0; j < in_count && i < count; ++j) {
+        const PixelColor& a = in[j];
+        const PixelColor& b = in[j + 1 < in_count ? j + 1 : j];
+        for (uint32_t f = 0; f < factor && i < count; ++f, ++i) {
+            const uint32_t w = (f * step) >> 8;
+            emit(i, a, b, 256 - w, w);
+        }
+    }
+}
+
+// Upsample and scale by (scale + 1) / 65536 into 8-bit output in one pass
+inline void upsampleSpan(const PixelColor* in, size_t in_count, uint8_t factor, uint16_t scale,
+                         PixelColor* out, size_t count) noexcept {
+    const uint32_t s = static_cast<uint32_t>(scale) + 1;
+    upsampleSpan(in, in_count, factor, count,
+                 [&](size_t i, const PixelColor& a, const PixelColor& b, uint32_t inv, uint32_t w) {
+        const auto lerp = [&](uint8_t x, uint8_t y) {
+            return static_cast<uint8_t>(((x * inv + y * w) * s) >> 24);
+        };
+        out[i] = PixelColor(lerp(a.r, b.r), lerp(a.g, b.g), lerp(a.b, b.b), lerp(a.w, b.w));
+    });
+}
+
+// Upsample into 16-bit output, keeping the fraction of the lerp
+inline void upsampleSpan16(const PixelColor* in, size_t in_count, uint8_t factor,
+                           PixelColor16* out, size_t count) noexcept {
+    upsampleSpan(in, in_count, factor, count,
+                 [&](size_t i, const PixelColor& a, const PixelColor& b, uint32_t inv, uint32_t w) {
+        const auto lerp = [&](uint8_t x, uint8_t y) {
+            return static_cast<uint16_t>(((x * inv + y * w) * 257) >> 8);
+        };
+        out[i] = PixelColor16(lerp(a.r, b.r), lerp(a.g, b.g), lerp(a.b, b.b), lerp(a.w, b.w));
+    });
+}
+
+inline void scaleSpan16(PixelColor16* pixels, size_t count, uint16_t scale) noexcept {
+    if (scale == UINT16_MAX) return;
+    const uint32_t factor = static_cast<uint32_t>(scale) + 1;
+    for (size_t i = 0; i < count; ++i) {
+        PixelColor16& p = pixels[i];
+        p.r = static_cast<uint16_t>((p.r * factor) >> 16);
+        p.g = static_cast<uint16_t>((p.g * factor) >> 16);
+        p.b = static_cast<uint16_t>((p.b * factor) >> 16);
+        p.w = static_cast<uint16_t>((p.w * factor) >> 16);
+    }
+}
+
+inline void gammaSpan16(PixelColor16* pixels, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        PixelColor16& p = pixels[i];
+        p.r = gammaCorrect16(p.r);
+        p.g = gammaCorrect16(p.g);
+        p.b = gammaCorrect16(p.b);
+        p.w = gammaCorrect16(p.w);
+    }
+}
+
+// Blank pixels whose mask entry is zero; pixels past the end of the mask are blanked too
+inline void maskSpan16(PixelColor16* pixels, size_t count, const uint8_t* mask, size_t mask_count) noexcept {
+    const size_t masked = mask_count < count ? mask_count : count;
+    for (size_t i = 0; i < masked; ++i) {
+        if (!mask[i]) pixels[i] = PixelColor16();
+    }
+    for (size_t i = masked; i < count; ++i) {
+        pixels[i] = PixelColor16();
+    }
+}
+
+// Reduce to 8 bits with an ordered spatial dither: neighbouring pixels round the
+// fractional part at different thresholds, so a region averages to the 16-bit level
+inline void ditherSpan16(const PixelColor16* in, PixelColor* out, size_t count) noexcept {
+    // v * 255 / 256 is the level in 8.8 fixed point; threshold + fraction carries into the integer
+    const auto narrow = [](uint16_t v, uint32_t threshold) {
+        return static_cast<uint8_t>(((static_cast<uint32_t>(v) * 255 >> 8) + threshold) >> 8);
+    };
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t t = DITHER_THRESHOLDS[i & 7];
+        const PixelColor16& p = in[i];
+        out[i] = PixelColor(narrow(p.r, t), narrow(p.g, t), narrow(p.b, t), narrow(p.w, t));
+    }
+}
@@ -25,6 +25,39 @@ enum class PixelFormat : uint8_t {
     RGBW = 4
 };
 
+// Order in which a strip expects the color components on the wire.
+// W is sent last on RGBW strips unless the order starts with W.
+enum class ColorOrder : uint8_t {
+    GRB,   // WS2812B, SK6812
+    RGB,   // WS2811, WS2815
+    RBG,
+    GBR,
+    BRG,
+    BGR,
+    WRGB,  // TM1814
+    WGRB,
+    Default,  // GRB, or the clocked chipset's own order on PixelBus::SPI
+};
+
+// Component indices (0=r, 1=g, 2=b, 3=w) in wire order for an order/format pair
+[[nodiscard]] constexpr std::array<uint8_t, 4> colorOrderIndices(ColorOrder order, PixelFormat format) noexcept {
+    std::array<uint8_t, 3> rgb{};
+    switch (order) {
+        case ColorOrder::RGB:  rgb = {0, 1, 2}; break;
+        case ColorOrder::RBG:  rgb = {0, 2, 1}; break;
+        case ColorOrder::GBR:  rgb = {1, 2, 0}; break;
+        case ColorOrder::BRG:  rgb = {2, 0, 1}; break;
+        case ColorOrder::BGR:  rgb = {2, 1, 0}; break;
+        case ColorOrder::WRGB: rgb = {0, 1, 2}; break;
+        case ColorOrder::WGRB: rgb = {1, 0, 2}; break;
+        default:               rgb = {1, 0, 2}; break;
+    }
+    const bool white_first = format == PixelFormat::RGBW &&
+        (order == ColorOrder::WRGB || order == ColorOrder::WGRB);
+    if (white_first) return {3, rgb[0], rgb[1], rgb[2]};
+    return {rgb[0], rgb[1], rgb[2], 3};
+}
+
 struct PixelColor {
     uint8_t r = 0;
     uint8_t g = 0;
@@ -99,6 +132,16 @@ struct PixelColor {
     static constexpr PixelColor Cyan() noexcept { return PixelColor(0, 255, 255); }
     static constexpr PixelColor Magenta() noexcept { return PixelColor(255, 0, 255); }
 
+    // Component by index (0=r, 1=g, 2=b, 3=w); folds to a plain load for constant indices
+    [[nodiscard]] constexpr uint8_t component(uint8_t index) const noexcept {
+        switch (index) {
+            case 0:  return r;
+            case 1:  return g;
+            case 2:  return b;
+            default: return w;
+        }
+    }
+
     constexpr bool operator==(const PixelColor& other) const noexcept {
         return r == other.r && g == other.g && b == other.b && w == other.w;
     }
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pixel_core.h"
+
+// One period of a periodic effect, baked: for every position in the cycle the rendered
+// pixels, the encoded wire frame and the current draw. A channel replaying a cached
+// position copies the pixels back and hands the wire frame to its transport, with no
+// render, scaling or encode. Everything is keyed on the effect configuration generation
+// and the output scale; a change of either empties the cache.
+
+struct CycleCacheStats {
+    uint16_t period = 0;     // Frames in the cached cycle, 0 while not caching
+    uint16_t cached = 0;     // Positions currently filled
+    uint32_t bytes = 0;      // RAM held
+    uint32_t hits = 0;       // Frames served from the cache
+    uint32_t stores = 0;     // Frames rendered and encoded into it
+};
+
+class CycleCache {
+public:
+    static constexpr uint16_t NO_POSITION = UINT16_MAX;
+
+    explicit CycleCache(size_t budget_bytes = 0) noexcept : budget_(budget_bytes) {}
+
+    // Shape the cache for a cycle. False, and nothing held, if a full period does not
+    // fit the budget. A new generation drops every cached position.
+    bool configure(uint16_t period, size_t pixel_count, size_t frame_bytes, uint32_t generation) {
+        if (period == 0 || period == NO_POSITION) return false;
+        const size_t entry = pixel_count * sizeof(PixelColor) + frame_bytes;
+        if (static_cast<uint64_t>(entry) * period > budget_) {
+            release();
+            return false;
+        }
+        if (period != period_ || pixel_count != pixel_count_ || frame_bytes != frame_bytes_) {
+            period_ = period;
+            pixel_count_ = pixel_count;
+            frame_bytes_ = frame_bytes;
+            storage_.assign(entry * period, 0);
+            storage_.shrink_to_fit();
+            current_ma_.assign(period, 0);
+            valid_.assign(period, 0);
+            cached_ = 0;
+        }
+        if (generation != generation_) {
+            generation_ = generation;
+            invalidate();
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool contains(uint16_t position) const noexcept {
+        return position < period_ && valid_[position];
+    }
+
+    // Output scale the cached frames were encoded at
+    [[nodiscard]] uint16_t scale() const noexcept { return scale_; }
+
+    [[nodiscard]] const PixelColor* pixels(uint16_t position) const noexcept {
+        return reinterpret_cast<const PixelColor*>(&storage_[entryOffset(position)]);
+    }
+    [[nodiscard]] const uint8_t* frame(uint16_t position) const noexcept {
+        return &storage_[entryOffset(position) + pixel_count_ * sizeof(PixelColor)];
+    }
+    [[nodiscard]] size_t frameBytes() const noexcept { return frame_bytes_; }
+    [[nodiscard]] uint32_t currentMa(uint16_t position) const noexcept { return current_ma_[position]; }
+
+    void recordHit() noexcept { ++hits_; }
+
+    // Store a position; frames encoded at a different scale than the cached ones replace them
+    void store(uint16_t position, uint16_t scale, const PixelColor* pixels, const uint8_t* frame,
+               uint32_t current_ma) {
+        if (position >= period_) return;
+        if (scale != scale_) {
+            invalidate();
+            scale_ = scale;
+        }
+        std::copy(pixels, pixels + pixel_count_, reinterpret_cast<PixelColor*>(&storage_[entryOffset(position)]));
+        std::copy(frame, frame + frame_bytes_, &storage_[entryOffset(position) + pixel_count_ * sizeof(PixelColor)]);
+        current_ma_[position] = current_ma;
+        if (!valid_[position]) {
+            valid_[position] = 1;
+            ++cached_;
+        }
+        ++stores_;
+    }
+
+    void invalidate() noexcept {
+        std::fill(valid_.begin(), valid_.end(), uint8_t(0));
+        cached_ = 0;
+    }
+
+    void release() noexcept {
+        storage_.clear();
+        storage_.shrink_to_fit();
+        current_ma_.clear();
+        valid_.clear();
+        period_ = 0;
+        pixel_count_ = 0;
+        frame_bytes_ = 0;
+        cached_ = 0;
+    }
+
+    [[nodiscard]] CycleCacheStats stats() const noexcept {
+        return CycleCacheStats{period_, cached_, static_cast<uint32_t>(storage_.capacity()), hits_, stores_};
+    }
+
+private:
+    [[nodiscard]] size_t entryOffset(uint16_t position) const noexcept {
+        return static_cast<size_t>(position) * (pixel_count_ * sizeof(PixelColor) + frame_bytes_);
+    }
+
+    size_t budget_;
+    uint16_t period_ = 0;
+    size_t pixel_count_ = 0;
+    size_t frame_bytes_ = 0;
+    uint32_t generation_ = 0;
+    uint16_t scale_ = 0;
+    uint16_t cached_ = 0;
+    uint32_t hits_ = 0;
+    uint32_t stores_ = 0;
+    std::vector<uint8_t> storage_;  // period_ entries of pixels then wire frame
+    std::vector<uint32_t> current_ma_;
+    std::vector<uint8_t> valid_;
+};
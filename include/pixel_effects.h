@@ -2,6 +2,7 @@
 
 #include "kd_pixdriver.h"
 #include "pixel_core.h"
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 #include <string>
@@ -28,8 +29,12 @@ public:
     void unregisterEffect(std::string_view name);
     [[nodiscard]] std::vector<EffectInfo> getAllEffects() const;
 
+    // Audio analysis the sound-reactive effects render from, set once per frame
+    void setAudioFrame(const AudioFrame& frame) noexcept { audio_frame_ = frame; }
+
 private:
     uint32_t update_rate_hz_;
+    AudioFrame audio_frame_;
 
     struct EffectEntry {
         EffectFn fn;
@@ -56,6 +61,9 @@ private:
     void applyPulse(PixelChannel* channel, uint32_t tick);
     void applyMeteor(PixelChannel* channel, uint32_t tick);
     void applyRunningLights(PixelChannel* channel, uint32_t tick);
+    void applyImage(PixelChannel* channel, uint32_t tick);
+    void applySpectrum(PixelChannel* channel);
+    void applyBeat(PixelChannel* channel);
 
     // Effect state - using a more memory-efficient approach
     struct EffectState {
@@ -81,6 +89,12 @@ private:
 
     // Helper functions
     [[nodiscard]] uint32_t getEffectInterval(uint8_t speed) const noexcept;
+    // Animation step at a frame. Deterministic effects derive their position from the frame
+    // counter rather than counting steps, so controllers sharing a frame clock (pixel_sync.h)
+    // show the same frame.
+    [[nodiscard]] static uint32_t effectStep(uint32_t tick, uint32_t interval) noexcept {
+        return tick / std::max<uint32_t>(interval, 1);
+    }
     void ensureChannelState(int32_t channel_id);
 
     // Utility for gamma correction
@@ -0,0 +1,215 @@
+/* Pixel image format: column-scanned images for logos and persistence-of-vision playback
+ * Portable (stdio only), shared by PixelImage (pixel_show.h) and tools/pixshow.
+ *
+ * Layout, all integers little-endian:
+ *   header   16 bytes: "PXIM", version, colors per pixel (3 or 4), height (pixels per
+ *            column), width (columns), column rate, keyframe interval, reserved
+ *   index    4 bytes per keyframe column: file offset of its record
+ *   columns  one record per column, in the show record format (pixel_show_format.h):
+ *            kind (u8), payload length (u32), run-length payload. A KEY column stands
+ *            alone, a DELTA column is XORed with the column before it, and every
+ *            keyframe_interval-th column is a KEY so the player can seek.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "pixel_show_format.h"
+
+inline constexpr uint32_t IMAGE_MAGIC = 0x4D495850;  // "PXIM"
+inline constexpr uint8_t IMAGE_VERSION = 1;
+inline constexpr size_t IMAGE_HEADER_BYTES = 16;
+inline constexpr size_t IMAGE_INDEX_BYTES = 4;
+inline constexpr size_t IMAGE_CHUNK_BYTES = 512;  // Read window of the streaming decoder
+inline constexpr uint8_t IMAGE_SPEED_UNIT = 5;    // Effect speed that plays at the stored rate
+
+struct ImageHeader {
+    uint8_t colors = 3;
+    uint16_t height = 0;               // Pixels per column
+    uint16_t width = 0;                // Columns
+    uint16_t column_rate_hz = 30;      // Columns per second as authored
+    uint16_t keyframe_interval = 16;   // Columns between keyframes, at least 1
+
+    [[nodiscard]] size_t columnBytes() const noexcept { return static_cast<size_t>(height) * colors; }
+    [[nodiscard]] size_t keyframeCount() const noexcept {
+        return keyframe_interval ? (width + keyframe_interval - 1u) / keyframe_interval : 0;
+    }
+    [[nodiscard]] size_t dataOffset() const noexcept {
+        return IMAGE_HEADER_BYTES + keyframeCount() * IMAGE_INDEX_BYTES;
+    }
+};
+
+// Encode width columns of pixels, stored column after column (height * colors bytes each).
+// A DELTA column is written only where it comes out smaller than the column on its own.
+inline std::vector<uint8_t> encodeImage(const ImageHeader& header, const uint8_t* pixels) {
+    const size_t size = header.columnBytes();
+    std::vector<uint8_t> out(header.dataOffset(), 0);
+    showPut32(&out[0], IMAGE_MAGIC);
+    out[4] = IMAGE_VERSION;
+    out[5] = header.colors;
+    showPut16(&out[6], header.height);
+    showPut16(&out[8], header.width);
+    showPut16(&out[10], header.column_rate_hz);
+    showPut16(&out[12], header.keyframe_interval);
+    if (header.keyframe_interval == 0) return out;
+
+    std::vector<uint8_t> key;
+    std::vector<uint8_t> delta;
+    std::vector<uint8_t> scratch(size);
+    for (size_t c = 0; c < header.width; ++c) {
+        const uint8_t* column = pixels + c * size;
+        const uint8_t* previous = column - size;
+        const bool keyframe = c % header.keyframe_interval == 0;
+        const size_t record = out.size();
+        if (keyframe) {
+            showPut32(&out[IMAGE_HEADER_BYTES + c / header.keyframe_interval * IMAGE_INDEX_BYTES],
+                      static_cast<uint32_t>(record));
+        }
+
+        ShowRecordKind kind = ShowRecordKind::KEY;
+        key.clear();
+        delta.clear();
+        if (!keyframe && std::equal(column, column + size, previous)) {
+            kind = ShowRecordKind::SAME;
+        } else {
+            encodeShowRle(column, size, key);
+            if (!keyframe) {
+                for (size_t i = 0; i < size; ++i) scratch[i] = column[i] ^ previous[i];
+                encodeShowRle(scratch.data(), size, delta);
+                if (delta.size() < key.size()) kind = ShowRecordKind::DELTA;
+            }
+        }
+        const std::vector<uint8_t>& payload = kind == ShowRecordKind::DELTA ? delta : key;
+        const size_t length = kind == ShowRecordKind::SAME ? 0 : payload.size();
+        out.resize(record + SHOW_RECORD_BYTES);
+        out[record] = static_cast<uint8_t>(kind);
+        showPut32(&out[record + 1], static_cast<uint32_t>(length));
+        out.insert(out.end(), payload.begin(), payload.begin() + length);
+    }
+    return out;
+}
+
+// Decodes one column at a time out of a source through a single chunk window, so memory
+// is the window, one column and the keyframe index however large the image is. Seeking
+// decodes forward from the current column or from the nearest keyframe, whichever is
+// fewer records.
+class ImageDecoder {
+public:
+    explicit ImageDecoder(ShowSource& source, size_t chunk_bytes = IMAGE_CHUNK_BYTES)
+        : reader_(source, chunk_bytes) {}
+
+    // Read and check the header and keyframe index
+    bool open() {
+        uint8_t head[IMAGE_HEADER_BYTES];
+        reader_.seek(0);
+        if (!reader_.read(head, sizeof(head)) || showGet32(head) != IMAGE_MAGIC || head[4] != IMAGE_VERSION) {
+            return false;
+        }
+        header_.colors = head[5];
+        header_.height = showGet16(&head[6]);
+        header_.width = showGet16(&head[8]);
+        header_.column_rate_hz = showGet16(&head[10]);
+        header_.keyframe_interval = showGet16(&head[12]);
+        if ((header_.colors != 3 && header_.colors != 4) || header_.height == 0 || header_.width == 0 ||
+            header_.column_rate_hz == 0 || header_.keyframe_interval == 0) {
+            return false;
+        }
+
+        index_.assign(header_.keyframeCount(), 0);
+        for (uint32_t& offset : index_) {
+            uint8_t entry[IMAGE_INDEX_BYTES];
+            if (!reader_.read(entry, sizeof(entry))) return false;
+            offset = showGet32(entry);
+            if (offset < header_.dataOffset()) return false;
+        }
+        column_.assign(header_.columnBytes(), 0);
+        next_ = 0;
+        valid_ = false;
+        return true;
+    }
+
+    // Make column c current
+    ShowStatus seek(uint16_t c) {
+        if (c >= header_.width) return ShowStatus::END;
+        if (valid_ && c + 1u == next_) return ShowStatus::OK;
+
+        const uint16_t key = static_cast<uint16_t>(c - c % header_.keyframe_interval);
+        if (!valid_ || c < next_ || key >= next_) {
+            reader_.seek(index_[key / header_.keyframe_interval]);
+            next_ = key;
+        }
+        while (next_ <= c) {
+            const ShowStatus status = decodeNext();
+            if (status != ShowStatus::OK) return status;
+        }
+        return ShowStatus::OK;
+    }
+
+    [[nodiscard]] const ImageHeader& header() const noexcept { return header_; }
+    [[nodiscard]] const uint8_t* columnData() const noexcept { return column_.data(); }
+    [[nodiscard]] uint16_t column() const noexcept { return valid_ ? static_cast<uint16_t>(next_ - 1) : 0; }
+    [[nodiscard]] size_t memoryBytes() const noexcept {
+        return reader_.capacity() + column_.capacity() + index_.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    ShowStatus decodeNext() {
+        valid_ = false;
+        uint8_t record[SHOW_RECORD_BYTES];
+        if (!reader_.read(record, sizeof(record))) return ShowStatus::CORRUPT;
+        const auto kind = static_cast<ShowRecordKind>(record[0]);
+        const uint32_t length = showGet32(&record[1]);
+        if (kind == ShowRecordKind::SAME) {
+            if (length != 0) return ShowStatus::CORRUPT;
+        } else if (kind != ShowRecordKind::KEY && kind != ShowRecordKind::DELTA) {
+            return ShowStatus::CORRUPT;
+        } else if (!decodeShowRle(reader_, length, column_.data(), column_.size(),
+                                  kind == ShowRecordKind::DELTA)) {
+            return ShowStatus::CORRUPT;
+        }
+        ++next_;
+        valid_ = true;
+        return ShowStatus::OK;
+    }
+
+    ShowChunkReader reader_;
+    ImageHeader header_;
+    std::vector<uint32_t> index_;  // Record offset of every keyframe column
+    std::vector<uint8_t> column_;  // Current column, the reference for the next delta
+    uint32_t next_ = 0;            // Column the reader is positioned at
+    bool valid_ = false;           // column_ holds column next_ - 1
+};
+
+// Column position on the driver's frame clock. Every frame moves it by
+// rate * speed / IMAGE_SPEED_UNIT / frame rate columns in integer arithmetic, carrying the
+// remainder, so the column rate is exact on average for any ratio to the frame rate and
+// never drifts against the frame clock. A speed change applies from the frame it is seen.
+class ImageClock {
+public:
+    void start(uint32_t tick) noexcept {
+        start_tick_ = last_tick_ = tick;
+        remainder_ = 0;
+        position_ = 0;
+    }
+
+    uint64_t advance(uint32_t tick, uint32_t rate_hz, uint8_t speed, uint32_t frame_rate_hz) noexcept {
+        const uint64_t num = uint64_t(tick - last_tick_) * rate_hz * speed + remainder_;
+        const uint64_t den = uint64_t(std::max<uint32_t>(frame_rate_hz, 1)) * IMAGE_SPEED_UNIT;
+        last_tick_ = tick;
+        remainder_ = num % den;
+        position_ += num / den;
+        return position_;
+    }
+
+    [[nodiscard]] uint64_t position() const noexcept { return position_; }
+    [[nodiscard]] uint32_t elapsedFrames(uint32_t tick) const noexcept { return tick - start_tick_; }
+
+private:
+    uint32_t start_tick_ = 0;
+    uint32_t last_tick_ = 0;
+    uint64_t remainder_ = 0;
+    uint64_t position_ = 0;
+};
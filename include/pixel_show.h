@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "pixel_core.h"
+#include "pixel_image_format.h"
+#include "pixel_show_format.h"
+
+class PixelChannel;
+class PixelPipeline;
+
+// Plays a pre-rendered show (pixel_show_format.h) into channel buffers on the driver's
+// frame clock. The file is streamed one SHOW_CHUNK_BYTES chunk at a time from a flash
+// partition or a mounted filesystem. Track n drives the n-th channel added unless bound
+// otherwise; while playing, bound channels skip their effect. Brightness, current
+// limiting and masks still apply on top.
+class PixelShowPlayer {
+public:
+    PixelShowPlayer();                                // Plays on PixelDriver's pipeline
+    explicit PixelShowPlayer(PixelPipeline& pipeline);
+    ~PixelShowPlayer();
+
+    PixelShowPlayer(const PixelShowPlayer&) = delete;
+    PixelShowPlayer& operator=(const PixelShowPlayer&) = delete;
+
+    bool openPartition(const char* label);  // Data partition holding a show image
+    bool openFile(const char* path);
+    void close();
+
+    bool bindTrack(uint8_t track, int32_t channel_id);  // channel_id -1 leaves the track unused
+    bool play(bool loop = true);  // Starts with the next driver frame
+    void stop();
+
+    [[nodiscard]] bool isPlaying() const noexcept { return playing_; }
+    [[nodiscard]] ShowHeader getHeader() const;
+    [[nodiscard]] uint32_t getFrameIndex() const;
+    [[nodiscard]] bool ownsChannel(int32_t channel_id) const noexcept;
+
+private:
+    friend class PixelPipeline;
+    void renderFrame(uint32_t tick);  // Driver task, once per frame
+    bool openSource(std::unique_ptr<ShowSource> source, const char* name);
+    void unpackTrack(size_t track, PixelChannel& channel) const;
+
+    PixelPipeline& pipeline_;
+    SemaphoreHandle_t mutex_;
+    std::unique_ptr<ShowSource> source_;
+    std::unique_ptr<ShowDecoder> decoder_;
+    std::vector<int32_t> track_channels_;
+    volatile bool playing_ = false;
+    bool loop_ = true;
+    bool clock_started_ = false;
+    uint32_t start_tick_ = 0;
+};
+
+// Captures the rendered channel buffers (before brightness and current limiting) into a
+// show file, one frame per driver frame. Writes are batched into SHOW_CHUNK_BYTES blocks
+// but still happen in the driver task, so record to a fast filesystem.
+class PixelShowRecorder {
+public:
+    PixelShowRecorder();                                // Records PixelDriver's pipeline
+    explicit PixelShowRecorder(PixelPipeline& pipeline) : pipeline_(pipeline) {}
+    ~PixelShowRecorder();
+
+    PixelShowRecorder(const PixelShowRecorder&) = delete;
+    PixelShowRecorder& operator=(const PixelShowRecorder&) = delete;
+
+    // One track per channel id, every channel when empty
+    bool start(const char* path, const std::vector<int32_t>& channel_ids = {},
+               uint16_t keyframe_interval = 60);
+    bool stop();  // Flushes and writes the final frame count
+
+    [[nodiscard]] bool isRecording() const noexcept { return file_ != nullptr; }
+    [[nodiscard]] uint32_t getFrameCount() const noexcept { return encoder_ ? encoder_->frameCount() : 0; }
+
+private:
+    friend class PixelPipeline;
+    void captureFrame();  // Driver task, once per frame
+    bool flush();
+
+    PixelPipeline& pipeline_;
+    std::FILE* file_ = nullptr;
+    std::unique_ptr<ShowEncoder> encoder_;
+    std::vector<int32_t> channel_ids_;
+    std::vector<uint8_t> track_bytes_;
+    std::vector<uint8_t> pending_;
+    bool failed_ = false;
+};
+
+// Playback of a column-scanned image by the IMAGE effect
+struct ImagePlayback {
+    uint16_t column_rate_hz = 0;  // 0 = the rate stored in the image
+    bool reverse = false;         // Last column first
+    bool loop = true;             // Otherwise black after the last column
+    uint16_t row_offset = 0;      // Image row shown on the first pixel
+    int16_t scroll_rows_hz = 0;   // Rows per second the offset moves, either direction
+};
+
+// Column-scanned image (pixel_image_format.h) for the IMAGE effect: each frame shows the
+// column due on the driver's frame clock, decoded straight from flash or a file through
+// an IMAGE_CHUNK_BYTES window. The column is scaled to the channel's render buffer and
+// the effect speed scales the column rate (5 = as stored). Attach with
+// PixelDriver::setImage(); playback starts on the next frame the effect renders.
+class PixelImage {
+public:
+    explicit PixelImage(const ImagePlayback& playback = {}) : playback_(playback) {}
+
+    PixelImage(const PixelImage&) = delete;
+    PixelImage& operator=(const PixelImage&) = delete;
+
+    bool openPartition(const char* label);  // Data partition holding an image
+    bool openFile(const char* path);
+    bool openMemory(const uint8_t* data, size_t size);  // data must outlive the image
+
+    [[nodiscard]] bool isOpen() const noexcept { return decoder_ != nullptr; }
+    [[nodiscard]] ImageHeader getHeader() const noexcept { return decoder_ ? decoder_->header() : ImageHeader{}; }
+    [[nodiscard]] const ImagePlayback& getPlayback() const noexcept { return playback_; }
+    [[nodiscard]] uint16_t getColumn() const noexcept { return decoder_ ? decoder_->column() : 0; }
+
+private:
+    friend class PixelEffectEngine;
+    void render(std::vector<PixelColor>& buffer, uint32_t tick, uint8_t speed, uint32_t frame_rate_hz);  // Driver task
+    bool openSource(std::unique_ptr<ShowSource> source, const char* name);
+
+    ImagePlayback playback_;
+    std::unique_ptr<ShowSource> source_;
+    std::unique_ptr<ImageDecoder> decoder_;
+    ImageClock clock_;
+    bool started_ = false;
+    bool failed_ = false;
+};
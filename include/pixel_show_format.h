@@ -0,0 +1,400 @@
+/* Pixel show format: pre-rendered frame sequences
+ * Portable (stdio only), shared by the on-device player/recorder and tools/pixshow.
+ *
+ * Layout, all integers little-endian:
+ *   header   16 bytes: "PXSH", version, track count, frame rate, keyframe interval,
+ *            reserved, frame count (0 = play until the data ends)
+ *   tracks   4 bytes each: pixel count, colors per pixel (3 or 4), reserved
+ *   frames   for every frame, one record per track: kind (u8), payload length (u32),
+ *            payload. Payloads are the track's bytes (r, g, b[, w] per pixel) run-length
+ *            encoded, either as is (KEY) or XORed with the track's previous frame (DELTA).
+ *            SAME records have no payload.
+ *
+ * Run-length code: a control byte c < 0x80 is followed by c + 1 literal bytes, c >= 0x80
+ * by one byte repeated (c & 0x7F) + 3 times. In a DELTA payload an unchanged span is a
+ * run of zeros, so a mostly static frame costs a few bytes per 130 unchanged bytes.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+inline constexpr uint32_t SHOW_MAGIC = 0x48535850;  // "PXSH"
+inline constexpr uint8_t SHOW_VERSION = 1;
+inline constexpr size_t SHOW_HEADER_BYTES = 16;
+inline constexpr size_t SHOW_TRACK_BYTES = 4;
+inline constexpr size_t SHOW_RECORD_BYTES = 5;
+inline constexpr size_t SHOW_CHUNK_BYTES = 4096;  // Read size of the streaming player
+inline constexpr uint8_t SHOW_MAX_TRACKS = 32;
+
+inline constexpr size_t SHOW_RLE_MAX_LITERAL = 128;
+inline constexpr size_t SHOW_RLE_MIN_RUN = 3;
+inline constexpr size_t SHOW_RLE_MAX_RUN = 130;
+
+enum class ShowRecordKind : uint8_t {
+    KEY = 0,
+    DELTA = 1,
+    SAME = 2,
+};
+
+struct ShowHeader {
+    uint8_t track_count = 0;
+    uint16_t frame_rate_hz = 60;
+    uint16_t keyframe_interval = 60;  // Frames between keyframes, 0 = only the first
+    uint32_t frame_count = 0;
+};
+
+struct ShowTrack {
+    uint16_t pixel_count = 0;
+    uint8_t colors = 3;
+
+    [[nodiscard]] size_t bytes() const noexcept { return static_cast<size_t>(pixel_count) * colors; }
+};
+
+inline void showPut16(uint8_t* out, uint16_t v) noexcept {
+    out[0] = static_cast<uint8_t>(v);
+    out[1] = static_cast<uint8_t>(v >> 8);
+}
+inline void showPut32(uint8_t* out, uint32_t v) noexcept {
+    showPut16(out, static_cast<uint16_t>(v));
+    showPut16(out + 2, static_cast<uint16_t>(v >> 16));
+}
+[[nodiscard]] inline uint16_t showGet16(const uint8_t* in) noexcept {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+[[nodiscard]] inline uint32_t showGet32(const uint8_t* in) noexcept {
+    return showGet16(in) | (static_cast<uint32_t>(showGet16(in + 2)) << 16);
+}
+
+// Offset of the first frame record
+[[nodiscard]] constexpr size_t showDataOffset(uint8_t track_count) noexcept {
+    return SHOW_HEADER_BYTES + static_cast<size_t>(track_count) * SHOW_TRACK_BYTES;
+}
+
+// Header and track table, showDataOffset(tracks.size()) bytes
+inline std::vector<uint8_t> encodeShowHeader(const ShowHeader& header, const std::vector<ShowTrack>& tracks) {
+    std::vector<uint8_t> out(showDataOffset(static_cast<uint8_t>(tracks.size())), 0);
+    showPut32(&out[0], SHOW_MAGIC);
+    out[4] = SHOW_VERSION;
+    out[5] = static_cast<uint8_t>(tracks.size());
+    showPut16(&out[6], header.frame_rate_hz);
+    showPut16(&out[8], header.keyframe_interval);
+    showPut32(&out[12], header.frame_count);
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        uint8_t* entry = &out[SHOW_HEADER_BYTES + i * SHOW_TRACK_BYTES];
+        showPut16(entry, tracks[i].pixel_count);
+        entry[2] = tracks[i].colors;
+    }
+    return out;
+}
+
+// Run-length encode size bytes onto out
+inline void encodeShowRle(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    size_t literal_start = 0;
+    size_t i = 0;
+    const auto flushLiteral = [&](size_t end) {
+        while (literal_start < end) {
+            const size_t n = std::min(end - literal_start, SHOW_RLE_MAX_LITERAL);
+            out.push_back(static_cast<uint8_t>(n - 1));
+            out.insert(out.end(), data + literal_start, data + literal_start + n);
+            literal_start += n;
+        }
+    };
+    while (i < size) {
+        size_t run = 1;
+        while (i + run < size && run < SHOW_RLE_MAX_RUN && data[i + run] == data[i]) ++run;
+        if (run >= SHOW_RLE_MIN_RUN) {
+            flushLiteral(i);
+            out.push_back(static_cast<uint8_t>(0x80 | (run - SHOW_RLE_MIN_RUN)));
+            out.push_back(data[i]);
+            i += run;
+            literal_start = i;
+        } else {
+            i += run;
+        }
+    }
+    flushLiteral(size);
+}
+
+// Random-access byte source: a file, a flash partition, a memory buffer
+class ShowSource {
+public:
+    virtual ~ShowSource() = default;
+    // Bytes actually read, short at the end of the data
+    virtual size_t readAt(size_t offset, uint8_t* out, size_t len) = 0;
+};
+
+class ShowFileSource final : public ShowSource {
+public:
+    explicit ShowFileSource(const char* path) : file_(std::fopen(path, "rb")) {}
+    ~ShowFileSource() override {
+        if (file_) std::fclose(file_);
+    }
+    ShowFileSource(const ShowFileSource&) = delete;
+    ShowFileSource& operator=(const ShowFileSource&) = delete;
+
+    [[nodiscard]] bool isOpen() const noexcept { return file_ != nullptr; }
+
+    size_t readAt(size_t offset, uint8_t* out, size_t len) override {
+        if (!file_ || std::fseek(file_, static_cast<long>(offset), SEEK_SET) != 0) return 0;
+        return std::fread(out, 1, len, file_);
+    }
+
+private:
+    std::FILE* file_;
+};
+
+class ShowMemorySource final : public ShowSource {
+public:
+    ShowMemorySource(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    size_t readAt(size_t offset, uint8_t* out, size_t len) override {
+        if (offset >= size_) return 0;
+        const size_t n = std::min(len, size_ - offset);
+        std::copy(data_ + offset, data_ + offset + n, out);
+        return n;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+};
+
+// Sequential reader over a source through one fixed-size chunk
+class ShowChunkReader {
+public:
+    explicit ShowChunkReader(ShowSource& source, size_t chunk_bytes = SHOW_CHUNK_BYTES)
+        : source_(source), chunk_(chunk_bytes) {}
+
+    void seek(size_t offset) noexcept {
+        if (offset >= chunk_offset_ && offset <= chunk_offset_ + chunk_len_) {
+            pos_ = offset - chunk_offset_;
+        } else {
+            chunk_offset_ = offset;
+            chunk_len_ = 0;
+            pos_ = 0;
+        }
+    }
+
+    [[nodiscard]] size_t position() const noexcept { return chunk_offset_ + pos_; }
+    [[nodiscard]] size_t capacity() const noexcept { return chunk_.size(); }
+
+    bool readByte(uint8_t& out) {
+        if (pos_ == chunk_len_ && !fill()) return false;
+        out = chunk_[pos_++];
+        return true;
+    }
+
+    bool read(uint8_t* out, size_t len) {
+        while (len > 0) {
+            if (pos_ == chunk_len_ && !fill()) return false;
+            const size_t n = std::min(len, chunk_len_ - pos_);
+            std::copy(&chunk_[pos_], &chunk_[pos_] + n, out);
+            pos_ += n;
+            out += n;
+            len -= n;
+        }
+        return true;
+    }
+
+private:
+    bool fill() {
+        chunk_offset_ += chunk_len_;
+        pos_ = 0;
+        chunk_len_ = source_.readAt(chunk_offset_, chunk_.data(), chunk_.size());
+        return chunk_len_ > 0;
+    }
+
+    ShowSource& source_;
+    std::vector<uint8_t> chunk_;
+    size_t chunk_offset_ = 0;
+    size_t chunk_len_ = 0;
+    size_t pos_ = 0;
+};
+
+// Decode one run-length payload into frame (size bytes), XORing when delta.
+// False if the payload is malformed or does not fill the frame exactly.
+inline bool decodeShowRle(ShowChunkReader& in, uint32_t length, uint8_t* frame, size_t size, bool delta) {
+    const size_t end = in.position() + length;
+    size_t out = 0;
+    uint8_t literal[SHOW_RLE_MAX_LITERAL];
+    while (out < size) {
+        uint8_t control = 0;
+        if (!in.readByte(control)) return false;
+        if (control & 0x80) {
+            const size_t n = (control & 0x7F) + SHOW_RLE_MIN_RUN;
+            uint8_t value = 0;
+            if (out + n > size || !in.readByte(value)) return false;
+            if (!delta) {
+                std::fill(frame + out, frame + out + n, value);
+            } else if (value != 0) {
+                for (size_t i = 0; i < n; ++i) frame[out + i] ^= value;
+            }
+            out += n;
+        } else {
+            const size_t n = static_cast<size_t>(control) + 1;
+            if (out + n > size) return false;
+            if (!delta) {
+                if (!in.read(frame + out, n)) return false;
+            } else {
+                if (!in.read(literal, n)) return false;
+                for (size_t i = 0; i < n; ++i) frame[out + i] ^= literal[i];
+            }
+            out += n;
+        }
+    }
+    return in.position() == end;
+}
+
+// Builds frame records, keeping the previous frame of every track for the deltas
+class ShowEncoder {
+public:
+    ShowEncoder(const ShowHeader& header, std::vector<ShowTrack> tracks)
+        : header_(header), tracks_(std::move(tracks)) {
+        header_.track_count = static_cast<uint8_t>(tracks_.size());
+        previous_.resize(tracks_.size());
+        for (size_t t = 0; t < tracks_.size(); ++t) previous_[t].resize(tracks_[t].bytes());
+    }
+
+    [[nodiscard]] const ShowHeader& header() const noexcept { return header_; }
+    [[nodiscard]] const std::vector<ShowTrack>& tracks() const noexcept { return tracks_; }
+    [[nodiscard]] uint32_t frameCount() const noexcept { return frames_; }
+
+    // Header with the frame count so far, to write first or patch in at the end
+    [[nodiscard]] std::vector<uint8_t> encodeHeader() const {
+        ShowHeader header = header_;
+        header.frame_count = frames_;
+        return encodeShowHeader(header, tracks_);
+    }
+
+    // Start the next frame; the first frame and every keyframe_interval-th are keyframes
+    void beginFrame() noexcept {
+        keyframe_ = frames_ == 0 ||
+                    (header_.keyframe_interval > 0 && frames_ % header_.keyframe_interval == 0);
+        ++frames_;
+    }
+
+    // Append the record of track t, whose new contents are data (tracks()[t].bytes() long)
+    void encodeTrack(size_t t, const uint8_t* data, std::vector<uint8_t>& out) {
+        std::vector<uint8_t>& previous = previous_[t];
+        const size_t size = previous.size();
+        const size_t record = out.size();
+        out.resize(record + SHOW_RECORD_BYTES);
+
+        ShowRecordKind kind = ShowRecordKind::KEY;
+        if (!keyframe_ && std::equal(data, data + size, previous.begin())) {
+            kind = ShowRecordKind::SAME;
+        } else if (!keyframe_) {
+            kind = ShowRecordKind::DELTA;
+            scratch_.resize(size);
+            for (size_t i = 0; i < size; ++i) scratch_[i] = data[i] ^ previous[i];
+            encodeShowRle(scratch_.data(), size, out);
+        } else {
+            encodeShowRle(data, size, out);
+        }
+
+        out[record] = static_cast<uint8_t>(kind);
+        showPut32(&out[record + 1], static_cast<uint32_t>(out.size() - record - SHOW_RECORD_BYTES));
+        std::copy(data, data + size, previous.begin());
+    }
+
+private:
+    ShowHeader header_;
+    std::vector<ShowTrack> tracks_;
+    std::vector<std::vector<uint8_t>> previous_;
+    std::vector<uint8_t> scratch_;
+    uint32_t frames_ = 0;
+    bool keyframe_ = true;
+};
+
+enum class ShowStatus : uint8_t {
+    OK,
+    END,      // No more frames (frame count reached or data ended)
+    CORRUPT,  // Malformed record
+};
+
+// Streams frames out of a source, one chunk of the file in memory at a time. After each
+// decodeFrame() trackData(t) holds the current bytes of track t.
+class ShowDecoder {
+public:
+    explicit ShowDecoder(ShowSource& source, size_t chunk_bytes = SHOW_CHUNK_BYTES)
+        : reader_(source, chunk_bytes) {}
+
+    // Read and check the header and track table
+    bool open() {
+        uint8_t head[SHOW_HEADER_BYTES];
+        reader_.seek(0);
+        if (!reader_.read(head, sizeof(head)) || showGet32(head) != SHOW_MAGIC || head[4] != SHOW_VERSION) {
+            return false;
+        }
+        header_.track_count = head[5];
+        header_.frame_rate_hz = showGet16(&head[6]);
+        header_.keyframe_interval = showGet16(&head[8]);
+        header_.frame_count = showGet32(&head[12]);
+        if (header_.track_count == 0 || header_.track_count > SHOW_MAX_TRACKS || header_.frame_rate_hz == 0) {
+            return false;
+        }
+
+        tracks_.assign(header_.track_count, ShowTrack{});
+        frames_.assign(header_.track_count, {});
+        for (auto& track : tracks_) {
+            uint8_t entry[SHOW_TRACK_BYTES];
+            if (!reader_.read(entry, sizeof(entry))) return false;
+            track.pixel_count = showGet16(entry);
+            track.colors = entry[2];
+            if (track.colors != 3 && track.colors != 4) return false;
+        }
+        for (size_t t = 0; t < tracks_.size(); ++t) frames_[t].assign(tracks_[t].bytes(), 0);
+        rewind();
+        return true;
+    }
+
+    // Back to the first frame, which is always a keyframe
+    void rewind() noexcept {
+        reader_.seek(showDataOffset(header_.track_count));
+        frame_index_ = 0;
+    }
+
+    ShowStatus decodeFrame() {
+        if (header_.frame_count != 0 && frame_index_ >= header_.frame_count) return ShowStatus::END;
+
+        for (size_t t = 0; t < tracks_.size(); ++t) {
+            uint8_t record[SHOW_RECORD_BYTES];
+            if (!reader_.read(record, sizeof(record))) {
+                return t == 0 ? ShowStatus::END : ShowStatus::CORRUPT;
+            }
+            const auto kind = static_cast<ShowRecordKind>(record[0]);
+            const uint32_t length = showGet32(&record[1]);
+            if (kind == ShowRecordKind::SAME) {
+                if (length != 0) return ShowStatus::CORRUPT;
+                continue;
+            }
+            if (kind != ShowRecordKind::KEY && kind != ShowRecordKind::DELTA) {
+                // Erased flash after the last frame reads as 0xFF
+                return (t == 0 && record[0] == 0xFF) ? ShowStatus::END : ShowStatus::CORRUPT;
+            }
+            if (!decodeShowRle(reader_, length, frames_[t].data(), frames_[t].size(),
+                               kind == ShowRecordKind::DELTA)) {
+                return ShowStatus::CORRUPT;
+            }
+        }
+        ++frame_index_;
+        return ShowStatus::OK;
+    }
+
+    [[nodiscard]] const ShowHeader& header() const noexcept { return header_; }
+    [[nodiscard]] const std::vector<ShowTrack>& tracks() const noexcept { return tracks_; }
+    [[nodiscard]] const uint8_t* trackData(size_t t) const noexcept { return frames_[t].data(); }
+    [[nodiscard]] uint32_t frameIndex() const noexcept { return frame_index_; }  // Frames decoded since rewind
+
+private:
+    ShowChunkReader reader_;
+    ShowHeader header_;
+    std::vector<ShowTrack> tracks_;
+    std::vector<std::vector<uint8_t>> frames_;  // Current frame per track, the reference for deltas
+    uint32_t frame_index_ = 0;
+};
@@ -0,0 +1,391 @@
+/* Multi-controller frame synchronization over UDP
+ * One controller leads: it broadcasts a beacon with its frame counter and how far into
+ * that frame it is, a few times per second. Followers turn each beacon into the local
+ * time the leader's frame started and run their frame clock through a PLL against it:
+ * the frame counter (and with it the effect time base) is taken over once, after that
+ * phase and rate are slewed. Portable: BSD sockets work on lwIP and on a host, where
+ * tools/pixsync.cpp runs several nodes over loopback.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+inline constexpr char SYNC_MAGIC[4] = {'P', 'X', 'S', 'Y'};
+inline constexpr uint8_t SYNC_VERSION = 1;
+inline constexpr size_t SYNC_BEACON_BYTES = 28;
+inline constexpr uint16_t SYNC_DEFAULT_PORT = 5569;
+
+// Beacon layout, little-endian:
+//   magic[4] version:u8 reserved:u8 group:u16 rate_hz:u16 reserved:u16
+//   leader_id:u32 sequence:u32 frame:u32 phase_us:u32
+struct SyncBeacon {
+    uint16_t group = 0;       // Followers only listen to their own group
+    uint16_t rate_hz = 0;     // Leader frame rate; followers at another rate ignore it
+    uint32_t leader_id = 0;
+    uint32_t sequence = 0;
+    uint32_t frame = 0;       // Leader frame counter
+    uint32_t phase_us = 0;    // Time from the start of that frame to sending the beacon
+};
+
+namespace sync_detail {
+inline void put16(uint8_t* p, uint16_t v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); }
+inline void put32(uint8_t* p, uint32_t v) { put16(p, uint16_t(v)); put16(p + 2, uint16_t(v >> 16)); }
+inline uint16_t get16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+inline uint32_t get32(const uint8_t* p) { return get16(p) | (uint32_t(get16(p + 2)) << 16); }
+} // namespace sync_detail
+
+inline void encodeSyncBeacon(const SyncBeacon& beacon, uint8_t* out) {
+    using namespace sync_detail;
+    std::memcpy(out, SYNC_MAGIC, 4);
+    out[4] = SYNC_VERSION;
+    out[5] = 0;
+    put16(out + 6, beacon.group);
+    put16(out + 8, beacon.rate_hz);
+    put16(out + 10, 0);
+    put32(out + 12, beacon.leader_id);
+    put32(out + 16, beacon.sequence);
+    put32(out + 20, beacon.frame);
+    put32(out + 24, beacon.phase_us);
+}
+
+[[nodiscard]] inline bool decodeSyncBeacon(const uint8_t* data, size_t len, SyncBeacon& beacon) {
+    using namespace sync_detail;
+    if (len < SYNC_BEACON_BYTES || std::memcmp(data, SYNC_MAGIC, 4) != 0 || data[4] != SYNC_VERSION) {
+        return false;
+    }
+    beacon.group = get16(data + 6);
+    beacon.rate_hz = get16(data + 8);
+    beacon.leader_id = get32(data + 12);
+    beacon.sequence = get32(data + 16);
+    beacon.frame = get32(data + 20);
+    beacon.phase_us = get32(data + 24);
+    return true;
+}
+
+enum class SyncRole : uint8_t {
+    Leader,
+    Follower,
+};
+
+struct SyncConfig {
+    SyncRole role = SyncRole::Follower;
+    uint16_t group = 0;
+    uint16_t port = SYNC_DEFAULT_PORT;
+    std::string address = "255.255.255.255";  // Broadcast, multicast group or a single follower
+    uint32_t node_id = 0;                     // Leader id in beacons, 0 picks one
+    uint16_t beacon_interval_ms = 100;
+    uint32_t latency_us = 0;                  // Typical one-way network delay, subtracted
+    uint32_t step_threshold_us = 50000;       // Larger phase errors step the clock instead of slewing
+};
+
+// Achieved synchronization, as seen by a follower at each beacon
+struct SyncStats {
+    bool locked = false;
+    int32_t error_us = 0;            // Phase error at the last beacon, positive when running late
+    uint32_t mean_abs_error_us = 0;  // Running average of |error_us|
+    uint32_t max_abs_error_us = 0;   // Since the clock last stepped
+    int32_t rate_ppm = 0;            // Learned rate correction against the nominal frame rate
+    uint32_t beacons = 0;            // Beacons received (followers) or sent (leader)
+    uint32_t lost = 0;               // Gaps in the leader's sequence numbers
+    uint32_t steps = 0;              // Times the clock was stepped to the leader
+    uint32_t rejected = 0;           // Beacons of another group or frame rate
+    uint32_t spikes = 0;             // Single beacons far off the average, not used
+};
+
+// The driver's frame clock: frame n starts at frameStartUs(). Followers discipline it
+// with a type-2 PLL, a phase term that removes part of each error right away and a
+// frequency term that learns the rate offset between the two crystals.
+class FrameClock {
+public:
+    static constexpr double PHASE_GAIN = 0.5;     // Share of the phase error removed per beacon
+    static constexpr double FREQ_GAIN = 0.1;      // Share fed into the rate correction
+    static constexpr double MAX_RATE_PPM = 2000;  // Crystals are within ~100 ppm; the rest is noise
+
+    void start(int64_t now_us, uint32_t rate_hz) noexcept {
+        nominal_us_ = 1e6 / std::max<uint32_t>(rate_hz, 1);
+        period_us_ = nominal_us_;
+        start_us_ = static_cast<double>(now_us);
+        frame_ = 0;
+        locked_ = false;
+    }
+
+    [[nodiscard]] uint32_t frame() const noexcept { return frame_; }
+    [[nodiscard]] int64_t frameStartUs() const noexcept { return std::llround(start_us_); }
+    [[nodiscard]] double periodUs() const noexcept { return period_us_; }
+    [[nodiscard]] bool locked() const noexcept { return locked_; }
+    [[nodiscard]] int32_t ratePpm() const noexcept {
+        return static_cast<int32_t>(std::lround((period_us_ / nominal_us_ - 1.0) * 1e6));
+    }
+
+    // Move to the next frame. Slots that have already passed entirely are skipped, so a
+    // stalled or stepped clock does not burst frames to catch up.
+    void advance(int64_t now_us) noexcept {
+        do {
+            ++frame_;
+            start_us_ += period_us_;
+        } while (start_us_ + period_us_ <= static_cast<double>(now_us));
+    }
+
+    // Where this clock is against the leader's frame leader_frame, which started at local
+    // time leader_start_us; positive when running late
+    [[nodiscard]] double phaseError(uint32_t leader_frame, double leader_start_us) const noexcept {
+        const auto frames_ahead = static_cast<int32_t>(leader_frame - frame_);
+        return start_us_ + frames_ahead * period_us_ - leader_start_us;
+    }
+
+    // Correct towards the leader; returns the phase error before correction
+    double discipline(uint32_t leader_frame, double leader_start_us, uint32_t step_threshold_us) noexcept {
+        const double error = phaseError(leader_frame, leader_start_us);
+
+        if (!locked_ || std::fabs(error) > step_threshold_us) {
+            // Take over the leader's frame counter and phase; advance() catches up to now
+            frame_ = leader_frame;
+            start_us_ = leader_start_us;
+            last_frame_ = leader_frame;
+            locked_ = true;
+            stepped_ = true;
+            return error;
+        }
+
+        const double frames = std::max<double>(static_cast<int32_t>(frame_ - last_frame_), 1.0);
+        const double max_offset = nominal_us_ * MAX_RATE_PPM * 1e-6;
+        period_us_ = std::clamp(period_us_ - FREQ_GAIN * error / frames,
+                                nominal_us_ - max_offset, nominal_us_ + max_offset);
+        start_us_ -= PHASE_GAIN * error;
+        last_frame_ = frame_;
+        stepped_ = false;
+        return error;
+    }
+
+    [[nodiscard]] bool lastWasStep() const noexcept { return stepped_; }
+
+    void unlock() noexcept {
+        locked_ = false;
+        period_us_ = nominal_us_;
+    }
+
+private:
+    double nominal_us_ = 1e6 / 60;
+    double period_us_ = 1e6 / 60;
+    double start_us_ = 0;
+    uint32_t frame_ = 0;
+    uint32_t last_frame_ = 0;
+    bool locked_ = false;
+    bool stepped_ = false;
+};
+
+// One controller's end of the sync protocol. The frame loop calls onFrame() between
+// frames: the leader sends a beacon when one is due, a follower applies the newest beacon
+// to its clock. Followers need a second thread blocked in receive(), so that beacons are
+// timestamped on arrival rather than at the next frame.
+class SyncNode {
+public:
+    using ClockFn = std::function<int64_t()>;  // Microseconds, monotonic
+
+    explicit SyncNode(ClockFn clock) : clock_(std::move(clock)) {}
+    ~SyncNode() { close(); }
+
+    SyncNode(const SyncNode&) = delete;
+    SyncNode& operator=(const SyncNode&) = delete;
+
+    bool open(const SyncConfig& config, uint16_t rate_hz) {
+        close();
+        config_ = config;
+        rate_hz_ = rate_hz;
+
+        socket_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (socket_ < 0) return false;
+
+        dest_ = {};
+        dest_.sin_family = AF_INET;
+        dest_.sin_port = htons(config.port);
+        if (inet_pton(AF_INET, config.address.c_str(), &dest_.sin_addr) != 1) {
+            close();
+            return false;
+        }
+        const bool multicast = (ntohl(dest_.sin_addr.s_addr) >> 28) == 0xE;
+        const int on = 1;
+
+        if (config.role == SyncRole::Leader) {
+            setsockopt(socket_, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on));
+            if (multicast) {
+                const uint8_t loop = 1;  // Followers on the same host
+                setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+            }
+            next_beacon_us_ = clock_();
+            return true;
+        }
+
+        // Several followers on one host share the port
+        setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in local = {};
+        local.sin_family = AF_INET;
+        local.sin_port = htons(config.port);
+        local.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (::bind(socket_, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            close();
+            return false;
+        }
+        if (multicast) {
+            ip_mreq group = {};
+            group.imr_multiaddr = dest_.sin_addr;
+            group.imr_interface.s_addr = htonl(INADDR_ANY);
+            if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &group, sizeof(group)) != 0) {
+                close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void close() {
+        if (socket_ >= 0) {
+            ::close(socket_);
+            socket_ = -1;
+        }
+    }
+
+    [[nodiscard]] bool isOpen() const noexcept { return socket_ >= 0; }
+    [[nodiscard]] const SyncConfig& config() const noexcept { return config_; }
+
+    // A beacon this far off the running average is held back unless the next agrees
+    static constexpr uint32_t SPIKE_FACTOR = 4;
+    static constexpr uint32_t SPIKE_FLOOR_US = 500;
+
+    // Frame loop, between frames
+    void onFrame(FrameClock& clock) {
+        if (socket_ < 0) return;
+        if (config_.role == SyncRole::Leader) {
+            sendBeacon(clock);
+        } else {
+            applyBeacon(clock);
+        }
+    }
+
+    // Follower receive thread: waits up to timeout_ms for a beacon; false on timeout or error
+    bool receive(uint32_t timeout_ms) {
+        if (socket_ < 0) return false;
+        timeval timeout = {};
+        timeout.tv_sec = timeout_ms / 1000;
+        timeout.tv_usec = (timeout_ms % 1000) * 1000;
+        setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        uint8_t packet[64];
+        const ssize_t len = ::recv(socket_, packet, sizeof(packet), 0);
+        const int64_t rx_us = clock_();
+        SyncBeacon beacon;
+        if (len <= 0 || !decodeSyncBeacon(packet, static_cast<size_t>(len), beacon)) return false;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (beacon.group != config_.group || beacon.rate_hz != rate_hz_) {
+            ++stats_.rejected;
+            return false;
+        }
+        pending_ = beacon;
+        pending_start_us_ = static_cast<double>(rx_us) - beacon.phase_us - config_.latency_us;
+        has_pending_ = true;
+        return true;
+    }
+
+    [[nodiscard]] SyncStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    void sendBeacon(const FrameClock& clock) {
+        const int64_t now = clock_();
+        if (now < next_beacon_us_) return;
+        next_beacon_us_ = now + int64_t(config_.beacon_interval_ms) * 1000;
+
+        SyncBeacon beacon;
+        beacon.group = config_.group;
+        beacon.rate_hz = rate_hz_;
+        beacon.leader_id = config_.node_id;
+        beacon.sequence = sequence_++;
+        beacon.frame = clock.frame();
+        beacon.phase_us = static_cast<uint32_t>(std::max<int64_t>(now - clock.frameStartUs(), 0));
+
+        uint8_t packet[SYNC_BEACON_BYTES];
+        encodeSyncBeacon(beacon, packet);
+        if (::sendto(socket_, packet, sizeof(packet), 0, reinterpret_cast<const sockaddr*>(&dest_),
+                     sizeof(dest_)) == static_cast<ssize_t>(sizeof(packet))) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.beacons;
+        }
+    }
+
+    void applyBeacon(FrameClock& clock) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!has_pending_) return;
+        has_pending_ = false;
+
+        // A new leader (failover, restart) is taken over from scratch
+        if (stats_.beacons > 0 && pending_.leader_id != leader_id_) {
+            clock.unlock();
+        } else if (stats_.beacons > 0 && pending_.sequence - last_sequence_ > 1) {
+            stats_.lost += pending_.sequence - last_sequence_ - 1;
+        }
+        leader_id_ = pending_.leader_id;
+        last_sequence_ = pending_.sequence;
+        ++stats_.beacons;
+
+        // Popcorn spike: a send or receive delayed by the scheduler puts one beacon far
+        // off. A second one in a row means the leader really moved.
+        if (clock.locked()) {
+            const double limit = std::max(SPIKE_FACTOR * stats_.mean_abs_error_us, SPIKE_FLOOR_US);
+            const bool spike = std::fabs(clock.phaseError(pending_.frame, pending_start_us_)) > limit;
+            if (spike && !last_was_spike_) {
+                last_was_spike_ = true;
+                ++stats_.spikes;
+                return;
+            }
+            last_was_spike_ = false;
+        }
+
+        const double error = clock.discipline(pending_.frame, pending_start_us_, config_.step_threshold_us);
+        if (clock.lastWasStep()) {
+            ++stats_.steps;
+            stats_.max_abs_error_us = 0;
+            stats_.mean_abs_error_us = 0;
+        } else {
+            const auto abs_error = static_cast<uint32_t>(std::min(std::fabs(error), 1e9));
+            stats_.max_abs_error_us = std::max(stats_.max_abs_error_us, abs_error);
+            stats_.mean_abs_error_us = (stats_.mean_abs_error_us * 7 + abs_error) / 8;
+        }
+        stats_.error_us = static_cast<int32_t>(std::clamp(error, -1e9, 1e9));
+        stats_.locked = clock.locked();
+        stats_.rate_ppm = clock.ratePpm();
+    }
+
+    ClockFn clock_;
+    SyncConfig config_;
+    uint16_t rate_hz_ = 0;
+    int socket_ = -1;
+    sockaddr_in dest_ = {};
+
+    // Leader
+    int64_t next_beacon_us_ = 0;
+    uint32_t sequence_ = 0;
+
+    // Follower: newest beacon, handed from the receive thread to the frame loop
+    mutable std::mutex mutex_;
+    SyncBeacon pending_;
+    double pending_start_us_ = 0;
+    bool has_pending_ = false;
+    uint32_t leader_id_ = 0;
+    uint32_t last_sequence_ = 0;
+    bool last_was_spike_ = false;
+    SyncStats stats_;
+};
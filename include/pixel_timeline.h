@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "pixel_core.h"
+
+// Keyframed parameter timeline for one channel. Each parameter is a track of keys
+// (time, value, easing); the driver evaluates every track once per frame. Evaluation
+// keeps a cursor per track and steps it forward, so a frame costs O(1) per track and
+// never allocates. Between two keys the value follows the easing of the later key,
+// in 16.16 fixed point. Before a track's first key and after its last, the nearest
+// key's value holds.
+
+enum class TimelineParam : uint8_t {
+    Brightness,
+    Speed,
+    Color,
+};
+
+enum class TimelineEasing : uint8_t {
+    Step,       // Jump to the key's value when its time is reached
+    Linear,
+    EaseIn,     // Quadratic
+    EaseOut,
+    EaseInOut,  // Smoothstep
+};
+
+struct TimelineKey {
+    uint32_t time_ms = 0;
+    TimelineParam param = TimelineParam::Brightness;
+    TimelineEasing easing = TimelineEasing::Linear;  // Shape of the segment that ends at this key
+    PixelColor value;  // Color, or the level in r for brightness and speed
+
+    static constexpr TimelineKey level(uint32_t time_ms, TimelineParam param, uint8_t level,
+                                       TimelineEasing easing = TimelineEasing::Linear) noexcept {
+        return TimelineKey{time_ms, param, easing, PixelColor(level, 0, 0)};
+    }
+    static constexpr TimelineKey color(uint32_t time_ms, const PixelColor& color,
+                                       TimelineEasing easing = TimelineEasing::Linear) noexcept {
+        return TimelineKey{time_ms, TimelineParam::Color, easing, color};
+    }
+};
+
+[[nodiscard]] inline std::optional<TimelineParam> timelineParamFromName(std::string_view name) noexcept {
+    if (name == "brightness") return TimelineParam::Brightness;
+    if (name == "speed") return TimelineParam::Speed;
+    if (name == "color") return TimelineParam::Color;
+    return std::nullopt;
+}
+
+[[nodiscard]] inline std::optional<TimelineEasing> timelineEasingFromName(std::string_view name) noexcept {
+    if (name == "step") return TimelineEasing::Step;
+    if (name == "linear") return TimelineEasing::Linear;
+    if (name == "ease_in") return TimelineEasing::EaseIn;
+    if (name == "ease_out") return TimelineEasing::EaseOut;
+    if (name == "ease_in_out") return TimelineEasing::EaseInOut;
+    return std::nullopt;
+}
+
+class PixelTimeline {
+public:
+    static constexpr size_t PARAM_COUNT = 3;
+    static constexpr size_t MAX_KEYS = 1024;
+
+    // Take a set of keys in any order. duration_ms = 0 ends the timeline at its last key;
+    // a looping timeline restarts from 0 at its duration. False for no keys, more than
+    // MAX_KEYS, an unknown parameter or a duration shorter than the last key.
+    bool load(std::vector<TimelineKey> keys, uint32_t duration_ms = 0, bool loop = false) {
+        if (keys.empty() || keys.size() > MAX_KEYS) return false;
+        uint32_t last_ms = 0;
+        for (const auto& key : keys) {
+            if (static_cast<size_t>(key.param) >= PARAM_COUNT) return false;
+            last_ms = std::max(last_ms, key.time_ms);
+        }
+        if (duration_ms == 0) duration_ms = last_ms;
+        if (duration_ms < last_ms) return false;
+
+        std::stable_sort(keys.begin(), keys.end(), [](const TimelineKey& a, const TimelineKey& b) {
+            return a.param != b.param ? a.param < b.param : a.time_ms < b.time_ms;
+        });
+        keys_ = std::move(keys);
+        keys_.shrink_to_fit();
+        duration_ms_ = duration_ms;
+        loop_ = loop;
+
+        tracks_ = {};
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            Track& track = tracks_[static_cast<size_t>(keys_[i].param)];
+            if (track.begin == track.end) {
+                track.begin = static_cast<uint16_t>(i);
+                track.cursor = track.begin;
+            }
+            track.end = static_cast<uint16_t>(i + 1);
+        }
+        return true;
+    }
+
+    void clear() noexcept {
+        keys_.clear();
+        tracks_ = {};
+        duration_ms_ = 0;
+        loop_ = false;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return keys_.empty(); }
+    [[nodiscard]] size_t size() const noexcept { return keys_.size(); }
+    [[nodiscard]] uint32_t durationMs() const noexcept { return duration_ms_; }
+    [[nodiscard]] bool loops() const noexcept { return loop_; }
+    [[nodiscard]] bool hasTrack(TimelineParam param) const noexcept {
+        const Track& track = tracks_[static_cast<size_t>(param)];
+        return track.begin != track.end;
+    }
+    // A one-shot timeline past its end keeps holding its final values
+    [[nodiscard]] bool finished(uint32_t time_ms) const noexcept { return !loop_ && time_ms >= duration_ms_; }
+
+    // Position within the timeline for a time since its start
+    [[nodiscard]] uint32_t position(uint32_t time_ms) const noexcept {
+        if (!loop_) return std::min(time_ms, duration_ms_);
+        return duration_ms_ ? time_ms % duration_ms_ : 0;
+    }
+
+    // Evaluate every track at a time since the start. Cheapest when successive calls move
+    // forward; moving back (a loop restart) rescans the track from its first key.
+    void evaluate(uint32_t time_ms) noexcept {
+        const uint32_t t = position(time_ms);
+        for (Track& track : tracks_) {
+            if (track.begin == track.end) continue;
+            if (t < keys_[track.cursor].time_ms) track.cursor = track.begin;
+            while (track.cursor + 1 < track.end && keys_[track.cursor + 1].time_ms <= t) {
+                ++track.cursor;
+            }
+
+            const TimelineKey& from = keys_[track.cursor];
+            if (t < from.time_ms || track.cursor + 1 == track.end) {
+                track.value = from.value;
+                continue;
+            }
+            const TimelineKey& to = keys_[track.cursor + 1];
+            const uint32_t progress = static_cast<uint32_t>(
+                (static_cast<uint64_t>(t - from.time_ms) << 16) / (to.time_ms - from.time_ms));
+            track.value = lerpColor(from.value, to.value, ease(to.easing, progress));
+        }
+    }
+
+    // Value of a track as of the last evaluate()
+    [[nodiscard]] const PixelColor& value(TimelineParam param) const noexcept {
+        return tracks_[static_cast<size_t>(param)].value;
+    }
+
+    // Easing curves on a 16.16 progress in [0, 65536)
+    [[nodiscard]] static constexpr uint32_t ease(TimelineEasing easing, uint32_t p) noexcept {
+        constexpr uint64_t ONE = 65536;
+        switch (easing) {
+            case TimelineEasing::Step:
+                return 0;
+            case TimelineEasing::EaseIn:
+                return static_cast<uint32_t>((uint64_t(p) * p) >> 16);
+            case TimelineEasing::EaseOut:
+                return static_cast<uint32_t>(ONE - (((ONE - p) * (ONE - p)) >> 16));
+            case TimelineEasing::EaseInOut:
+                return static_cast<uint32_t>((uint64_t(p) * p * (3 * ONE - 2 * p)) >> 32);
+            case TimelineEasing::Linear:
+            default:
+                return p;
+        }
+    }
+
+private:
+    struct Track {
+        uint16_t begin = 0;
+        uint16_t end = 0;
+        uint16_t cursor = 0;
+        PixelColor value;
+    };
+
+    [[nodiscard]] static constexpr uint8_t lerpLane(uint8_t a, uint8_t b, uint32_t weight) noexcept {
+        return static_cast<uint8_t>(a + ((static_cast<int32_t>(b - a) * static_cast<int32_t>(weight) + 0x8000) >> 16));
+    }
+    [[nodiscard]] static constexpr PixelColor lerpColor(const PixelColor& a, const PixelColor& b,
+                                                        uint32_t weight) noexcept {
+        return PixelColor(lerpLane(a.r, b.r, weight), lerpLane(a.g, b.g, weight),
+                          lerpLane(a.b, b.b, weight), lerpLane(a.w, b.w, weight));
+    }
+
+    std::vector<TimelineKey> keys_;  // Grouped by parameter, then in time order
+    std::array<Track, PARAM_COUNT> tracks_{};
+    uint32_t duration_ms_ = 0;
+    bool loop_ = false;
+};
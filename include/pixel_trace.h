@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Frame pipeline tracing: begin/end events around render, limit, encode and each
+// channel's DMA, plus API handler spans, written to a lock-free ring and dumped as Chrome
+// trace JSON (chrome://tracing, ui.perfetto.dev). Compiled in only with PIXDRIVER_TRACE;
+// without it the PIXTRACE_* macros expand to nothing. Off the ESP32 the clock falls back to
+// std::chrono and the ring is plain std::atomic, so tools/pixtrace.cpp writes the same JSON.
+
+enum class TraceLane : uint8_t {
+    Driver,    // driverTask: frame, render, limit, encode
+    Transmit,  // Transmit service task: DMA kicks and frame completion
+    Api,       // HTTP handlers and NVS
+    Dma,       // One row per channel while its frame is on the wire
+};
+
+enum class TracePhase : uint8_t {
+    Begin,
+    End,
+    Instant,
+};
+
+struct TraceEvent {
+    uint32_t ts_us = 0;
+    const char* name = nullptr;  // A string literal
+    TracePhase phase = TracePhase::Instant;
+    TraceLane lane = TraceLane::Driver;
+    uint8_t channel = NO_CHANNEL;
+
+    static constexpr uint8_t NO_CHANNEL = UINT8_MAX;
+};
+
+// Multi-producer ring of the newest N events. Writers claim a slot with one atomic add
+// and publish it with a per-slot sequence number, so recording never blocks and can run
+// on both cores at once. A reader skips slots that are being rewritten under it.
+template <size_t N>
+class TraceRing {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Trace ring size must be a power of two");
+
+public:
+    void record(uint32_t ts_us, const char* name, TracePhase phase, TraceLane lane,
+                int32_t channel = -1) noexcept {
+        const uint32_t meta = static_cast<uint32_t>(phase) | (static_cast<uint32_t>(lane) << 4) |
+                              (static_cast<uint32_t>(channel < 0 ? TraceEvent::NO_CHANNEL : channel & 0xFF) << 8);
+        const uint32_t index = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[index & (N - 1)];
+        slot.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.ts.store(ts_us, std::memory_order_relaxed);
+        slot.name.store(reinterpret_cast<uintptr_t>(name), std::memory_order_relaxed);
+        slot.meta.store(meta, std::memory_order_relaxed);
+        slot.seq.store(index + 1, std::memory_order_release);
+    }
+
+    // Calls fn(const TraceEvent&) for the retained events, oldest first; returns how many
+    template <typename Fn>
+    size_t forEach(Fn&& fn) const {
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        const uint32_t first = head > N ? head - static_cast<uint32_t>(N) : 0;
+        size_t visited = 0;
+        for (uint32_t i = first; i != head; ++i) {
+            const Slot& slot = slots_[i & (N - 1)];
+            const uint32_t seq = slot.seq.load(std::memory_order_acquire);
+            TraceEvent event;
+            event.ts_us = slot.ts.load(std::memory_order_relaxed);
+            event.name = reinterpret_cast<const char*>(slot.name.load(std::memory_order_relaxed));
+            const uint32_t meta = slot.meta.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq != i + 1 || slot.seq.load(std::memory_order_relaxed) != seq || !event.name) continue;
+
+            event.phase = static_cast<TracePhase>(meta & 0x0F);
+            event.lane = static_cast<TraceLane>((meta >> 4) & 0x0F);
+            event.channel = static_cast<uint8_t>(meta >> 8);
+            fn(static_cast<const TraceEvent&>(event));
+            ++visited;
+        }
+        return visited;
+    }
+
+    [[nodiscard]] uint32_t recorded() const noexcept { return head_.load(std::memory_order_relaxed); }
+    [[nodiscard]] static constexpr size_t capacity() noexcept { return N; }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq{0};  // Event index + 1 once published, 0 while written
+        std::atomic<uint32_t> ts{0};
+        std::atomic<uintptr_t> name{0};
+        std::atomic<uint32_t> meta{0};
+    };
+
+    std::array<Slot, N> slots_{};
+    std::atomic<uint32_t> head_{0};
+};
+
+// Chrome trace thread id for an event: one row per lane, and one per channel for DMA
+[[nodiscard]] constexpr uint32_t traceThreadId(TraceLane lane, uint8_t channel) noexcept {
+    return lane == TraceLane::Dma ? 100u + channel : static_cast<uint32_t>(lane) + 1;
+}
+
+[[nodiscard]] constexpr const char* traceLaneName(TraceLane lane) noexcept {
+    switch (lane) {
+        case TraceLane::Driver:   return "driver";
+        case TraceLane::Transmit: return "transmit";
+        case TraceLane::Api:      return "api";
+        case TraceLane::Dma:      return "dma";
+    }
+    return "unknown";
+}
+
+// Writes the ring as Chrome trace JSON through write(const char* data, size_t length), in
+// pieces of at most a couple of hundred bytes. Timestamps are microseconds of the
+// recording clock, unwrapped from 32 bits. Returns the number of events written.
+template <size_t N, typename Write>
+size_t writeChromeTrace(const TraceRing<N>& ring, Write&& write) {
+    char line[192];
+    const auto emit = [&](int length) {
+        if (length > 0) write(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+    };
+
+    emit(std::snprintf(line, sizeof(line),
+                       "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                       "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"pixdriver\"}}"));
+    for (const TraceLane lane : {TraceLane::Driver, TraceLane::Transmit, TraceLane::Api}) {
+        emit(std::snprintf(line, sizeof(line),
+                           ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                           static_cast<unsigned>(traceThreadId(lane, 0)), traceLaneName(lane)));
+    }
+
+    uint64_t dma_channels = 0;
+    bool started = false;
+    uint32_t last_ts = 0;
+    int64_t ts = 0;
+    const size_t count = ring.forEach([&](const TraceEvent& event) {
+        // Events are in claim order, which can be a little out of time order across tasks
+        ts = started ? ts + static_cast<int32_t>(event.ts_us - last_ts) : event.ts_us;
+        last_ts = event.ts_us;
+        started = true;
+
+        const char* phase = event.phase == TracePhase::Begin ? "B" : event.phase == TracePhase::End ? "E" : "i";
+        const uint32_t tid = traceThreadId(event.lane, event.channel);
+        if (event.lane == TraceLane::Dma && event.channel < 64) dma_channels |= uint64_t(1) << event.channel;
+        if (event.channel == TraceEvent::NO_CHANNEL) {
+            emit(std::snprintf(line, sizeof(line),
+                               ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\",\"s\":\"t\",\"ts\":%lld,\"pid\":1,\"tid\":%u}",
+                               event.name, traceLaneName(event.lane), phase, static_cast<long long>(ts),
+                               static_cast<unsigned>(tid)));
+        } else {
+            emit(std::snprintf(line, sizeof(line),
+                               ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\",\"s\":\"t\",\"ts\":%lld,\"pid\":1,"
+                               "\"tid\":%u,\"args\":{\"channel\":%u}}",
+                               event.name, traceLaneName(event.lane), phase, static_cast<long long>(ts),
+                               static_cast<unsigned>(tid), static_cast<unsigned>(event.channel)));
+        }
+    });
+
+    for (uint32_t channel = 0; channel < 64; ++channel) {
+        if (!(dma_channels & (uint64_t(1) << channel))) continue;
+        emit(std::snprintf(line, sizeof(line),
+                           ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"dma %u\"}}",
+                           static_cast<unsigned>(traceThreadId(TraceLane::Dma, static_cast<uint8_t>(channel))),
+                           static_cast<unsigned>(channel)));
+    }
+    emit(std::snprintf(line, sizeof(line), "\n]}\n"));
+    return count;
+}
+
+#ifdef PIXDRIVER_TRACE
+
+#ifndef PIXDRIVER_TRACE_EVENTS
+#define PIXDRIVER_TRACE_EVENTS 1024  // 16 bytes each on the ESP32
+#endif
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+inline uint32_t traceNowUs() noexcept { return static_cast<uint32_t>(esp_timer_get_time()); }
+#else
+#include <chrono>
+inline uint32_t traceNowUs() noexcept {
+    using namespace std::chrono;
+    return static_cast<uint32_t>(duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count());
+}
+#endif
+
+using PixelTraceRing = TraceRing<PIXDRIVER_TRACE_EVENTS>;
+
+// Constant-initialized, so it is usable from the first task that runs
+inline PixelTraceRing pixel_trace_ring;
+inline PixelTraceRing& pixelTrace() noexcept { return pixel_trace_ring; }
+
+// Begin on construction, end on destruction
+class TraceScope {
+public:
+    TraceScope(const char* name, TraceLane lane, int32_t channel = -1) noexcept
+        : name_(name), lane_(lane), channel_(channel) {
+        pixelTrace().record(traceNowUs(), name_, TracePhase::Begin, lane_, channel_);
+    }
+    ~TraceScope() { pixelTrace().record(traceNowUs(), name_, TracePhase::End, lane_, channel_); }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    TraceLane lane_;
+    int32_t channel_;
+};
+
+#define PIXTRACE_CONCAT_(a, b) a##b
+#define PIXTRACE_CONCAT(a, b) PIXTRACE_CONCAT_(a, b)
+#define PIXTRACE_SCOPE(...) TraceScope PIXTRACE_CONCAT(pixtrace_scope_, __LINE__)(__VA_ARGS__)
+#define PIXTRACE_BEGIN(name, ...) pixelTrace().record(traceNowUs(), name, TracePhase::Begin, __VA_ARGS__)
+#define PIXTRACE_END(name, ...) pixelTrace().record(traceNowUs(), name, TracePhase::End, __VA_ARGS__)
+#define PIXTRACE_END_AT(ts_us, name, ...) \
+    pixelTrace().record(static_cast<uint32_t>(ts_us), name, TracePhase::End, __VA_ARGS__)
+#define PIXTRACE_INSTANT(name, ...) pixelTrace().record(traceNowUs(), name, TracePhase::Instant, __VA_ARGS__)
+
+#else
+
+#define PIXTRACE_SCOPE(...) ((void)0)
+#define PIXTRACE_BEGIN(...) ((void)0)
+#define PIXTRACE_END(...) ((void)0)
+#define PIXTRACE_END_AT(...) ((void)0)
+#define PIXTRACE_INSTANT(...) ((void)0)
+
+#endif
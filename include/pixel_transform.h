@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pixel_color16.h"
+
+// Output transforms for strips that are not wired the way effects draw them. A transform
+// compiles to one table, physical pixel -> logical pixel, that the channel's scaling pass
+// reads through while it builds the output frame, so there is no extra buffer pass. An
+// identity transform compiles to an empty table, and the scaling pass runs unchanged.
+
+struct OutputTransform {
+    static constexpr uint16_t NO_PIXEL = UINT16_MAX;  // Index map entry for a dark pixel
+
+    // Applied in this order, each to the logical index the previous step produced
+    std::vector<uint16_t> index_map;  // Physical pixel -> logical pixel, pixel_count entries
+    uint16_t stride = 1;   // Interleaved wiring: 0, s, 2s, ..., then 1, 1 + s, ...
+    uint16_t rotate = 0;   // Physical pixel p shows logical pixel p + rotate (wrapping)
+    bool reverse = false;  // Strip fed from the other end
+    bool mirror = false;   // Second half shows the first half reflected about the center
+
+    [[nodiscard]] bool identity() const noexcept {
+        return index_map.empty() && stride <= 1 && rotate == 0 && !reverse && !mirror;
+    }
+
+    // The physical -> logical table for `count` pixels. Empty for an identity transform
+    // and for an index map whose size does not match.
+    [[nodiscard]] std::vector<uint16_t> compile(size_t count) const {
+        if (identity() || count == 0 || count >= NO_PIXEL) return {};
+        if (!index_map.empty() && index_map.size() != count) return {};
+
+        std::vector<uint16_t> table(count);
+        for (size_t p = 0; p < count; ++p) {
+            table[p] = index_map.empty() ? static_cast<uint16_t>(p)
+                     : (index_map[p] < count ? index_map[p] : NO_PIXEL);
+        }
+
+        std::vector<uint16_t> order;
+        if (stride > 1) {
+            order.reserve(count);
+            for (size_t start = 0; start < stride && start < count; ++start) {
+                for (size_t i = start; i < count; i += stride) order.push_back(static_cast<uint16_t>(i));
+            }
+        }
+        const size_t last = count - 1;
+        for (uint16_t& q : table) {
+            if (q == NO_PIXEL) continue;
+            if (!order.empty()) q = order[q];
+            if (rotate) q = static_cast<uint16_t>((q + rotate) % count);
+            if (reverse) q = static_cast<uint16_t>(last - q);
+            if (mirror) q = static_cast<uint16_t>(std::min<size_t>(q, last - q));
+        }
+        return table;
+    }
+};
+
+// 64-bit FNV-1a of a compiled table, 0 for the empty (identity) one. Taken once at
+// configure time so channels can compare transforms per frame without walking the tables.
+[[nodiscard]] inline uint64_t outputMapHash(const std::vector<uint16_t>& map) noexcept {
+    if (map.empty()) return 0;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const uint16_t q : map) {
+        hash = (hash ^ (q & 0xFF)) * 0x100000001b3ull;
+        hash = (hash ^ (q >> 8)) * 0x100000001b3ull;
+    }
+    return hash | 1;
+}
+
+// out[p] = fn(in[map[p]]), dark where the map says NO_PIXEL
+template <typename In, typename Out, typename Fn>
+inline void gatherSpan(const In* in, const uint16_t* map, Out* out, size_t count, Fn&& fn) noexcept {
+    for (size_t p = 0; p < count; ++p) {
+        const uint16_t q = map[p];
+        out[p] = q == OutputTransform::NO_PIXEL ? Out() : fn(in[q]);
+    }
+}
+
+// upsampleSpan() through a map of full-resolution logical indices: logical pixel q lies
+// between samples q / factor and the next one. Calls emit(p, a, b, inv, w), or dark(p).
+template <typename Emit, typename Dark>
+inline void upsampleGather(const PixelColor* in, size_t in_count, uint8_t factor, const uint16_t* map,
+                           size_t count, Emit&& emit, Dark&& dark) noexcept {
+    if (in_count == 0 || factor == 0) return;
+    const uint32_t step = (256u << 8) / factor;
+    for (size_t p = 0; p < count; ++p) {
+        const uint16_t q = map[p];
+        if (q == OutputTransform::NO_PIXEL) {
+            dark(p);
+            continue;
+        }
+        const size_t j = std::min<size_t>(q / factor, in_count - 1);
+        const uint32_t w = ((q % factor) * step) >> 8;
+        emit(p, in[j], in[j + 1 < in_count ? j + 1 : j], 256 - w, w);
+    }
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+
+// Portable transmit scheduling shared by the ESP32 transmit service task.
+// No FreeRTOS or driver dependencies so the bookkeeping can be exercised on a host.
+
+// Inter-channel DMA start skew, measured once per synchronized frame start
+struct StartSkewStats {
+    uint32_t last_skew_us = 0;   // Skew of the most recent frame
+    uint32_t max_skew_us = 0;    // Worst skew seen since reset
+    uint32_t frames = 0;         // Frames started with two or more channels
+    uint32_t over_budget = 0;    // Frames whose skew exceeded the configured bound
+
+    void record(uint32_t skew_us, uint32_t bound_us) noexcept {
+        last_skew_us = skew_us;
+        if (skew_us > max_skew_us) max_skew_us = skew_us;
+        ++frames;
+        if (skew_us > bound_us) ++over_budget;
+    }
+};
+
+// What a channel does when its frames keep getting corrupted on the wire
+struct UnderrunPolicy {
+    bool resend_on_error = true;   // Resend the intact encoded frame once after a bad one
+    uint8_t degrade_after = 3;     // Consecutive bad frames before halving the channel's rate
+    uint8_t max_divider = 8;       // Lowest rate is update_rate / max_divider, 1-128
+    uint16_t recover_after = 300;  // Clean frames before doubling the rate again
+};
+
+// Per-channel transmit counters
+struct TransmitStats {
+    uint32_t frames = 0;          // Frame attempts that finished, including resends
+    uint32_t underruns = 0;       // DMA ran out of queued data mid-frame
+    uint32_t overflows = 0;       // Driver send queue overflowed mid-frame
+    uint32_t timeouts = 0;        // Frame did not finish before its deadline
+    uint32_t retransmits = 0;     // Automatic resends of a corrupted frame
+    uint8_t frame_divider = 1;    // Channel transmits every Nth driver frame
+};
+
+// Turns per-frame error events into counters, resend decisions and rate degradation
+class TransmitHealth {
+public:
+    static constexpr uint8_t EVENT_UNDERRUN = 1u << 0;
+    static constexpr uint8_t EVENT_OVERFLOW = 1u << 1;
+    static constexpr uint8_t EVENT_TIMEOUT = 1u << 2;
+
+    // Record the outcome of one frame attempt; returns true if it should be resent
+    bool record(uint8_t events, bool is_resend, const UnderrunPolicy& policy) noexcept {
+        ++stats_.frames;
+        if (events & EVENT_UNDERRUN) ++stats_.underruns;
+        if (events & EVENT_OVERFLOW) ++stats_.overflows;
+        if (events & EVENT_TIMEOUT) ++stats_.timeouts;
+
+        if (events == 0) {
+            consecutive_errors_ = 0;
+            if (stats_.frame_divider > 1 && ++clean_frames_ >= policy.recover_after) {
+                stats_.frame_divider /= 2;
+                clean_frames_ = 0;
+            }
+            return false;
+        }
+
+        clean_frames_ = 0;
+        if (++consecutive_errors_ >= policy.degrade_after) {
+            consecutive_errors_ = 0;
+            // Clamped to max_divider (at most 128 so the uint8_t divider cannot wrap to 0)
+            const uint16_t doubled = static_cast<uint16_t>(stats_.frame_divider) * 2;
+            stats_.frame_divider = static_cast<uint8_t>(
+                std::clamp<uint16_t>(doubled, 1, std::clamp<uint8_t>(policy.max_divider, 1, 128)));
+        }
+
+        if (policy.resend_on_error && !is_resend) {
+            ++stats_.retransmits;
+            return true;
+        }
+        return false;
+    }
+
+    // Whether the channel takes part in the given driver frame under its current divider
+    [[nodiscard]] bool shouldTransmit(uint32_t frame) const noexcept {
+        return (frame % stats_.frame_divider) == 0;
+    }
+
+    [[nodiscard]] const TransmitStats& stats() const noexcept { return stats_; }
+
+    void reset() noexcept {
+        stats_ = TransmitStats{};
+        consecutive_errors_ = 0;
+        clean_frames_ = 0;
+    }
+
+private:
+    TransmitStats stats_;
+    uint8_t consecutive_errors_ = 0;
+    uint16_t clean_frames_ = 0;
+};
+
+// Tracks which channel slots are queued for transmission and which are on the wire.
+// Slots map 1:1 to bits in a FreeRTOS task notification value, so the service task
+// can learn about both new frames and DMA progress from a single notification.
+//
+// Lifecycle of a slot for one frame:
+//   submit()        - producer (driver task) has encoded a frame and wants it sent
+//   takeSubmitted() - service task claims all queued slots and starts their DMA
+//   complete()      - service task saw the last byte go out; slot may be submitted again
+class TransmitScheduler {
+public:
+    // Bit 31 of the notification value is the "frames submitted" kick; 0..30 are slots
+    static constexpr uint32_t KICK_BIT = 1u << 31;
+    static constexpr uint32_t SLOT_MASK = ~KICK_BIT;
+    static constexpr int32_t MAX_SLOTS = 31;
+
+    // Reserve a free slot, returns -1 when all are in use
+    int32_t acquireSlot() noexcept {
+        uint32_t allocated = allocated_.load(std::memory_order_relaxed);
+        for (;;) {
+            const uint32_t free_mask = ~allocated & SLOT_MASK;
+            if (free_mask == 0) return -1;
+            const int32_t slot = lowestSlot(free_mask);
+            if (allocated_.compare_exchange_weak(allocated, allocated | bit(slot),
+                                                 std::memory_order_acq_rel)) {
+                return slot;
+            }
+        }
+    }
+
+    void releaseSlot(int32_t slot) noexcept {
+        if (!valid(slot)) return;
+        const uint32_t mask = ~bit(slot);
+        pending_.fetch_and(mask, std::memory_order_acq_rel);
+        in_flight_.fetch_and(mask, std::memory_order_acq_rel);
+        allocated_.fetch_and(mask, std::memory_order_acq_rel);
+    }
+
+    // Queue a slot for the next kick. Fails if the slot is unallocated or its
+    // previous frame has not finished, in which case the caller must not touch
+    // the slot's encode buffer.
+    bool submit(int32_t slot) noexcept {
+        if (!valid(slot) || !(allocated_.load(std::memory_order_acquire) & bit(slot))) {
+            return false;
+        }
+        if (isBusy(slot)) return false;
+        pending_.fetch_or(bit(slot), std::memory_order_acq_rel);
+        return true;
+    }
+
+    // Claim every queued slot and mark it in flight. Returns the claimed mask.
+    uint32_t takeSubmitted() noexcept {
+        const uint32_t taken = pending_.exchange(0, std::memory_order_acq_rel);
+        in_flight_.fetch_or(taken, std::memory_order_acq_rel);
+        return taken;
+    }
+
+    void complete(int32_t slot) noexcept {
+        if (!valid(slot)) return;
+        in_flight_.fetch_and(~bit(slot), std::memory_order_acq_rel);
+    }
+
+    [[nodiscard]] bool isBusy(int32_t slot) const noexcept {
+        if (!valid(slot)) return false;
+        return ((pending_.load(std::memory_order_acquire) |
+                 in_flight_.load(std::memory_order_acquire)) & bit(slot)) != 0;
+    }
+
+    [[nodiscard]] uint32_t inFlight() const noexcept {
+        return in_flight_.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool idle() const noexcept {
+        return (pending_.load(std::memory_order_acquire) |
+                in_flight_.load(std::memory_order_acquire)) == 0;
+    }
+
+    [[nodiscard]] static constexpr uint32_t bit(int32_t slot) noexcept {
+        return 1u << static_cast<uint32_t>(slot);
+    }
+
+    [[nodiscard]] static constexpr bool valid(int32_t slot) noexcept {
+        return slot >= 0 && slot < MAX_SLOTS;
+    }
+
+    // Index of the lowest set bit; mask must be non-zero
+    [[nodiscard]] static int32_t lowestSlot(uint32_t mask) noexcept {
+        return static_cast<int32_t>(__builtin_ctz(mask));
+    }
+
+private:
+    std::atomic<uint32_t> allocated_{0};
+    std::atomic<uint32_t> pending_{0};
+    std::atomic<uint32_t> in_flight_{0};
+};
+
+// Describes a frame once every channel in it has been latched by the LEDs
+struct FrameInfo {
+    uint32_t frame_number = 0;   // Increments once per synchronized frame start
+    int64_t latch_time_us = 0;   // Time the last channel finished its reset period
+    uint32_t start_skew_us = 0;  // Inter-channel start skew of this frame
+};
+
+// Follows the slots of the frames in flight and reports when a frame is fully latched.
+// A frame started while slots of the previous one are still on the wire absorbs them,
+// so a slow channel delays the next presentation instead of producing a stale one.
+class FramePresentTracker {
+public:
+    // Record a frame start for the given slots; returns the new frame number
+    uint32_t begin(uint32_t slots, uint32_t start_skew_us) noexcept {
+        if (remaining_ == 0) latch_time_us_ = 0;
+        remaining_ |= slots;
+        current_.frame_number = ++frame_number_;
+        current_.start_skew_us = start_skew_us;
+        return frame_number_;
+    }
+
+    // Retire one slot; returns true and fills info when that completes the frame
+    bool retire(int32_t slot, int64_t done_time_us, FrameInfo& info) noexcept {
+        const uint32_t slot_bit = TransmitScheduler::bit(slot);
+        if (!(remaining_ & slot_bit)) return false;
+        remaining_ &= ~slot_bit;
+        if (done_time_us > latch_time_us_) latch_time_us_ = done_time_us;
+        if (remaining_ != 0) return false;
+        info = current_;
+        info.latch_time_us = latch_time_us_;
+        return true;
+    }
+
+    void reset() noexcept {
+        remaining_ = 0;
+        latch_time_us_ = 0;
+    }
+
+private:
+    uint32_t remaining_ = 0;
+    uint32_t frame_number_ = 0;
+    int64_t latch_time_us_ = 0;
+    FrameInfo current_;
+};
@@ -0,0 +1,237 @@
+/* Pixel transports
+ * A transport owns a channel's output peripheral and its wire-format frame buffer.
+ * The driver task encodes into it while the channel's transmit slot is idle; every
+ * other call comes from the transmit service task, which is woken with the slot bit
+ * whenever the transport's interrupts report progress.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "driver/i2s_std.h"
+#include "driver/rmt_tx.h"
+#include "driver/spi_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "pixel_core.h"
+#include "pixel_color16.h"
+#include "i2s_pixel_protocol.h"
+#include "rmt_pixel_protocol.h"
+#include "spi_pixel_protocol.h"
+
+struct ChannelConfig;
+
+// Output backend of a channel
+enum class PixelBus : uint8_t {
+    I2S,  // Single-wire strips (WS2812B and friends), see PixelChipset
+    SPI,  // Clocked strips (APA102, SK9822, HD108), see ClockedChipset
+    RMT,  // Single-wire strips on an RMT TX channel, leaves the I2S peripherals free
+};
+
+class PixelTransport {
+public:
+    virtual ~PixelTransport() = default;
+
+    // Claim the peripheral; progress is reported to tx_task as the slot's notification bit
+    virtual bool initialize(TaskHandle_t tx_task, int32_t tx_slot) = 0;
+
+    // Build the wire frame. scale (0..65535) is only applied by transports that
+    // scale while encoding, the others receive pixels that are already scaled.
+    virtual void encode(const std::vector<PixelColor>& pixels, uint16_t scale) = 0;
+    // Same from 16-bit levels, for transports that report encodes16()
+    virtual void encode16(const std::vector<PixelColor16>& /*pixels*/, uint16_t /*scale*/) {}
+    // A frame between two rendered keyframes, from -> to at weight/256 (0..256), always
+    // scaled by scale. The default lerps into a scratch frame and encodes that.
+    virtual void encodeLerp(const std::vector<PixelColor>& from, const std::vector<PixelColor>& to,
+                            uint16_t weight, uint16_t scale);
+
+    // Temporal dithering of the final 8-bit quantization. Transports without one ignore it.
+    virtual void setTemporalDither(bool /*enabled*/) {}
+    [[nodiscard]] virtual bool temporalDither() const noexcept { return false; }
+
+    // The frame built by the last encode(), for the cycle cache. Empty while the encoding
+    // of identical pixels changes from frame to frame (temporal dither).
+    [[nodiscard]] virtual std::span<const uint8_t> encodedFrame() const noexcept { return {}; }
+    // Put back a frame taken from encodedFrame() instead of encoding
+    virtual void loadEncodedFrame(std::span<const uint8_t> /*frame*/) {}
+
+    virtual bool prepare() = 0;  // Stage the frame so start() does as little as possible
+    virtual bool start() = 0;    // Put the staged frame on the wire
+    virtual void refill() {}     // Queue the part of the frame that did not fit when staged
+    virtual bool service() = 0;  // Handle a progress notification; true once the frame is out
+    virtual void abort() = 0;    // Stop a frame that missed its deadline
+    // True while the DMA may still read the encode buffer after an abort() that could not
+    // stop it; nothing may be encoded or staged until this returns false
+    [[nodiscard]] virtual bool inFlight() { return false; }
+
+    [[nodiscard]] virtual const char* busName() const noexcept = 0;
+    [[nodiscard]] virtual const char* chipsetName() const noexcept = 0;
+    [[nodiscard]] virtual int64_t wireTimeUs() const noexcept = 0;
+    [[nodiscard]] virtual bool scalesOnEncode() const noexcept { return false; }
+    // Takes 16-bit levels directly; otherwise 16-bit channels dither down to 8 bits first
+    [[nodiscard]] virtual bool encodes16() const noexcept { return false; }
+    [[nodiscard]] virtual const I2sDmaConfig* dmaConfig() const noexcept { return nullptr; }
+
+    // TransmitHealth::EVENT_* raised by the interrupts during the current frame
+    [[nodiscard]] uint8_t events() const noexcept { return events_; }
+    // Time the last byte of the current frame went out, 0 while still sending
+    [[nodiscard]] int64_t doneTimeUs() const noexcept { return done_time_us_; }
+
+    [[nodiscard]] static std::unique_ptr<PixelTransport> create(int32_t channel_id, const ChannelConfig& config);
+
+protected:
+    void resetFrameState() noexcept {
+        events_ = 0;
+        done_time_us_ = 0;
+    }
+
+    TaskHandle_t tx_task_ = nullptr;
+    int32_t tx_slot_ = -1;
+    std::vector<PixelColor> lerp_scratch_;  // Default encodeLerp() only
+    volatile uint8_t events_ = 0;        // Set from ISRs
+    volatile int64_t done_time_us_ = 0;  // Set from ISRs
+};
+
+// Single-wire strips through an I2S peripheral in 16-bit stereo mode. Frames larger
+// than the DMA ring are streamed: the on_sent interrupt wakes the service task to refill.
+class I2sTransport final : public PixelTransport {
+public:
+    I2sTransport(int32_t channel_id, const ChannelConfig& config);
+    ~I2sTransport() override;
+
+    bool initialize(TaskHandle_t tx_task, int32_t tx_slot) override;
+    void encode(const std::vector<PixelColor>& pixels, uint16_t scale) override;
+    void encode16(const std::vector<PixelColor16>& pixels, uint16_t scale) override;
+    void encodeLerp(const std::vector<PixelColor>& from, const std::vector<PixelColor>& to,
+                    uint16_t weight, uint16_t scale) override;
+    void setTemporalDither(bool enabled) override;
+    [[nodiscard]] bool temporalDither() const noexcept override { return temporal_dither_; }
+    [[nodiscard]] std::span<const uint8_t> encodedFrame() const noexcept override;
+    void loadEncodedFrame(std::span<const uint8_t> frame) override;
+    bool prepare() override;
+    bool start() override;
+    void refill() override;
+    bool service() override;
+    void abort() override;
+
+    [[nodiscard]] const char* busName() const noexcept override { return "i2s"; }
+    [[nodiscard]] const char* chipsetName() const noexcept override { return protocol_->profile->name; }
+    [[nodiscard]] int64_t wireTimeUs() const noexcept override;
+    [[nodiscard]] const I2sDmaConfig* dmaConfig() const noexcept override { return &dma_config_; }
+    // While dithering, scaling moves into the encoder where the 8.8 levels are available
+    [[nodiscard]] bool scalesOnEncode() const noexcept override { return temporal_dither_; }
+    [[nodiscard]] bool encodes16() const noexcept override { return temporal_dither_; }
+
+private:
+    static bool onSent(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx);
+    static bool onSendQueueOverflow(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx);
+    size_t encodeHeader(size_t pixel_count);
+
+    int32_t channel_id_;
+    gpio_num_t pin_;
+    uint16_t pixel_count_;
+    PixelFormat format_;
+    uint32_t dma_irq_hz_;
+    uint32_t max_dma_bytes_;
+    const PixelProtocol* protocol_;
+    I2sEncoderSet encoders_;
+    bool temporal_dither_ = false;
+    std::vector<uint8_t> dither_residue_;  // One 8-bit fraction per component
+
+    std::vector<uint8_t> buffer_;
+    i2s_chan_handle_t channel_ = nullptr;
+    I2sDmaConfig dma_config_;
+    volatile size_t bytes_sent_ = 0;  // Updated from the on_sent ISR
+    size_t bytes_queued_ = 0;         // Bytes handed to the DMA queue this frame
+    std::vector<uint8_t> idle_tail_;  // One descriptor at the idle level, idle-high lines only
+    volatile size_t idle_queued_ = 0; // Bytes of idle_tail_ queued behind this frame
+};
+
+// Single-wire strips through an RMT TX channel. The frame is kept as wire-order bytes,
+// one per component, and the encoder callback expands them into RMT symbols a chunk at
+// a time as the channel memory drains, so there is no 32x full-frame symbol buffer.
+class RmtTransport final : public PixelTransport {
+public:
+    RmtTransport(int32_t channel_id, const ChannelConfig& config);
+    ~RmtTransport() override;
+
+    bool initialize(TaskHandle_t tx_task, int32_t tx_slot) override;
+    void encode(const std::vector<PixelColor>& pixels, uint16_t scale) override;
+    [[nodiscard]] std::span<const uint8_t> encodedFrame() const noexcept override { return frame_; }
+    void loadEncodedFrame(std::span<const uint8_t> frame) override;
+    bool prepare() override;
+    bool start() override;
+    bool service() override;
+    void abort() override;
+
+    [[nodiscard]] const char* busName() const noexcept override { return "rmt"; }
+    [[nodiscard]] const char* chipsetName() const noexcept override { return protocol_->profile->name; }
+    [[nodiscard]] int64_t wireTimeUs() const noexcept override;
+
+private:
+    static size_t encodeSymbols(const void* data, size_t data_size, size_t symbols_written,
+                                size_t symbols_free, rmt_symbol_word_t* symbols, bool* done, void* arg);
+    static bool onTransDone(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t* event, void* user_ctx);
+    void release();
+
+    int32_t channel_id_;
+    gpio_num_t pin_;
+    uint32_t resolution_hz_;
+    const PixelProtocol* protocol_;
+    RmtPixelSymbols symbols_;
+    RmtPackFn pack_fn_;
+
+    std::vector<uint8_t> frame_;  // Header values + pixels, read by the encoder while sending
+    rmt_channel_handle_t channel_ = nullptr;
+    rmt_encoder_handle_t encoder_ = nullptr;
+    bool enabled_ = false;
+    bool sending_ = false;
+};
+
+// Clocked strips on a dedicated SPI bus. The whole frame is one DMA transaction from a
+// DMA-capable buffer, so there is nothing to refill and no way to underrun.
+class SpiTransport final : public PixelTransport {
+public:
+    SpiTransport(int32_t channel_id, const ChannelConfig& config);
+    ~SpiTransport() override;
+
+    bool initialize(TaskHandle_t tx_task, int32_t tx_slot) override;
+    void encode(const std::vector<PixelColor>& pixels, uint16_t scale) override;
+    void encode16(const std::vector<PixelColor16>& pixels, uint16_t scale) override;
+    [[nodiscard]] std::span<const uint8_t> encodedFrame() const noexcept override { return {buffer_, buffer_ ? frame_bytes_ : 0}; }
+    void loadEncodedFrame(std::span<const uint8_t> frame) override;
+    bool prepare() override;
+    bool start() override;
+    bool service() override;
+    void abort() override;
+    [[nodiscard]] bool inFlight() override;
+
+    [[nodiscard]] const char* busName() const noexcept override { return "spi"; }
+    [[nodiscard]] const char* chipsetName() const noexcept override { return clockedChipsetName(chipset_); }
+    [[nodiscard]] int64_t wireTimeUs() const noexcept override;
+    // Brightness and current limiting are applied at 16 bits while packing
+    [[nodiscard]] bool scalesOnEncode() const noexcept override { return true; }
+    [[nodiscard]] bool encodes16() const noexcept override { return true; }
+
+private:
+    static void onTransferDone(spi_transaction_t* transaction);
+    void releaseBus();
+
+    int32_t channel_id_;
+    gpio_num_t data_pin_;
+    gpio_num_t clock_pin_;
+    uint32_t clock_hz_;
+    ClockedChipset chipset_;
+    ClockedPackFn<PixelColor> pack_fn_;
+    ClockedPackFn<PixelColor16> pack16_fn_;
+
+    uint8_t* buffer_ = nullptr;  // DMA-capable, frame_bytes_ long
+    size_t frame_bytes_ = 0;
+    spi_host_device_t host_ = SPI2_HOST;
+    bool bus_initialized_ = false;
+    spi_device_handle_t device_ = nullptr;
+    spi_transaction_t transaction_ = {};
+    bool queued_ = false;  // The SPI driver owns transaction_ and the buffer
+};
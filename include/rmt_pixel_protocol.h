@@ -0,0 +1,155 @@
+/* RMT Pixel Protocol for single-wire LED strips
+ * Builds RMT symbols (one per LED data bit) from the same chipset timing profiles the
+ * I2S tables come from, and expands a wire-order byte frame into them a chunk at a
+ * time, so the RMT encoder callback never needs a full-frame symbol buffer.
+ * Symbols are plain 32-bit words laid out like rmt_symbol_word_t:
+ * duration0[14:0] level0[15] duration1[30:16] level1[31].
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "pixel_core.h"
+#include "i2s_pixel_protocol.h"
+
+// RMT tick rate every profile is checked against (100 ns steps)
+inline constexpr uint32_t RMT_PIXEL_RESOLUTION_HZ = 10000000;
+inline constexpr uint32_t RMT_MAX_DURATION = 0x7FFF;
+
+[[nodiscard]] constexpr uint32_t rmtSymbol(uint32_t duration0, bool level0, uint32_t duration1, bool level1) noexcept {
+    return (duration0 & RMT_MAX_DURATION) | (static_cast<uint32_t>(level0) << 15) |
+           ((duration1 & RMT_MAX_DURATION) << 16) | (static_cast<uint32_t>(level1) << 31);
+}
+
+// Ticks covering at least ns
+[[nodiscard]] constexpr uint32_t rmtTicks(uint64_t ns, uint32_t resolution_hz) noexcept {
+    return static_cast<uint32_t>((ns * resolution_hz + 999999999) / 1000000000);
+}
+
+// Ticks of one LED data bit: the I2S bit period, so both transports put the same
+// waveform on the wire
+[[nodiscard]] constexpr uint32_t rmtBitTicks(const PixelProfile& p, uint32_t resolution_hz) noexcept {
+    return static_cast<uint32_t>((static_cast<uint64_t>(p.subbits) * resolution_hz + p.bitrate - 1) / p.bitrate);
+}
+
+[[nodiscard]] constexpr uint32_t rmtResetTicks(const PixelProfile& p, uint32_t resolution_hz) noexcept {
+    return rmtTicks(static_cast<uint64_t>(p.timing.reset_us) * 1000, resolution_hz) + 1;
+}
+
+struct RmtPixelSymbols {
+    std::array<uint32_t, 2> bit;  // Symbol for a 0 and for a 1 data bit
+    uint32_t reset;               // Idle level long enough to latch the frame
+    uint32_t bit_ticks;
+    uint32_t reset_ticks;
+};
+
+// High times at the start of their windows, as in generateSymbolTable()
+[[nodiscard]] constexpr RmtPixelSymbols makeRmtPixelSymbols(const PixelProfile& p, uint32_t resolution_hz) noexcept {
+    const uint32_t period = rmtBitTicks(p, resolution_hz);
+    const uint32_t h0 = rmtTicks(p.timing.t0h_min_ns, resolution_hz);
+    const uint32_t h1 = rmtTicks(p.timing.t1h_min_ns, resolution_hz);
+    const uint32_t reset = rmtResetTicks(p, resolution_hz);
+    const bool active = !p.inverted;
+    return RmtPixelSymbols{
+        {rmtSymbol(h0, active, period - h0, !active), rmtSymbol(h1, active, period - h1, !active)},
+        rmtSymbol(reset - reset / 2, !active, reset / 2, !active),
+        period,
+        reset,
+    };
+}
+
+// True if the symbols land inside every pulse window of the chipset at this resolution
+[[nodiscard]] constexpr bool rmtPixelSymbolsValid(const PixelProfile& p, uint32_t resolution_hz) noexcept {
+    const uint64_t period = rmtBitTicks(p, resolution_hz);
+    const uint64_t h0 = rmtTicks(p.timing.t0h_min_ns, resolution_hz);
+    const uint64_t h1 = rmtTicks(p.timing.t1h_min_ns, resolution_hz);
+    const uint64_t res = resolution_hz;
+    // Compare tick counts in ns scaled by the resolution to stay exact
+    return h0 >= 1 && h0 < h1 && h1 < period && period <= RMT_MAX_DURATION &&
+           rmtResetTicks(p, resolution_hz) - rmtResetTicks(p, resolution_hz) / 2 <= RMT_MAX_DURATION &&
+           h0 * 1000000000 <= p.timing.t0h_max_ns * res &&
+           h1 * 1000000000 <= p.timing.t1h_max_ns * res &&
+           (period - h1) * 1000000000 >= p.timing.tl_min_ns * res &&
+           period * 1000000000 >= p.timing.bit_min_ns * res;
+}
+
+static_assert(rmtPixelSymbolsValid(pixelProfile(PixelChipset::WS2812B), RMT_PIXEL_RESOLUTION_HZ));
+static_assert(rmtPixelSymbolsValid(pixelProfile(PixelChipset::SK6812), RMT_PIXEL_RESOLUTION_HZ));
+static_assert(rmtPixelSymbolsValid(pixelProfile(PixelChipset::WS2811), RMT_PIXEL_RESOLUTION_HZ));
+static_assert(rmtPixelSymbolsValid(pixelProfile(PixelChipset::WS2815), RMT_PIXEL_RESOLUTION_HZ));
+static_assert(rmtPixelSymbolsValid(pixelProfile(PixelChipset::TM1814), RMT_PIXEL_RESOLUTION_HZ));
+static_assert(rmtPixelSymbolsValid(pixelProfile(PixelChipset::WS2812B_FAST), RMT_PIXEL_RESOLUTION_HZ));
+static_assert(rmtPixelSymbolsValid(pixelProfile(PixelChipset::SK6812_FAST), RMT_PIXEL_RESOLUTION_HZ));
+
+// WS2812B at 10 MHz: 1.2 us bits, 0 = 300 ns high, 1 = 700 ns high
+static_assert(makeRmtPixelSymbols(pixelProfile(PixelChipset::WS2812B), RMT_PIXEL_RESOLUTION_HZ).bit[0] ==
+              rmtSymbol(3, true, 9, false));
+static_assert(makeRmtPixelSymbols(pixelProfile(PixelChipset::WS2812B), RMT_PIXEL_RESOLUTION_HZ).bit[1] ==
+              rmtSymbol(7, true, 5, false));
+
+// Symbols in a frame of data_bytes: every data bit, then the reset
+[[nodiscard]] constexpr size_t rmtFrameSymbols(size_t data_bytes) noexcept {
+    return data_bytes * 8 + 1;
+}
+
+// Expand the frame from symbol `position` on, MSB first, writing at most max_symbols.
+// Returns the symbols written; the frame is complete once position + return value
+// reaches rmtFrameSymbols(bytes). Stateless, so any chunk size works.
+inline size_t encodeRmtSymbols(const RmtPixelSymbols& symbols, const uint8_t* data, size_t bytes,
+                               size_t position, uint32_t* out, size_t max_symbols) noexcept {
+    const size_t total_bits = bytes * 8;
+    size_t written = 0;
+    while (position < total_bits && written < max_symbols) {
+        const uint32_t byte = data[position >> 3];
+        if ((position & 7) == 0 && max_symbols - written >= 8) {
+            // Whole byte, the common case once a chunk is under way
+            for (int bit = 7; bit >= 0; --bit) {
+                out[written++] = symbols.bit[(byte >> bit) & 1];
+            }
+            position += 8;
+        } else {
+            out[written++] = symbols.bit[(byte >> (7 - (position & 7))) & 1];
+            ++position;
+        }
+    }
+    if (position == total_bits && written < max_symbols) {
+        out[written++] = symbols.reset;
+    }
+    return written;
+}
+
+// Packs count pixels as one byte per component in wire order, returns the bytes written
+using RmtPackFn = size_t (*)(const PixelColor* pixels, size_t count, uint8_t* out);
+
+template <ColorOrder Order, PixelFormat Format>
+size_t packWirePixels(const PixelColor* pixels, size_t count, uint8_t* out) {
+    constexpr std::array<uint8_t, 4> order = colorOrderIndices(Order, Format);
+    constexpr size_t colors = static_cast<size_t>(Format);
+
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t c = 0; c < colors; ++c) {
+            *out++ = pixels[i].component(order[c]);
+        }
+    }
+    return count * colors;
+}
+
+template <ColorOrder Order>
+RmtPackFn selectRmtPackerForFormat(PixelFormat format) noexcept {
+    return (format == PixelFormat::RGBW) ? &packWirePixels<Order, PixelFormat::RGBW>
+                                         : &packWirePixels<Order, PixelFormat::RGB>;
+}
+
+[[nodiscard]] inline RmtPackFn selectRmtPacker(ColorOrder order, PixelFormat format) noexcept {
+    switch (order) {
+        case ColorOrder::RGB:  return selectRmtPackerForFormat<ColorOrder::RGB>(format);
+        case ColorOrder::RBG:  return selectRmtPackerForFormat<ColorOrder::RBG>(format);
+        case ColorOrder::GBR:  return selectRmtPackerForFormat<ColorOrder::GBR>(format);
+        case ColorOrder::BRG:  return selectRmtPackerForFormat<ColorOrder::BRG>(format);
+        case ColorOrder::BGR:  return selectRmtPackerForFormat<ColorOrder::BGR>(format);
+        case ColorOrder::WRGB: return selectRmtPackerForFormat<ColorOrder::WRGB>(format);
+        case ColorOrder::WGRB: return selectRmtPackerForFormat<ColorOrder::WGRB>(format);
+        default:               return selectRmtPackerForFormat<ColorOrder::GRB>(format);
+    }
+}
@@ -0,0 +1,222 @@
+/* SPI Pixel Protocol for clocked (two-wire) LED strips
+ * Frame packing for APA102 / SK9822 / HD108.
+ *  - APA102, SK9822: one 32-bit word per pixel, three 1 bits, a 5-bit global
+ *    brightness and three 8-bit PWM values, after a 32-bit zero start frame.
+ *  - HD108: one 64-bit word per pixel, a 1 bit, three 5-bit current gains and three
+ *    16-bit PWM values (big-endian), after a 128-bit zero start frame.
+ * Every frame ends with zeros that clock the data through the chain.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "pixel_core.h"
+#include "pixel_color16.h"
+
+enum class ClockedChipset : uint8_t {
+    APA102,
+    SK9822,  // Also needs a 32-bit zero reset frame after the data to latch
+    HD108,   // Native 16-bit PWM
+};
+
+// Wire order of the chips as shipped, used for ColorOrder::Default
+[[nodiscard]] constexpr ColorOrder clockedNativeOrder(ClockedChipset chipset) noexcept {
+    return chipset == ClockedChipset::HD108 ? ColorOrder::RGB : ColorOrder::BGR;
+}
+
+[[nodiscard]] constexpr const char* clockedChipsetName(ClockedChipset chipset) noexcept {
+    switch (chipset) {
+        case ClockedChipset::SK9822: return "SK9822";
+        case ClockedChipset::HD108:  return "HD108";
+        default:                     return "APA102";
+    }
+}
+
+inline constexpr uint8_t APA102_PIXEL_MARKER = 0xE0;  // Top three bits of every pixel word
+inline constexpr uint8_t APA102_MAX_BRIGHTNESS = 31;
+
+[[nodiscard]] constexpr size_t clockedStartFrameBytes(ClockedChipset chipset) noexcept {
+    return chipset == ClockedChipset::HD108 ? 16 : 4;
+}
+
+[[nodiscard]] constexpr size_t clockedBytesPerPixel(ClockedChipset chipset) noexcept {
+    return chipset == ClockedChipset::HD108 ? 8 : 4;
+}
+
+// Each LED delays the clocked data by half a clock, so n pixels need n/2 extra clock
+// edges after the last pixel word. Zeros are used so no LED can mistake it for data.
+[[nodiscard]] constexpr size_t clockedEndFrameBytes(ClockedChipset chipset, size_t pixel_count) noexcept {
+    const size_t propagate = std::max<size_t>((pixel_count + 15) / 16, 4);
+    return propagate + (chipset == ClockedChipset::SK9822 ? 4 : 0);
+}
+
+[[nodiscard]] constexpr size_t clockedFrameBytes(ClockedChipset chipset, size_t pixel_count) noexcept {
+    return clockedStartFrameBytes(chipset) + pixel_count * clockedBytesPerPixel(chipset) +
+           clockedEndFrameBytes(chipset, pixel_count);
+}
+
+// Split three 16-bit levels into the smallest global brightness that still holds the
+// brightest one plus 8-bit PWM values relative to it. Dim colors then keep full PWM
+// resolution instead of collapsing onto the first few codes (about 13 bits of range).
+[[nodiscard]] constexpr std::array<uint8_t, 4> packApa102Word(uint16_t c0, uint16_t c1, uint16_t c2) noexcept {
+    const uint32_t peak = std::max({c0, c1, c2});
+    const uint32_t gb = std::max<uint32_t>((peak * APA102_MAX_BRIGHTNESS + 65534) / 65535, 1);
+    const uint32_t divisor = gb * 65535;
+    const auto pwm = [divisor](uint32_t level) {
+        return static_cast<uint8_t>((level * APA102_MAX_BRIGHTNESS * 255 + divisor / 2) / divisor);
+    };
+    return {static_cast<uint8_t>(APA102_PIXEL_MARKER | gb), pwm(c0), pwm(c1), pwm(c2)};
+}
+
+static_assert(packApa102Word(65535, 65535, 65535) == std::array<uint8_t, 4>{0xFF, 255, 255, 255});
+static_assert(packApa102Word(0, 0, 0) == std::array<uint8_t, 4>{0xE1, 0, 0, 0});
+// 1/255 at full scale lands on the lowest brightness step with PWM to spare
+static_assert(packApa102Word(257, 0, 0) == std::array<uint8_t, 4>{0xE1, 31, 0, 0});
+// Full white at 1/16 scale keeps 8 bits of PWM on a reduced global brightness
+static_assert(packApa102Word(4096, 4096, 4096)[0] == (0xE0 | 2) &&
+              packApa102Word(4096, 4096, 4096)[1] == 247);
+
+// HD108 header: start bit plus all three current gains at maximum; dimming is left to
+// the 16-bit PWM so the gains never change between frames
+inline constexpr uint8_t HD108_HEADER[2] = {0xFF, 0xFF};
+
+// 16-bit level of one component under a 0..65535 scale
+[[nodiscard]] constexpr uint16_t clockedLevel(const PixelColor& pixel, uint8_t index, uint16_t scale) noexcept {
+    return scale16(widen8(pixel.component(index)), scale);
+}
+[[nodiscard]] constexpr uint16_t clockedLevel(const PixelColor16& pixel, uint8_t index, uint16_t scale) noexcept {
+    return scale16(pixel.component(index), scale);
+}
+
+// Packs count pixels, returns the bytes written
+template <typename Pixel>
+using ClockedPackFn = size_t (*)(const Pixel* pixels, size_t count, uint16_t scale, uint8_t* out);
+
+// Packer specialized on word format, color order and input depth. RGBW input drops W,
+// none of these chips has a white LED.
+template <bool Hd108, ColorOrder Order, typename Pixel>
+constexpr size_t packClockedPixels(const Pixel* pixels, size_t count, uint16_t scale, uint8_t* out) {
+    constexpr std::array<uint8_t, 4> order = colorOrderIndices(Order, PixelFormat::RGB);
+
+    uint8_t* const begin = out;
+    for (size_t i = 0; i < count; ++i) {
+        const Pixel& pixel = pixels[i];
+        const uint16_t c0 = clockedLevel(pixel, order[0], scale);
+        const uint16_t c1 = clockedLevel(pixel, order[1], scale);
+        const uint16_t c2 = clockedLevel(pixel, order[2], scale);
+        if constexpr (Hd108) {
+            out[0] = HD108_HEADER[0];
+            out[1] = HD108_HEADER[1];
+            out[2] = static_cast<uint8_t>(c0 >> 8);
+            out[3] = static_cast<uint8_t>(c0);
+            out[4] = static_cast<uint8_t>(c1 >> 8);
+            out[5] = static_cast<uint8_t>(c1);
+            out[6] = static_cast<uint8_t>(c2 >> 8);
+            out[7] = static_cast<uint8_t>(c2);
+            out += 8;
+        } else {
+            const auto word = packApa102Word(c0, c1, c2);
+            out[0] = word[0];
+            out[1] = word[1];
+            out[2] = word[2];
+            out[3] = word[3];
+            out += 4;
+        }
+    }
+    return static_cast<size_t>(out - begin);
+}
+
+template <bool Hd108, typename Pixel>
+ClockedPackFn<Pixel> selectClockedPackerForOrder(ColorOrder order) noexcept {
+    switch (order) {
+        case ColorOrder::RGB:  return &packClockedPixels<Hd108, ColorOrder::RGB, Pixel>;
+        case ColorOrder::RBG:  return &packClockedPixels<Hd108, ColorOrder::RBG, Pixel>;
+        case ColorOrder::GRB:  return &packClockedPixels<Hd108, ColorOrder::GRB, Pixel>;
+        case ColorOrder::GBR:  return &packClockedPixels<Hd108, ColorOrder::GBR, Pixel>;
+        case ColorOrder::BRG:  return &packClockedPixels<Hd108, ColorOrder::BRG, Pixel>;
+        case ColorOrder::WRGB: return &packClockedPixels<Hd108, ColorOrder::RGB, Pixel>;
+        case ColorOrder::WGRB: return &packClockedPixels<Hd108, ColorOrder::GRB, Pixel>;
+        default:               return &packClockedPixels<Hd108, ColorOrder::BGR, Pixel>;
+    }
+}
+
+template <typename Pixel>
+[[nodiscard]] ClockedPackFn<Pixel> selectClockedPacker(ClockedChipset chipset, ColorOrder order) noexcept {
+    return chipset == ClockedChipset::HD108 ? selectClockedPackerForOrder<true, Pixel>(order)
+                                            : selectClockedPackerForOrder<false, Pixel>(order);
+}
+
+// Pack a complete frame into out, which must hold clockedFrameBytes(chipset, count) bytes.
+// Returns the frame length.
+template <typename Pixel>
+constexpr size_t packClockedFrame(ClockedPackFn<Pixel> pack, ClockedChipset chipset,
+                        const Pixel* pixels, size_t count, uint16_t scale, uint8_t* out) {
+    const size_t start = clockedStartFrameBytes(chipset);
+    std::fill(out, out + start, uint8_t(0));
+    size_t pos = start;
+    pos += pack(pixels, count, scale, out + pos);
+    const size_t end = clockedEndFrameBytes(chipset, count);
+    std::fill(out + pos, out + pos + end, uint8_t(0));
+    return pos + end;
+}
+
+// Whole frames at full scale, packed at compile time for the checks below
+template <ClockedChipset Chipset, ColorOrder Order, size_t N>
+constexpr std::array<uint8_t, clockedFrameBytes(Chipset, N)> packedClockedFrame(const std::array<PixelColor, N>& pixels) {
+    std::array<uint8_t, clockedFrameBytes(Chipset, N)> out{};
+    out.fill(0xAA);  // So the zero frames must have been written
+    packClockedFrame<PixelColor>(&packClockedPixels<Chipset == ClockedChipset::HD108, Order, PixelColor>, Chipset,
+                                 pixels.data(), N, UINT16_MAX, out.data());
+    return out;
+}
+
+[[nodiscard]] constexpr bool allZero(const uint8_t* begin, const uint8_t* end) noexcept {
+    for (; begin != end; ++begin) {
+        if (*begin != 0) return false;
+    }
+    return true;
+}
+
+inline constexpr std::array<PixelColor, 2> CLOCKED_CHECK_PIXELS = {PixelColor(0x10, 0x80, 0xFF), PixelColor(1, 2, 3)};
+
+// Zero start frame, then each pixel's word in BGR order, then zeros
+static_assert([] {
+    constexpr auto frame = packedClockedFrame<ClockedChipset::APA102, ColorOrder::BGR>(CLOCKED_CHECK_PIXELS);
+    constexpr auto first = packApa102Word(widen8(0xFF), widen8(0x80), widen8(0x10));
+    constexpr auto second = packApa102Word(widen8(3), widen8(2), widen8(1));
+    return frame.size() == 4 + 2 * 4 + 4 && allZero(frame.data(), frame.data() + 4) &&
+           frame[4] == first[0] && frame[5] == first[1] && frame[6] == first[2] && frame[7] == first[3] &&
+           frame[8] == second[0] && frame[9] == second[1] && frame[10] == second[2] && frame[11] == second[3] &&
+           allZero(frame.data() + 12, frame.data() + frame.size());
+}());
+// A non-default order moves the PWM bytes, not the brightness byte
+static_assert([] {
+    constexpr auto bgr = packedClockedFrame<ClockedChipset::APA102, ColorOrder::BGR>(CLOCKED_CHECK_PIXELS);
+    constexpr auto grb = packedClockedFrame<ClockedChipset::APA102, ColorOrder::GRB>(CLOCKED_CHECK_PIXELS);
+    return grb[4] == bgr[4] && grb[5] == bgr[6] && grb[6] == bgr[7] && grb[7] == bgr[5];
+}());
+// HD108: 128-bit zero start frame, header, then big-endian 16-bit levels in wire order
+static_assert([] {
+    constexpr auto frame = packedClockedFrame<ClockedChipset::HD108, ColorOrder::RGB>(CLOCKED_CHECK_PIXELS);
+    return allZero(frame.data(), frame.data() + 16) && frame[16] == HD108_HEADER[0] &&
+           frame[17] == HD108_HEADER[1] && frame[18] == 0x10 && frame[19] == 0x10 && frame[20] == 0x80 &&
+           frame[21] == 0x80 && frame[22] == 0xFF && frame[23] == 0xFF &&
+           allZero(frame.data() + 32, frame.data() + frame.size());
+}());
+// The end frame gives at least n/2 clocks, and SK9822 adds its 32-bit latch frame on top
+static_assert([] {
+    for (size_t n = 0; n <= 2048; ++n) {
+        if (clockedEndFrameBytes(ClockedChipset::APA102, n) * 8 < n / 2 ||
+            clockedEndFrameBytes(ClockedChipset::SK9822, n) != clockedEndFrameBytes(ClockedChipset::APA102, n) + 4) {
+            return false;
+        }
+    }
+    return true;
+}());
+static_assert([] {
+    constexpr auto apa102 = packedClockedFrame<ClockedChipset::APA102, ColorOrder::BGR>(CLOCKED_CHECK_PIXELS);
+    constexpr auto sk9822 = packedClockedFrame<ClockedChipset::SK9822, ColorOrder::BGR>(CLOCKED_CHECK_PIXELS);
+    return sk9822.size() == apa102.size() + 4 && allZero(sk9822.data() + 12, sk9822.data() + sk9822.size());
+}());
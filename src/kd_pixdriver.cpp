@@ -1,62 +1,168 @@
 #include "kd_pixdriver.h"
 #include "pixel_effects.h"
+#include "pixel_show.h"
+#include "pixel_trace.h"
 #include "pixel_version.h"
 #include "i2s_pixel_protocol.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_rom_sys.h"
 #include "nvs.h"
 #include "cJSON.h"
-#include "driver/i2s_std.h"
-#include "driver/i2s_common.h"
 #include <algorithm>
 #include <cstring>
+#include <strings.h>
 
 namespace {
 constexpr const char* TAG = "kd_pixdriver";
-constexpr const char* NVS_NAMESPACE = "pixdriver";
-} // anonymous namespace
 
-// Static member definitions
-std::vector<std::unique_ptr<PixelChannel>> PixelDriver::channels_;
-std::unique_ptr<PixelEffectEngine> PixelDriver::effect_engine_;
-int32_t PixelDriver::main_channel_id_ = -1;
-TaskHandle_t PixelDriver::task_handle_ = nullptr;
-int32_t PixelDriver::current_limit_ma_ = -1;
-uint32_t PixelDriver::update_rate_hz_ = 60;
-bool PixelDriver::running_ = false;
-int32_t PixelDriver::next_channel_id_ = 0;
-bool PixelDriver::initialized_ = false;
-
-// I2S callback function
-extern "C" IRAM_ATTR bool i2s_tx_callback(i2s_chan_handle_t handle,
-                                           i2s_event_data_t* event,
-                                           void* user_ctx) {
-    auto* channel = static_cast<PixelChannel*>(user_ctx);
-    if (channel && event) {
-        channel->bytes_sent_ += event->size;
-        if (channel->bytes_sent_ >= channel->i2s_buffer_.size()) {
-            BaseType_t higher_priority_task_woken = pdFALSE;
-            xSemaphoreGiveFromISR(channel->complete_semaphore_, &higher_priority_task_woken);
+// Event group bit broadcast to waitForVsync() callers
+constexpr EventBits_t VSYNC_BIT = 1u << 0;
+
+// How often the service task checks frame deadlines while frames are in flight
+constexpr uint32_t TX_DEADLINE_POLL_MS = 10;
+
+// Slack on top of twice the nominal wire time before a frame counts as timed out
+constexpr int64_t TX_DEADLINE_SLACK_US = 5000;
+
+// Longest a follower's receive task blocks before checking whether sync was disabled
+constexpr uint32_t SYNC_RECEIVE_TIMEOUT_MS = 100;
+
+// Estimated draw of an 8-bit frame
+uint32_t frameCurrentMa(const std::vector<PixelColor>& pixels, bool rgbw) noexcept {
+    uint32_t total_ma = 0;
+    for (const auto& pixel : pixels) {
+        total_ma += (pixel.r * PixelPipeline::CURRENT_PER_CHANNEL_MA) / 255;
+        total_ma += (pixel.g * PixelPipeline::CURRENT_PER_CHANNEL_MA) / 255;
+        total_ma += (pixel.b * PixelPipeline::CURRENT_PER_CHANNEL_MA) / 255;
+        if (rgbw) {
+            total_ma += (pixel.w * PixelPipeline::CURRENT_PER_CHANNEL_MA) / 255;
         }
     }
-    return false;
+    return total_ma;
 }
 
-// ============= PixelDriver Implementation =============
+// Calls fn(slot) for every slot bit set in mask
+template <typename Fn>
+inline void forEachSlot(uint32_t mask, Fn&& fn) {
+    while (mask) {
+        const int32_t slot = TransmitScheduler::lowestSlot(mask);
+        mask &= mask - 1;
+        fn(slot);
+    }
+}
 
-void PixelDriver::initialize(uint32_t update_rate_hz) {
+// Resolves ColorOrder::Default, so a default-config APA102 strip gets its BGR order
+ChannelConfig withWireOrder(ChannelConfig config) {
+    if (config.color_order == ColorOrder::Default) {
+        config.color_order = config.bus == PixelBus::SPI ? clockedNativeOrder(config.clocked_chipset) : ColorOrder::GRB;
+    }
+    return config;
+}
+} // anonymous namespace
+
+// ============= PixelPipeline Implementation =============
+
+PixelPipeline& PixelDriver::pipeline() {
+    static PixelPipeline instance;
+    return instance;
+}
+
+// Out of line, where PixelImage is complete
+bool PixelDriver::setImage(int32_t channel_id, std::unique_ptr<PixelImage> image) {
+    return pipeline().setImage(channel_id, std::move(image));
+}
+
+// Out of line, where the engine and show types are complete
+PixelPipeline::PixelPipeline() = default;
+
+PixelPipeline::~PixelPipeline() {
+    shutdown();
+}
+
+void PixelPipeline::initialize(uint32_t update_rate_hz) {
+    PipelineConfig config;
+    config.update_rate_hz = update_rate_hz;
+    initialize(config);
+}
+
+void PixelPipeline::initialize(const PipelineConfig& config) {
     if (initialized_) return;
+    config_ = config;
+
+    vsync_event_ = xEventGroupCreate();
+    callback_mutex_ = xSemaphoreCreateMutex();
+    dispatch_mutex_ = xSemaphoreCreateMutex();
+    show_mutex_ = xSemaphoreCreateMutex();
+    sync_mutex_ = xSemaphoreCreateMutex();
+    if (!vsync_event_ || !callback_mutex_ || !dispatch_mutex_ || !show_mutex_ || !sync_mutex_) {
+        ESP_LOGE(TAG, "Failed to create frame sync primitives");
+        return;
+    }
 
-    update_rate_hz_ = update_rate_hz;
-    effect_engine_ = std::make_unique<PixelEffectEngine>(update_rate_hz);
+    if (createTask(transmitTask, "pixtx", 3072, configMAX_PRIORITIES - 1, &tx_task_handle_) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create transmit task");
+        return;
+    }
+
+    update_rate_hz_ = config.update_rate_hz;
+    effect_engine_ = std::make_unique<PixelEffectEngine>(update_rate_hz_);
     initialized_ = true;
-    ESP_LOGI(TAG, "PixelDriver initialized at %lu Hz", update_rate_hz);
+    if (config.core == tskNO_AFFINITY) {
+        ESP_LOGI(TAG, "PixelDriver initialized at %lu Hz", update_rate_hz_);
+    } else {
+        ESP_LOGI(TAG, "PixelDriver initialized at %lu Hz on core %d", update_rate_hz_, config.core);
+    }
 }
 
-void PixelDriver::shutdown() {
+// Every task of a pipeline runs on its core, if it has one
+BaseType_t PixelPipeline::createTask(TaskFunction_t fn, const char* name, uint32_t stack, UBaseType_t priority,
+                                     TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack, this, priority, handle, config_.core);
+}
+
+void PixelPipeline::shutdown() {
     if (!initialized_) return;
 
     stop();
-    channels_.clear();
+    disableSync();
+    while (sync_task_) {
+        vTaskDelay(pdMS_TO_TICKS(10));  // receive() always times out, so this ends
+    }
+    disableAudio();
+    if (sync_mutex_) {
+        vSemaphoreDelete(sync_mutex_);
+        sync_mutex_ = nullptr;
+    }
+    while (!channels_.empty()) {
+        removeChannel(channels_.back()->getId());
+    }
+    if (tx_task_handle_) {
+        vTaskDelete(tx_task_handle_);
+        tx_task_handle_ = nullptr;
+    }
+    present_tracker_.reset();
+    frame_callbacks_.clear();
+    dispatch_callbacks_.clear();
+    if (vsync_event_) {
+        vEventGroupDelete(vsync_event_);
+        vsync_event_ = nullptr;
+    }
+    if (callback_mutex_) {
+        vSemaphoreDelete(callback_mutex_);
+        callback_mutex_ = nullptr;
+    }
+    if (dispatch_mutex_) {
+        vSemaphoreDelete(dispatch_mutex_);
+        dispatch_mutex_ = nullptr;
+    }
+    show_player_ = nullptr;
+    show_recorder_ = nullptr;
+    if (show_mutex_) {
+        vSemaphoreDelete(show_mutex_);
+        show_mutex_ = nullptr;
+    }
     effect_engine_.reset();
     main_channel_id_ = -1;
     next_channel_id_ = 0;
@@ -64,19 +170,28 @@ void PixelDriver::shutdown() {
     ESP_LOGI(TAG, "PixelDriver shutdown");
 }
 
-int32_t PixelDriver::addChannel(const ChannelConfig& config) {
+int32_t PixelPipeline::addChannel(const ChannelConfig& config) {
     if (!initialized_) {
         ESP_LOGE(TAG, "PixelDriver not initialized");
         return -1;
     }
 
+    const int32_t slot = tx_scheduler_.acquireSlot();
+    if (slot < 0) {
+        ESP_LOGE(TAG, "No free transmit slot (max %ld channels)", TransmitScheduler::MAX_SLOTS);
+        return -1;
+    }
+
     const int32_t id = next_channel_id_++;
     auto channel = std::make_unique<PixelChannel>(id, config);
+    channel->owner_ = this;
 
-    if (!channel->initialize()) {
+    if (!channel->initialize(slot, tx_task_handle_)) {
         ESP_LOGE(TAG, "Failed to initialize channel %ld", id);
+        tx_scheduler_.releaseSlot(slot);
         return -1;
     }
+    tx_slots_[slot] = channel.get();
 
     channel->loadFromNVS();
 
@@ -85,15 +200,16 @@ int32_t PixelDriver::addChannel(const ChannelConfig& config) {
         ESP_LOGI(TAG, "Set channel %ld as main", id);
     }
 
-    ESP_LOGI(TAG, "Added channel %ld: pin %d, %d pixels, %s",
+    ESP_LOGI(TAG, "Added channel %ld: pin %d, %d pixels, %s, %s over %s",
              id, config.pin, config.pixel_count,
-             config.format == PixelFormat::RGBW ? "RGBW" : "RGB");
+             config.format == PixelFormat::RGBW ? "RGBW" : "RGB",
+             channel->getTransport()->chipsetName(), channel->getTransport()->busName());
 
     channels_.emplace_back(std::move(channel));
     return id;
 }
 
-bool PixelDriver::removeChannel(int32_t channel_id) {
+bool PixelPipeline::removeChannel(int32_t channel_id) {
     auto it = std::find_if(channels_.begin(), channels_.end(),
         [channel_id](const auto& ch) { return ch->getId() == channel_id; });
 
@@ -110,22 +226,30 @@ bool PixelDriver::removeChannel(int32_t channel_id) {
         }
     }
 
+    // Detach from the service task, then let any frame on the wire finish
+    const int32_t slot = (*it)->getTransmitSlot();
+    tx_slots_[slot] = nullptr;
+    for (int i = 0; i < 100 && tx_scheduler_.isBusy(slot); ++i) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    tx_scheduler_.releaseSlot(slot);
+
     channels_.erase(it);
     ESP_LOGI(TAG, "Removed channel %ld", channel_id);
     return true;
 }
 
-PixelChannel* PixelDriver::getChannel(int32_t channel_id) {
+PixelChannel* PixelPipeline::getChannel(int32_t channel_id) {
     auto it = std::find_if(channels_.begin(), channels_.end(),
         [channel_id](const auto& ch) { return ch->getId() == channel_id; });
     return (it != channels_.end()) ? it->get() : nullptr;
 }
 
-PixelChannel* PixelDriver::getMainChannel() {
+PixelChannel* PixelPipeline::getMainChannel() {
     return (main_channel_id_ != -1) ? getChannel(main_channel_id_) : nullptr;
 }
 
-std::vector<int32_t> PixelDriver::getChannelIds() {
+std::vector<int32_t> PixelPipeline::getChannelIds() {
     std::vector<int32_t> ids;
     ids.reserve(channels_.size());
     for (const auto& ch : channels_) {
@@ -134,72 +258,202 @@ std::vector<int32_t> PixelDriver::getChannelIds() {
     return ids;
 }
 
-void PixelDriver::setCurrentLimit(int32_t limit_ma) {
+void PixelPipeline::setCurrentLimit(int32_t limit_ma) {
     current_limit_ma_ = limit_ma;
     ESP_LOGI(TAG, "Current limit: %ld mA", limit_ma);
 }
 
-int32_t PixelDriver::getCurrentLimit() noexcept {
+int32_t PixelPipeline::getCurrentLimit() const noexcept {
     return current_limit_ma_;
 }
 
-void PixelDriver::setUpdateRate(uint32_t rate_hz) {
+void PixelPipeline::setUpdateRate(uint32_t rate_hz) {
     update_rate_hz_ = rate_hz;
     effect_engine_ = std::make_unique<PixelEffectEngine>(rate_hz);
 }
 
-uint32_t PixelDriver::getUpdateRate() noexcept {
+uint32_t PixelPipeline::getUpdateRate() const noexcept {
     return update_rate_hz_;
 }
 
-void PixelDriver::start() {
+void PixelPipeline::start() {
     if (running_ || !initialized_) return;
 
+    if (!frame_timer_) {
+        esp_timer_create_args_t timer_args = {};
+        timer_args.callback = frameTimerCallback;
+        timer_args.arg = this;
+        timer_args.dispatch_method = ESP_TIMER_TASK;
+        timer_args.name = "pixframe";
+        if (esp_timer_create(&timer_args, &frame_timer_) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create frame timer");
+            return;
+        }
+    }
+
     running_ = true;
-    xTaskCreate(driverTask, "pixdriver", 3072, nullptr, 7, &task_handle_);
+    createTask(driverTask, "pixdriver", 3072, config_.driver_priority, &task_handle_);
     ESP_LOGI(TAG, "PixelDriver started");
 }
 
-void PixelDriver::stop() {
+void PixelPipeline::stop() {
     if (!running_) return;
 
     running_ = false;
+    if (task_handle_ == xTaskGetCurrentTaskHandle()) return;  // The loop ends after this frame
+    // The driver task ends itself: deleted from here it could die holding show_mutex_
     if (task_handle_) {
-        vTaskDelete(task_handle_);
-        task_handle_ = nullptr;
+        xTaskNotifyGive(task_handle_);  // Cut the wait for the next frame short
+        while (task_handle_) {
+            vTaskDelay(1);
+        }
     }
     ESP_LOGI(TAG, "PixelDriver stopped");
 }
 
-bool PixelDriver::isRunning() noexcept {
+bool PixelPipeline::isRunning() const noexcept {
     return running_;
 }
 
-void PixelDriver::setAllChannelsEffect(std::string_view effect_id) {
+void PixelPipeline::setMaxStartSkew(uint32_t skew_us) noexcept {
+    max_start_skew_us_ = skew_us;
+}
+
+uint32_t PixelPipeline::getMaxStartSkew() const noexcept {
+    return max_start_skew_us_;
+}
+
+StartSkewStats PixelPipeline::getStartSkewStats() const noexcept {
+    return start_skew_;
+}
+
+void PixelPipeline::resetStartSkewStats() noexcept {
+    start_skew_ = StartSkewStats{};
+}
+
+void PixelPipeline::setUnderrunPolicy(const UnderrunPolicy& policy) noexcept {
+    underrun_policy_ = policy;
+    underrun_policy_.max_divider = std::clamp<uint8_t>(policy.max_divider, 1, 128);
+    underrun_policy_.degrade_after = std::max<uint8_t>(policy.degrade_after, 1);
+}
+
+UnderrunPolicy PixelPipeline::getUnderrunPolicy() const noexcept {
+    return underrun_policy_;
+}
+
+void PixelPipeline::setRenderSharing(bool enabled) noexcept {
+    render_sharing_ = enabled;
+}
+
+bool PixelPipeline::getRenderSharing() const noexcept {
+    return render_sharing_;
+}
+
+void PixelPipeline::setBudgetPolicy(const BudgetPolicy& policy) {
+    budget_policy_ = policy;
+    budget_policy_.degrade_after = std::max<uint16_t>(policy.degrade_after, 1);
+    budget_policy_.recover_after = std::max<uint16_t>(policy.recover_after, 1);
+    budget_policy_.low_water_pct = std::min(policy.low_water_pct, policy.high_water_pct);
+
+    // Channels beyond the new limit, or all of them when disabled, come straight back. The
+    // driver task resizes their buffers at the start of its next frame (renderFrame()).
+    const DegradeLevel limit = budget_policy_.enabled ? budget_policy_.max_level : DegradeLevel::Full;
+    for (auto& ch : channels_) {
+        if (ch->load_.level > limit) {
+            ch->load_.level = limit;
+        }
+    }
+}
+
+BudgetPolicy PixelPipeline::getBudgetPolicy() const noexcept {
+    return budget_policy_;
+}
+
+FrameBudgetStats PixelPipeline::getFrameBudgetStats() const noexcept {
+    return frame_budget_.stats();
+}
+
+void PixelPipeline::resetFrameBudgetStats() noexcept {
+    frame_budget_.reset();
+}
+
+int32_t PixelPipeline::addFramePresentedCallback(FramePresentedCallback callback) {
+    if (!initialized_ || !callback) return -1;
+
+    xSemaphoreTake(callback_mutex_, portMAX_DELAY);
+    const int32_t id = next_callback_id_++;
+    frame_callbacks_.emplace_back(id, std::move(callback));
+    callbacks_changed_ = true;
+    xSemaphoreGive(callback_mutex_);
+    return id;
+}
+
+bool PixelPipeline::removeFramePresentedCallback(int32_t callback_id) {
+    if (!initialized_) return false;
+
+    xSemaphoreTake(callback_mutex_, portMAX_DELAY);
+    auto it = std::find_if(frame_callbacks_.begin(), frame_callbacks_.end(),
+        [callback_id](const auto& entry) { return entry.first == callback_id; });
+    const bool found = it != frame_callbacks_.end();
+    if (found) {
+        frame_callbacks_.erase(it);
+        callbacks_changed_ = true;
+    }
+    xSemaphoreGive(callback_mutex_);
+
+    // A frame being presented may still call it; wait that out, unless this is that call
+    if (found && xTaskGetCurrentTaskHandle() != tx_task_handle_) {
+        xSemaphoreTake(dispatch_mutex_, portMAX_DELAY);
+        xSemaphoreGive(dispatch_mutex_);
+    }
+    return found;
+}
+
+bool PixelPipeline::waitForVsync(FrameInfo* info, uint32_t timeout_ms) {
+    if (!initialized_) return false;
+
+    const TickType_t timeout = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    const EventBits_t bits = xEventGroupWaitBits(vsync_event_, VSYNC_BIT, pdFALSE, pdTRUE, timeout);
+    if (!(bits & VSYNC_BIT)) return false;
+
+    if (info) {
+        *info = getLastFrameInfo();
+    }
+    return true;
+}
+
+FrameInfo PixelPipeline::getLastFrameInfo() noexcept {
+    portENTER_CRITICAL(&frame_lock_);
+    const FrameInfo info = last_frame_;
+    portEXIT_CRITICAL(&frame_lock_);
+    return info;
+}
+
+void PixelPipeline::setAllChannelsEffect(std::string_view effect_id) {
     for (auto& ch : channels_) {
         ch->setEffectByID(effect_id);
     }
 }
 
-void PixelDriver::setAllChannelsColor(const PixelColor& color) {
+void PixelPipeline::setAllChannelsColor(const PixelColor& color) {
     for (auto& ch : channels_) {
         ch->setColor(color);
     }
 }
 
-void PixelDriver::setAllChannelsBrightness(uint8_t brightness) {
+void PixelPipeline::setAllChannelsBrightness(uint8_t brightness) {
     for (auto& ch : channels_) {
         ch->setBrightness(brightness);
     }
 }
 
-void PixelDriver::setAllChannelsEnabled(bool enabled) {
+void PixelPipeline::setAllChannelsEnabled(bool enabled) {
     for (auto& ch : channels_) {
         ch->setEnabled(enabled);
     }
 }
 
-uint32_t PixelDriver::getTotalCurrentConsumption() {
+uint32_t PixelPipeline::getTotalCurrentConsumption() const {
     uint32_t total = 0;
     for (const auto& ch : channels_) {
         total += ch->getCurrentConsumption();
@@ -207,11 +461,11 @@ uint32_t PixelDriver::getTotalCurrentConsumption() {
     return total;
 }
 
-uint32_t PixelDriver::getScaledCurrentConsumption() {
+uint32_t PixelPipeline::getScaledCurrentConsumption() const {
     return static_cast<uint32_t>(getTotalCurrentConsumption() * getCurrentScaleFactor());
 }
 
-float PixelDriver::getCurrentScaleFactor() {
+float PixelPipeline::getCurrentScaleFactor() const {
     if (current_limit_ma_ <= 0) return 1.0f;
 
     const uint32_t total = getTotalCurrentConsumption();
@@ -224,60 +478,598 @@ float PixelDriver::getCurrentScaleFactor() {
     return static_cast<float>(available) / static_cast<float>(total);
 }
 
-void PixelDriver::driverTask(void* param) {
-    TickType_t last_wake_time = xTaskGetTickCount();
-    const TickType_t update_period = pdMS_TO_TICKS(1000 / update_rate_hz_);
-    uint32_t tick = 0;
+void PixelPipeline::renderFrame(uint32_t tick) {
+    xSemaphoreTake(show_mutex_, portMAX_DELAY);
+    if (audio_running_) {
+        // Every channel renders from the same analysis; a beat is reported to one frame
+        portENTER_CRITICAL(&audio_lock_);
+        audio_frame_ = audio_latest_;
+        audio_latest_.beat = false;
+        portEXIT_CRITICAL(&audio_lock_);
+        effect_engine_->setAudioFrame(audio_frame_);
+    }
+    // Levels lowered by setBudgetPolicy() resize buffers here, on the task that uses them
+    for (auto& ch : channels_) {
+        ch->applyDegradeLevel();
+    }
+    groupIdenticalRenders();
 
-    while (running_) {
-        // Update effects
-        for (auto& ch : channels_) {
-            if (ch->getEffectConfig().enabled) {
-                effect_engine_->updateEffect(ch.get(), tick);
-            } else {
+    // Effects, except on channels a playing show owns, that interpolate this frame or that
+    // share another channel's render
+    for (auto& ch : channels_) {
+        ch->resetCycleFrame();
+        ch->applyTimeline(tick);
+        if (!ch->activeFrame(tick) || !ch->rendersFrame(tick)) continue;
+        const int64_t start_us = esp_timer_get_time();
+        PIXTRACE_BEGIN("render", TraceLane::Driver, ch->getId());
+        if (ch->render_source_) {
+            ch->copyRender();  // The source comes earlier in channels_ and has rendered
+        } else {
+            ch->renders_++;
+            if (!ch->getEffectConfig().enabled) {
                 auto& buffer = ch->getPixelBuffer();
                 std::fill(buffer.begin(), buffer.end(), PixelColor::Black());
+            } else if (!show_player_ || !show_player_->ownsChannel(ch->getId())) {
+                effect_engine_->updateEffect(ch.get(), tick);
             }
         }
+        PIXTRACE_END("render", TraceLane::Driver, ch->getId());
+        ch->load_.add(static_cast<uint32_t>(esp_timer_get_time() - start_us));
+    }
+
+    if (show_player_) {
+        PIXTRACE_SCOPE("show", TraceLane::Driver);
+        show_player_->renderFrame(tick);
+    }
+    if (show_recorder_) {
+        show_recorder_->captureFrame();
+    }
+    for (auto& ch : channels_) {
+        if (ch->activeFrame(tick)) ch->advanceKeyframes(tick);
+    }
+
+    xSemaphoreGive(show_mutex_);
+}
+
+bool PixelPipeline::setTimeline(int32_t channel_id, PixelTimeline timeline) {
+    PixelChannel* ch = getChannel(channel_id);
+    if (!ch || timeline.empty()) return false;
 
-        // Apply current limiting and transmit
-        applyCurrentLimiting();
+    // The driver task evaluates timelines under the show mutex
+    if (show_mutex_) xSemaphoreTake(show_mutex_, portMAX_DELAY);
+    ch->timeline_ = std::move(timeline);
+    ch->timeline_position_ms_ = 0;
+    ch->timeline_restart_ = true;
+    if (show_mutex_) xSemaphoreGive(show_mutex_);
+
+    ESP_LOGI(TAG, "Channel %ld timeline: %u keys, %lu ms%s", channel_id,
+             static_cast<unsigned>(ch->timeline_.size()), ch->timeline_.durationMs(),
+             ch->timeline_.loops() ? ", looping" : "");
+    return true;
+}
 
+bool PixelPipeline::clearTimeline(int32_t channel_id) {
+    PixelChannel* ch = getChannel(channel_id);
+    if (!ch) return false;
+
+    if (show_mutex_) xSemaphoreTake(show_mutex_, portMAX_DELAY);
+    ch->timeline_.clear();
+    ch->timeline_position_ms_ = 0;
+    if (show_mutex_) xSemaphoreGive(show_mutex_);
+    return true;
+}
+
+bool PixelPipeline::setImage(int32_t channel_id, std::unique_ptr<PixelImage> image) {
+    PixelChannel* ch = getChannel(channel_id);
+    if (!ch || !image || !image->isOpen()) return false;
+
+    // Swapped between frames; the old image is freed once the mutex is released
+    if (show_mutex_) xSemaphoreTake(show_mutex_, portMAX_DELAY);
+    std::swap(ch->image_, image);
+    if (show_mutex_) xSemaphoreGive(show_mutex_);
+
+    const ImageHeader header = ch->image_->getHeader();
+    ESP_LOGI(TAG, "Channel %ld image: %u columns of %u pixels", channel_id, header.width, header.height);
+    return true;
+}
+
+bool PixelPipeline::clearImage(int32_t channel_id) {
+    PixelChannel* ch = getChannel(channel_id);
+    if (!ch) return false;
+
+    std::unique_ptr<PixelImage> image;
+    if (show_mutex_) xSemaphoreTake(show_mutex_, portMAX_DELAY);
+    std::swap(ch->image_, image);
+    if (show_mutex_) xSemaphoreGive(show_mutex_);
+    return true;
+}
+
+bool PixelPipeline::enableSync(const SyncConfig& config) {
+    if (!initialized_) return false;
+    disableSync();
+    if (sync_task_) return false;
+
+    SyncConfig node_config = config;
+    if (node_config.node_id == 0) {
+        node_config.node_id = esp_random() | 1;
+    }
+    auto node = std::make_unique<SyncNode>([] { return esp_timer_get_time(); });
+    if (!node->open(node_config, static_cast<uint16_t>(update_rate_hz_))) {
+        ESP_LOGE(TAG, "Cannot open sync socket for %s:%u", node_config.address.c_str(), node_config.port);
+        return false;
+    }
+
+    const bool follower = node_config.role == SyncRole::Follower;
+    xSemaphoreTake(sync_mutex_, portMAX_DELAY);
+    sync_ = std::move(node);
+    xSemaphoreGive(sync_mutex_);
+
+    // Above the driver task, so beacons are timestamped when they arrive
+    if (follower) {
+        sync_running_ = true;
+        if (createTask(syncTask, "pixsync", 3072, 8, &sync_task_) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create sync task");
+            disableSync();
+            return false;
+        }
+    }
+
+    ESP_LOGI(TAG, "Sync %s, group %u on %s:%u", follower ? "following" : "leading",
+             node_config.group, node_config.address.c_str(), node_config.port);
+    return true;
+}
+
+void PixelPipeline::disableSync() {
+    // receive() times out every SYNC_RECEIVE_TIMEOUT_MS, then the task sees the flag
+    sync_running_ = false;
+    for (int i = 0; i < 50 && sync_task_; ++i) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (!sync_mutex_) return;
+
+    // The frame clock keeps its learned rate (holdover)
+    xSemaphoreTake(sync_mutex_, portMAX_DELAY);
+    if (sync_task_) {
+        ESP_LOGW(TAG, "Sync task still receiving, it releases the node when it exits");
+    } else {
+        sync_.reset();
+    }
+    xSemaphoreGive(sync_mutex_);
+}
+
+bool PixelPipeline::isSyncEnabled() const noexcept {
+    return sync_ != nullptr;
+}
+
+SyncStats PixelPipeline::getSyncStats() {
+    if (!sync_mutex_) return {};
+    xSemaphoreTake(sync_mutex_, portMAX_DELAY);
+    const SyncStats stats = sync_ ? sync_->stats() : SyncStats{};
+    xSemaphoreGive(sync_mutex_);
+    return stats;
+}
+
+void PixelPipeline::syncTask(void* param) {
+    static_cast<PixelPipeline*>(param)->runSync();
+}
+
+void PixelPipeline::runSync() {
+    SyncNode* node = sync_.get();  // Not replaced while this task runs
+    while (sync_running_) {
+        node->receive(SYNC_RECEIVE_TIMEOUT_MS);
+    }
+    // disableSync() may have stopped waiting for this task; the node is released here
+    xSemaphoreTake(sync_mutex_, portMAX_DELAY);
+    sync_.reset();
+    sync_task_ = nullptr;
+    xSemaphoreGive(sync_mutex_);
+    vTaskDelete(nullptr);
+}
+
+bool PixelPipeline::enableAudio(const AudioConfig& config, AudioSource source) {
+    if (!initialized_ || !source) return false;
+    disableAudio();
+    if (audio_task_) return false;
+
+    auto analyzer = std::make_unique<AudioAnalyzer>();
+    if (!analyzer->configure(config)) {
+        ESP_LOGE(TAG, "Invalid audio config: %lu Hz, FFT %u, hop %u", config.sample_rate_hz, config.fft_size,
+                 config.hop_samples);
+        return false;
+    }
+    audio_analyzer_ = std::move(analyzer);
+    audio_source_ = std::move(source);
+    portENTER_CRITICAL(&audio_lock_);
+    audio_latest_ = {};
+    audio_frame_ = {};
+    audio_stats_ = {};
+    portEXIT_CRITICAL(&audio_lock_);
+
+    audio_running_ = true;
+    if (createTask(audioTask, "pixaudio", 4096, config.task_priority, &audio_task_) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create audio task");
+        audio_running_ = false;
+        audio_analyzer_.reset();
+        audio_source_ = nullptr;
+        return false;
+    }
+    ESP_LOGI(TAG, "Audio analysis at %lu Hz, FFT %u, %u bands", config.sample_rate_hz, config.fft_size,
+             config.band_count);
+    return true;
+}
+
+void PixelPipeline::disableAudio() {
+    // The task sees the flag once its source read returns
+    audio_running_ = false;
+    for (int i = 0; i < 50 && audio_task_; ++i) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (audio_task_) {
+        ESP_LOGW(TAG, "Audio source still blocked, keeping it until it returns");
+        return;
+    }
+    audio_analyzer_.reset();
+    audio_source_ = nullptr;
+    portENTER_CRITICAL(&audio_lock_);
+    audio_frame_ = {};
+    portEXIT_CRITICAL(&audio_lock_);
+    // Silence for SPECTRUM and BEAT, after any frame that still read the last analysis
+    if (show_mutex_) xSemaphoreTake(show_mutex_, portMAX_DELAY);
+    if (effect_engine_) effect_engine_->setAudioFrame({});
+    if (show_mutex_) xSemaphoreGive(show_mutex_);
+}
+
+bool PixelPipeline::isAudioEnabled() const noexcept {
+    return audio_running_;
+}
+
+AudioFrame PixelPipeline::getAudioFrame() noexcept {
+    portENTER_CRITICAL(&audio_lock_);
+    const AudioFrame frame = audio_frame_;
+    portEXIT_CRITICAL(&audio_lock_);
+    return frame;
+}
+
+AudioStats PixelPipeline::getAudioStats() noexcept {
+    portENTER_CRITICAL(&audio_lock_);
+    const AudioStats stats = audio_stats_;
+    portEXIT_CRITICAL(&audio_lock_);
+    return stats;
+}
+
+void PixelPipeline::audioTask(void* param) {
+    static_cast<PixelPipeline*>(param)->runAudio();
+}
+
+void PixelPipeline::runAudio() {
+    AudioAnalyzer* analyzer = audio_analyzer_.get();
+    std::vector<int16_t> pcm(analyzer->config().hop_samples);
+    const uint32_t cycles_per_us = esp_rom_get_cpu_ticks_per_us();
+    uint64_t total_us = 0;
+    while (audio_running_) {
+        const size_t count = audio_source_(pcm.data(), pcm.size());
+        if (count == 0) {
+            portENTER_CRITICAL(&audio_lock_);
+            audio_stats_.read_errors++;
+            portEXIT_CRITICAL(&audio_lock_);
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+
+        const int64_t start_us = esp_timer_get_time();
+        const size_t blocks = analyzer->push(pcm.data(), std::min(count, pcm.size()));
+        if (blocks == 0) continue;
+        const auto us = static_cast<uint32_t>((esp_timer_get_time() - start_us) / static_cast<int64_t>(blocks));
+        total_us += us * blocks;
+
+        portENTER_CRITICAL(&audio_lock_);
+        const bool beat = audio_latest_.beat;
+        audio_latest_ = analyzer->frame();
+        audio_latest_.beat = audio_latest_.beat || beat;  // Held until a frame takes it
+        audio_stats_.blocks += blocks;
+        audio_stats_.mean_us_per_block = static_cast<uint32_t>(total_us / audio_stats_.blocks);
+        audio_stats_.mean_cycles_per_block = audio_stats_.mean_us_per_block * cycles_per_us;
+        audio_stats_.max_cycles_per_block = std::max(audio_stats_.max_cycles_per_block, us * cycles_per_us);
+        portEXIT_CRITICAL(&audio_lock_);
+    }
+    audio_task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void PixelPipeline::groupIdenticalRenders() {
+    const auto owned = [this](const PixelChannel& ch) {
+        return show_player_ && show_player_->ownsChannel(ch.getId());
+    };
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        PixelChannel& ch = *channels_[i];
+        ch.render_source_ = nullptr;
+        ch.encoded_ = false;
+        if (!render_sharing_ || owned(ch)) continue;
+
+        // The first matching channel renders for the group
+        for (size_t j = 0; j < i; ++j) {
+            PixelChannel& source = *channels_[j];
+            if (!source.render_source_ && !owned(source) && ch.rendersSameAs(source)) {
+                ch.render_source_ = &source;
+                break;
+            }
+        }
+    }
+}
+
+void PixelPipeline::setShowPlayer(PixelShowPlayer* player) {
+    if (show_mutex_) xSemaphoreTake(show_mutex_, portMAX_DELAY);
+    show_player_ = player;
+    if (show_mutex_) xSemaphoreGive(show_mutex_);
+}
+
+void PixelPipeline::clearShowPlayer(const PixelShowPlayer* player) {
+    if (show_mutex_) xSemaphoreTake(show_mutex_, portMAX_DELAY);
+    if (show_player_ == player) show_player_ = nullptr;
+    if (show_mutex_) xSemaphoreGive(show_mutex_);
+}
+
+void PixelPipeline::setShowRecorder(PixelShowRecorder* recorder) {
+    if (show_mutex_) xSemaphoreTake(show_mutex_, portMAX_DELAY);
+    show_recorder_ = recorder;
+    if (show_mutex_) xSemaphoreGive(show_mutex_);
+}
+
+void PixelPipeline::clearShowRecorder(const PixelShowRecorder* recorder) {
+    if (show_mutex_) xSemaphoreTake(show_mutex_, portMAX_DELAY);
+    if (show_recorder_ == recorder) show_recorder_ = nullptr;
+    if (show_mutex_) xSemaphoreGive(show_mutex_);
+}
+
+void PixelPipeline::frameTimerCallback(void* arg) {
+    auto* self = static_cast<PixelPipeline*>(arg);
+    if (self->task_handle_) {
+        xTaskNotifyGive(self->task_handle_);
+    }
+}
+
+void PixelPipeline::driverTask(void* param) {
+    static_cast<PixelPipeline*>(param)->runDriver();
+}
+
+void PixelPipeline::transmitTask(void* param) {
+    static_cast<PixelPipeline*>(param)->runTransmit();
+}
+
+void PixelPipeline::runDriver() {
+    // Frames start on a microsecond schedule rather than on RTOS ticks, so the rate is exact
+    // and a sync follower can slew it by fractions of a frame
+    frame_clock_.start(esp_timer_get_time(), update_rate_hz_);
+
+    while (running_) {
+        const uint32_t tick = frame_clock_.frame();
+        const int64_t work_start_us = esp_timer_get_time();
+        PIXTRACE_BEGIN("frame", TraceLane::Driver);
+        renderFrame(tick);
+
+        // Apply current limiting, encode and hand frames to the service task
+        applyCurrentLimiting(tick);
+
+        bool submitted = false;
         for (auto& ch : channels_) {
+            const int32_t slot = ch->getTransmitSlot();
+            if (tx_scheduler_.isBusy(slot)) continue;  // Previous frame still on the wire
+            if (!ch->shouldTransmit(tick)) continue;   // Rate degraded after repeated errors
+            if (!ch->activeFrame(tick)) continue;      // Rate halved to fit the frame budget
+            if (!ch->transportIdle()) continue;        // Aborted transfer not collected yet
+            const int64_t start_us = esp_timer_get_time();
+            PIXTRACE_BEGIN("encode", TraceLane::Driver, ch->getId());
             ch->transmit();
+            PIXTRACE_END("encode", TraceLane::Driver, ch->getId());
+            ch->encoded_ = true;
+            ch->load_.add(static_cast<uint32_t>(esp_timer_get_time() - start_us));
+            submitted |= tx_scheduler_.submit(slot);
+        }
+        if (submitted) {
+            PIXTRACE_INSTANT("kick", TraceLane::Driver);
+            xTaskNotify(tx_task_handle_, TransmitScheduler::KICK_BIT, eSetBits);
+        }
+        balanceLoad(static_cast<uint32_t>(esp_timer_get_time() - work_start_us));
+        PIXTRACE_END("frame", TraceLane::Driver);
+
+        // Leader sends its beacon, a follower applies the newest one; never stall for it
+        if (sync_ && xSemaphoreTake(sync_mutex_, 0) == pdTRUE) {
+            if (sync_) sync_->onFrame(frame_clock_);
+            xSemaphoreGive(sync_mutex_);
         }
 
-        tick++;
-        vTaskDelayUntil(&last_wake_time, update_period);
+        frame_clock_.advance(esp_timer_get_time());
+        const int64_t wait_us = frame_clock_.frameStartUs() - esp_timer_get_time();
+        if (wait_us > 0 && esp_timer_start_once(frame_timer_, wait_us) == ESP_OK) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
     }
 
+    // Only this task arms the timer. It goes before the task does, so its callback
+    // never notifies a freed task.
+    esp_timer_stop(frame_timer_);
+    esp_timer_delete(frame_timer_);
+    frame_timer_ = nullptr;
+    task_handle_ = nullptr;  // stop() waits for this
     vTaskDelete(nullptr);
 }
 
-void PixelDriver::applyCurrentLimiting() {
+void PixelPipeline::runTransmit() {
+    uint32_t bits = 0;
+
+    while (true) {
+        const TickType_t wait = tx_scheduler_.inFlight()
+            ? pdMS_TO_TICKS(TX_DEADLINE_POLL_MS) : portMAX_DELAY;
+        if (xTaskNotifyWait(0, UINT32_MAX, &bits, wait) != pdTRUE) {
+            bits = 0;
+        }
+
+        // Progress from the transport interrupts: refill queues and retire finished frames
+        forEachSlot(bits & tx_scheduler_.inFlight(), [this](int32_t slot) {
+            PixelChannel* ch = tx_slots_[slot];
+            if (!ch) {
+                retireSlot(slot, esp_timer_get_time());
+            } else if (ch->serviceTransmit() && !ch->finishTransmit(false, underrun_policy_)) {
+                retireSlot(slot, ch->doneTimeUs());
+            }
+        });
+
+        // Frames that never finished: stop the DMA and count a timeout
+        const int64_t now_us = esp_timer_get_time();
+        forEachSlot(tx_scheduler_.inFlight(), [this, now_us](int32_t slot) {
+            PixelChannel* ch = tx_slots_[slot];
+            if (ch && !ch->pastDeadline(now_us)) return;
+            if (ch) {
+                ESP_LOGW(TAG, "Transmit timed out on channel %ld", ch->getId());
+                ch->abortTransmit();
+                if (ch->finishTransmit(true, underrun_policy_)) return;
+            }
+            retireSlot(slot, now_us);
+        });
+
+        // New frames from the driver task
+        if (bits & TransmitScheduler::KICK_BIT) {
+            startFrame(tx_scheduler_.takeSubmitted());
+        }
+    }
+}
+
+void PixelPipeline::startFrame(uint32_t submitted) {
+    PIXTRACE_SCOPE("start frame", TraceLane::Transmit);
+    // Barrier: stage every frame in DMA memory first so the enables below run
+    // back to back with nothing but the timestamp between them
+    std::array<PixelChannel*, TransmitScheduler::MAX_SLOTS> staged{};
+    uint32_t ready = 0;
+    forEachSlot(submitted, [&](int32_t slot) {
+        PixelChannel* ch = tx_slots_[slot];
+        if (ch && ch->prepareTransmit()) {
+            staged[slot] = ch;
+            ready |= TransmitScheduler::bit(slot);
+        } else {
+            tx_scheduler_.complete(slot);
+        }
+    });
+
+    int64_t first_start_us = -1;
+    int64_t last_start_us = -1;
+    forEachSlot(ready, [&](int32_t slot) {
+        if (!staged[slot]->startTransmit()) {
+            ready &= ~TransmitScheduler::bit(slot);
+            tx_scheduler_.complete(slot);
+            return;
+        }
+        last_start_us = esp_timer_get_time();
+        if (first_start_us < 0) first_start_us = last_start_us;
+    });
+
+    // Queue whatever did not fit in the preload only after every channel is running
+    forEachSlot(ready, [&](int32_t slot) {
+        staged[slot]->refillTransmit();
+    });
+
+    if (!ready) return;
+
+    const uint32_t skew_us = static_cast<uint32_t>(last_start_us - first_start_us);
+    if (ready & (ready - 1)) {
+        start_skew_.record(skew_us, max_start_skew_us_);
+    }
+    present_tracker_.begin(ready, skew_us);
+}
+
+void PixelPipeline::retireSlot(int32_t slot, int64_t done_time_us) {
+    tx_scheduler_.complete(slot);
+
+    FrameInfo info;
+    if (present_tracker_.retire(slot, done_time_us, info)) {
+        presentFrame(info);
+    }
+}
+
+void PixelPipeline::presentFrame(const FrameInfo& info) {
+    PIXTRACE_SCOPE("present", TraceLane::Transmit);
+    portENTER_CRITICAL(&frame_lock_);
+    last_frame_ = info;
+    portEXIT_CRITICAL(&frame_lock_);
+
+    // Set-then-clear releases every task blocked in waitForVsync() exactly once
+    xEventGroupSetBits(vsync_event_, VSYNC_BIT);
+    xEventGroupClearBits(vsync_event_, VSYNC_BIT);
+
+    // Callbacks run from a copy, outside callback_mutex_, so they can add or remove
+    // callbacks themselves; the copy is refreshed only when the list changed
+    xSemaphoreTake(dispatch_mutex_, portMAX_DELAY);
+    xSemaphoreTake(callback_mutex_, portMAX_DELAY);
+    if (callbacks_changed_) {
+        dispatch_callbacks_ = frame_callbacks_;
+        callbacks_changed_ = false;
+    }
+    xSemaphoreGive(callback_mutex_);
+    for (const auto& [id, callback] : dispatch_callbacks_) {
+        callback(info);
+    }
+    xSemaphoreGive(dispatch_mutex_);
+}
+
+void PixelPipeline::applyCurrentLimiting(uint32_t tick) {
+    // Channels sitting out this frame still draw current, so they count towards the scale
     const float scale = getCurrentScaleFactor();
     for (auto& ch : channels_) {
+        if (!ch->activeFrame(tick)) continue;
+        const int64_t start_us = esp_timer_get_time();
+        PIXTRACE_BEGIN("limit", TraceLane::Driver, ch->getId());
         ch->applyCurrentScaling(scale);
+        PIXTRACE_END("limit", TraceLane::Driver, ch->getId());
+        ch->load_.add(static_cast<uint32_t>(esp_timer_get_time() - start_us));
     }
 }
 
+void PixelPipeline::balanceLoad(uint32_t work_us) {
+    std::array<ChannelLoad*, TransmitScheduler::MAX_SLOTS> loads{};
+    size_t count = 0;
+    for (auto& ch : channels_) {
+        ch->load_.endFrame();
+        if (count < loads.size()) loads[count++] = &ch->load_;
+    }
+
+    const uint32_t budget_us = 1000000 / std::max<uint32_t>(update_rate_hz_, 1);
+    const FrameBudget::Action action = frame_budget_.record(work_us, budget_us, budget_policy_);
+    if (action == FrameBudget::Action::Hold) return;
+
+    const int32_t index = frame_budget_.apply(action, loads.data(), count, budget_policy_);
+    if (index < 0) return;
+    PixelChannel& ch = *channels_[index];
+    ch.applyDegradeLevel();
+    ESP_LOGW(TAG, "Channel %ld %s to %s (frame work %lu of %lu us)", ch.getId(),
+             action == FrameBudget::Action::Degrade ? "degraded" : "restored",
+             degradeLevelName(ch.getDegradeLevel()), frame_budget_.stats().work_us, budget_us);
+}
+
 // ============= PixelChannel Implementation =============
 
 PixelChannel::PixelChannel(int32_t id, const ChannelConfig& config)
     : id_(id)
-    , config_(config)
-    , initialized_(false)
-    , terminate_task_(false)
-    , bytes_sent_(0) {
-
-    // Pre-allocate all buffers
-    pixel_buffer_.resize(config.pixel_count, PixelColor::Black());
+    , config_(withWireOrder(config))
+    , cycle_cache_(config.cycle_cache_bytes)
+    , transport_(PixelTransport::create(id, config_))
+    , initialized_(false) {
+
+    // Pre-allocate all buffers; the transport sizes its own wire-format buffer. Effects
+    // render into pixel_buffer_ at render resolution.
+    downsample_ = std::max<uint8_t>(config.render_downsample, 1);
+    load_.priority = config.priority;
+    load_.even_renders = config.render_divider > 1 && config.render_divider % 2 == 0;
+    pixel_buffer_.resize((config.pixel_count + downsample_ - 1) / downsample_, PixelColor::Black());
     scaled_buffer_.resize(config.pixel_count, PixelColor::Black());
-
-    const size_t bytes_per_pixel = (config.format == PixelFormat::RGBW)
-        ? WS2812B_BYTES_PER_RGBW : WS2812B_BYTES_PER_RGB;
-    const size_t buffer_size = (config.pixel_count * bytes_per_pixel) + WS2812B_RESET_BYTES;
-    i2s_buffer_.resize(buffer_size, 0);
+    output_map_ = config.transform.compile(config.pixel_count);
+    output_map_hash_ = outputMapHash(output_map_);
+    if (output_map_.empty() && !config.transform.identity()) {
+        ESP_LOGW(TAG, "Channel %ld: output transform ignored, index map must have %u entries",
+                 id, config.pixel_count);
+    }
+    if (config.color_depth == ColorDepth::Bits16) {
+        pixel_buffer16_.resize(config.pixel_count);
+        scaled_buffer16_.resize(config.pixel_count);
+    }
 
     // Default effect
     effect_config_.effect = "SOLID";
@@ -291,33 +1083,18 @@ PixelChannel::~PixelChannel() {
     cleanup();
 }
 
-bool PixelChannel::initialize() {
-    if (initialized_) return true;
-
-    transmit_semaphore_ = xSemaphoreCreateBinary();
-    complete_semaphore_ = xSemaphoreCreateBinary();
-
-    if (!transmit_semaphore_ || !complete_semaphore_) {
-        ESP_LOGE(TAG, "Failed to create semaphores for channel %ld", id_);
-        cleanup();
-        return false;
-    }
-
-    setupI2S();
-
-    if (!i2s_channel_) {
-        ESP_LOGE(TAG, "Failed to setup I2S for channel %ld", id_);
-        cleanup();
-        return false;
-    }
+// A channel built outside addChannel() takes its rate and NVS namespace from PixelDriver
+const PixelPipeline& PixelChannel::owner() const noexcept {
+    return owner_ ? *owner_ : PixelDriver::pipeline();
+}
 
-    char task_name[16];
-    snprintf(task_name, sizeof(task_name), "i2s_%ld", id_);
+bool PixelChannel::initialize(int32_t tx_slot, TaskHandle_t tx_task) {
+    if (initialized_) return true;
 
-    if (xTaskCreate(i2sTaskWrapper, task_name, 3072, this,
-                    configMAX_PRIORITIES - 1, &i2s_task_handle_) != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create I2S task for channel %ld", id_);
-        cleanup();
+    tx_slot_ = tx_slot;
+    if (!transport_ || !transport_->initialize(tx_task, tx_slot)) {
+        ESP_LOGE(TAG, "Failed to set up output for channel %ld", id_);
+        transport_.reset();
         return false;
     }
 
@@ -328,6 +1105,7 @@ bool PixelChannel::initialize() {
 
 void PixelChannel::setEffect(const EffectConfig& config) {
     effect_config_ = config;
+    effectChanged();
     if (!config.mask.empty() && config.mask.size() == config_.pixel_count) {
         setMask(config.mask);
     }
@@ -335,14 +1113,17 @@ void PixelChannel::setEffect(const EffectConfig& config) {
 
 void PixelChannel::setEffectByID(std::string_view effect_id) {
     effect_config_.effect = std::string(effect_id);
+    effectChanged();
 }
 
 void PixelChannel::setColor(const PixelColor& color) noexcept {
     effect_config_.color = color;
+    effectChanged();
 }
 
 void PixelChannel::setBrightness(uint8_t brightness) noexcept {
     effect_config_.brightness = brightness;
+    effectChanged();
 }
 
 void PixelChannel::setSpeed(uint8_t speed) noexcept {
@@ -360,181 +1141,450 @@ void PixelChannel::setMask(const std::vector<uint8_t>& mask) {
         effect_config_.mask.resize(config_.pixel_count);
     }
     std::copy(mask.begin(), mask.end(), effect_config_.mask.begin());
+    effectChanged();
 }
 
 void PixelChannel::clearMask() noexcept {
     effect_config_.mask.clear();
+    effectChanged();
 }
 
-void PixelChannel::setupI2S() {
-    i2s_chan_config_t chan_config = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_AUTO, I2S_ROLE_MASTER);
-
-    i2s_std_config_t std_config = {
-        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(WS2812B_BITRATE / 16 / 2),
-        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO),
-        .gpio_cfg = {
-            .mclk = I2S_GPIO_UNUSED,
-            .bclk = I2S_GPIO_UNUSED,
-            .ws = I2S_GPIO_UNUSED,
-            .dout = config_.pin,
-            .din = I2S_GPIO_UNUSED,
-            .invert_flags = { .mclk_inv = false, .bclk_inv = false, .ws_inv = false },
-        },
-    };
+void PixelChannel::cleanup() {
+    transport_.reset();
+    initialized_ = false;
+}
+
+void PixelChannel::transmit() {
+    if (!initialized_) return;
 
-    esp_err_t ret = i2s_new_channel(&chan_config, &i2s_channel_, nullptr);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create I2S channel: %s", esp_err_to_name(ret));
+    if (cycle_hit_) {
+        transport_->loadEncodedFrame({cycle_cache_.frame(cycle_position_), cycle_cache_.frameBytes()});
+        cycle_cache_.recordHit();
         return;
     }
 
-    ret = i2s_channel_init_std_mode(i2s_channel_, &std_config);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to init I2S: %s", esp_err_to_name(ret));
-        i2s_del_channel(i2s_channel_);
-        i2s_channel_ = nullptr;
-        return;
+    // Sharing the source's render and its encoding: send its wire data. Dithered frames
+    // report no encoded frame and are encoded here.
+    if (render_source_ && render_source_->encoded_ && encodesSameAs(*render_source_)) {
+        const std::span<const uint8_t> frame = render_source_->transport_->encodedFrame();
+        if (!frame.empty() && frame.size() == transport_->encodedFrame().size()) {
+            transport_->loadEncodedFrame(frame);
+            ++shared_frames_;
+            return;
+        }
     }
 
-    i2s_event_callbacks_t callbacks = {
-        .on_recv = nullptr,
-        .on_recv_q_ovf = nullptr,
-        .on_sent = i2s_tx_callback,
-        .on_send_q_ovf = nullptr,
-    };
+    if (config_.color_depth != ColorDepth::Bits16 && interpolating()) {
+        transport_->encodeLerp(key_from_, key_to_, lerp_weight_, output_scale_);
+    } else if (config_.color_depth != ColorDepth::Bits16) {
+        transport_->encode(scaled_buffer_, output_scale_);
+    } else if (transport_->encodes16()) {
+        transport_->encode16(scaled_buffer16_, output_scale_);
+    } else {
+        ditherSpan16(scaled_buffer16_.data(), scaled_buffer_.data(), scaled_buffer16_.size());
+        transport_->encode(scaled_buffer_, output_scale_);
+    }
 
-    ret = i2s_channel_register_event_callback(i2s_channel_, &callbacks, this);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to register I2S callbacks: %s", esp_err_to_name(ret));
-        i2s_del_channel(i2s_channel_);
-        i2s_channel_ = nullptr;
+    // First time through this cycle position: keep it for the next time around
+    if (cycle_position_ != CycleCache::NO_POSITION) {
+        const std::span<const uint8_t> frame = transport_->encodedFrame();
+        if (!frame.empty() && frame.size() == cycle_cache_.frameBytes()) {
+            cycle_cache_.store(cycle_position_, cycle_scale_, pixel_buffer_.data(), frame.data(),
+                               getCurrentConsumption());
+        }
     }
 }
 
-void PixelChannel::cleanup() {
-    if (!initialized_) return;
+bool PixelChannel::restoreCycleFrame(uint16_t position, uint16_t period) {
+    // Interpolated output is not a function of the cycle position alone
+    if (config_.cycle_cache_bytes == 0 || config_.render_divider > 1 || !initialized_) return false;
 
-    terminate_task_ = true;
-    if (transmit_semaphore_) {
-        xSemaphoreGive(transmit_semaphore_);
+    const size_t frame_bytes = transport_->encodedFrame().size();
+    if (frame_bytes == 0 ||
+        !cycle_cache_.configure(period, pixel_buffer_.size(), frame_bytes, effect_generation_)) {
+        return false;
     }
 
-    if (i2s_task_handle_) {
-        for (int i = 0; i < 100 && terminate_task_; ++i) {
-            vTaskDelay(pdMS_TO_TICKS(10));
-        }
-        if (terminate_task_) {
-            ESP_LOGW(TAG, "I2S task did not terminate gracefully");
-            vTaskDelete(i2s_task_handle_);
-        }
-        i2s_task_handle_ = nullptr;
+    cycle_position_ = position % period;
+    if (!cycle_cache_.contains(cycle_position_)) return false;
+
+    // The pixels come back too: show recording, current limiting and a scale change that
+    // forces a re-encode all still see the real frame
+    const PixelColor* pixels = cycle_cache_.pixels(cycle_position_);
+    std::copy(pixels, pixels + pixel_buffer_.size(), pixel_buffer_.begin());
+    cycle_hit_ = true;
+    return true;
+}
+
+void PixelChannel::resetCycleFrame() noexcept {
+    cycle_position_ = CycleCache::NO_POSITION;
+    cycle_hit_ = false;
+}
+
+bool PixelChannel::prepareTransmit() {
+    return initialized_ && transport_->prepare();
+}
+
+bool PixelChannel::startTransmit() {
+    if (!transport_->start()) return false;
+    PIXTRACE_BEGIN("dma", TraceLane::Dma, id_);
+
+    // Twice the nominal wire time leaves room for refill latency before calling it a timeout
+    deadline_us_ = esp_timer_get_time() + 2 * transport_->wireTimeUs() + TX_DEADLINE_SLACK_US;
+    return true;
+}
+
+bool PixelChannel::finishTransmit(bool timed_out, const UnderrunPolicy& policy) {
+    PIXTRACE_END_AT(timed_out ? esp_timer_get_time() : transport_->doneTimeUs(), "dma", TraceLane::Dma, id_);
+    const uint8_t events = transport_->events() | (timed_out ? TransmitHealth::EVENT_TIMEOUT : 0);
+    if (!tx_health_.record(events, resending_, policy)) {
+        resending_ = false;
+        return false;
     }
 
-    if (i2s_channel_) {
-        i2s_del_channel(i2s_channel_);
-        i2s_channel_ = nullptr;
+    // The encode buffer is untouched while the slot is in flight, so it still holds
+    // the complete frame: put it on the wire again
+    ESP_LOGD(TAG, "Resending frame on channel %ld (events 0x%x)", id_, events);
+    resending_ = true;
+    if (!prepareTransmit() || !startTransmit()) {
+        resending_ = false;
+        return false;
     }
+    refillTransmit();
+    return true;
+}
 
-    if (transmit_semaphore_) {
-        vSemaphoreDelete(transmit_semaphore_);
-        transmit_semaphore_ = nullptr;
+uint32_t PixelChannel::getCurrentConsumption() const noexcept {
+    if (render_source_) {
+        return render_source_->getCurrentConsumption();
     }
-    if (complete_semaphore_) {
-        vSemaphoreDelete(complete_semaphore_);
-        complete_semaphore_ = nullptr;
+    if (cycle_hit_) {
+        return cycle_cache_.currentMa(cycle_position_);
+    }
+    if (interpolating()) {
+        return key_current_ma_;
     }
 
-    initialized_ = false;
-    terminate_task_ = false;
-}
+    uint32_t total_ma = 0;
 
-void PixelChannel::convertToI2SBuffer(const std::vector<PixelColor>& pixels) {
-    const size_t bytes_per_pixel = (config_.format == PixelFormat::RGBW)
-        ? WS2812B_BYTES_PER_RGBW : WS2812B_BYTES_PER_RGB;
-    const size_t data_size = pixels.size() * bytes_per_pixel;
+    if (rendersRaw16()) {
+        for (const auto& pixel : pixel_buffer16_) {
+            total_ma += (pixel.r * PixelPipeline::CURRENT_PER_CHANNEL_MA) / 65535;
+            total_ma += (pixel.g * PixelPipeline::CURRENT_PER_CHANNEL_MA) / 65535;
+            total_ma += (pixel.b * PixelPipeline::CURRENT_PER_CHANNEL_MA) / 65535;
+            if (config_.format == PixelFormat::RGBW) {
+                total_ma += (pixel.w * PixelPipeline::CURRENT_PER_CHANNEL_MA) / 65535;
+            }
+        }
+        return total_ma;
+    }
 
-    // Clear reset bytes
-    std::fill(i2s_buffer_.begin() + data_size, i2s_buffer_.end(), 0);
+    // Each sample stands for downsample_ output pixels
+    const uint32_t render_ma = frameCurrentMa(pixel_buffer_, config_.format == PixelFormat::RGBW);
+    if (!downsampled()) return render_ma;
+    return static_cast<uint32_t>(static_cast<uint64_t>(render_ma) * config_.pixel_count /
+                                 std::max<size_t>(pixel_buffer_.size(), 1));
+}
 
-    for (size_t i = 0; i < pixels.size(); ++i) {
-        const auto& pixel = pixels[i];
-        const size_t base_idx = i * bytes_per_pixel;
+bool PixelChannel::rendersSameAs(const PixelChannel& other) const noexcept {
+    const ChannelConfig& a = config_;
+    const ChannelConfig& b = other.config_;
+    if (a.pixel_count != b.pixel_count || a.format != b.format || a.color_depth != b.color_depth ||
+        a.gamma_correct != b.gamma_correct || a.render_divider != b.render_divider ||
+        downsample_ != other.downsample_) {
+        return false;
+    }
+    // Both must render on the same frames
+    if (load_.level != other.load_.level || load_.parity != other.load_.parity) return false;
+
+    // Custom callbacks, timelines, images and RAW16 content cannot be compared
+    const EffectConfig& ea = effect_config_;
+    const EffectConfig& eb = other.effect_config_;
+    if (ea.custom_effect || eb.custom_effect || hasTimeline() || other.hasTimeline() ||
+        hasImage() || other.hasImage() || rendersRaw16() || other.rendersRaw16()) {
+        return false;
+    }
+    return ea.effect == eb.effect && ea.color == eb.color && ea.brightness == eb.brightness &&
+           ea.speed == eb.speed && ea.enabled == eb.enabled && ea.mask == eb.mask;
+}
 
-        // Apply mask
-        const bool masked = effect_config_.mask.empty() ||
-            (i < effect_config_.mask.size() && effect_config_.mask[i]);
+bool PixelChannel::encodesSameAs(const PixelChannel& other) const noexcept {
+    const ChannelConfig& a = config_;
+    const ChannelConfig& b = other.config_;
+    return a.bus == b.bus && a.chipset == b.chipset && a.color_order == b.color_order &&
+           a.clocked_chipset == b.clocked_chipset && a.resolution_hz == b.resolution_hz &&
+           output_map_hash_ == other.output_map_hash_;
+}
 
-        const uint8_t g = masked ? pixel.g : 0;
-        const uint8_t r = masked ? pixel.r : 0;
-        const uint8_t b = masked ? pixel.b : 0;
-        const uint8_t w = masked ? pixel.w : 0;
+void PixelChannel::copyRender() {
+    std::copy(render_source_->pixel_buffer_.begin(), render_source_->pixel_buffer_.end(), pixel_buffer_.begin());
+}
 
-        // GRB order for WS2812
-        const uint8_t* g_seq = ws2812b_color_lookup[g];
-        const uint8_t* r_seq = ws2812b_color_lookup[r];
-        const uint8_t* b_seq = ws2812b_color_lookup[b];
+void PixelChannel::applyDegradeLevel() {
+    const uint32_t base = std::max<uint8_t>(config_.render_downsample, 1);
+    const uint32_t factor = load_.level >= DegradeLevel::HalfResolution ? base * 2 : base;
+    const auto downsample = static_cast<uint8_t>(std::min<uint32_t>(factor, UINT8_MAX));
+    if (downsample == downsample_) return;
 
-        for (int j = 0; j < WS2812B_BYTES_PER_COLOR; ++j) {
-            i2s_buffer_[(base_idx + j) ^ 1] = g_seq[j];
-            i2s_buffer_[(base_idx + WS2812B_BYTES_PER_COLOR + j) ^ 1] = r_seq[j];
-            i2s_buffer_[(base_idx + 2 * WS2812B_BYTES_PER_COLOR + j) ^ 1] = b_seq[j];
-        }
+    // Effects pick the new size up from the buffer; cached frames are the wrong size now
+    downsample_ = downsample;
+    pixel_buffer_.assign((config_.pixel_count + downsample_ - 1) / downsample_, PixelColor::Black());
+    effectChanged();
+}
 
-        if (config_.format == PixelFormat::RGBW) {
-            const uint8_t* w_seq = ws2812b_color_lookup[w];
-            for (int j = 0; j < WS2812B_BYTES_PER_COLOR; ++j) {
-                i2s_buffer_[(base_idx + 3 * WS2812B_BYTES_PER_COLOR + j) ^ 1] = w_seq[j];
-            }
-        }
+void PixelChannel::upsample(std::vector<PixelColor>& out, uint16_t scale) const noexcept {
+    out.resize(config_.pixel_count);
+    if (output_map_.empty()) {
+        upsampleSpan(pixel_buffer_.data(), pixel_buffer_.size(), downsample_, scale, out.data(), out.size());
+        return;
     }
+    const uint32_t s = static_cast<uint32_t>(scale) + 1;
+    upsampleGather(pixel_buffer_.data(), pixel_buffer_.size(), downsample_, output_map_.data(), out.size(),
+                   [&](size_t i, const PixelColor& a, const PixelColor& b, uint32_t inv, uint32_t w) {
+        const auto lerp = [&](uint8_t x, uint8_t y) {
+            return static_cast<uint8_t>(((x * inv + y * w) * s) >> 24);
+        };
+        out[i] = PixelColor(lerp(a.r, b.r), lerp(a.g, b.g), lerp(a.b, b.b), lerp(a.w, b.w));
+    }, [&](size_t i) { out[i] = PixelColor::Black(); });
 }
 
-void PixelChannel::transmit() {
-    if (!initialized_) return;
+uint32_t PixelChannel::getRefreshRate() const noexcept {
+    return owner().getUpdateRate() / tx_health_.stats().frame_divider;
+}
 
-    convertToI2SBuffer(scaled_buffer_);
+uint32_t PixelChannel::getRenderRate() const noexcept {
+    return owner().getUpdateRate() / std::max<uint8_t>(config_.render_divider, 1);
+}
 
-    if (transmit_semaphore_) {
-        xSemaphoreGive(transmit_semaphore_);
+void PixelChannel::advanceKeyframes(uint32_t tick) {
+    const uint32_t divider = config_.render_divider;
+    if (divider <= 1 || rendersRaw16()) {
+        key_from_.clear();
+        key_to_.clear();
+        return;
     }
-}
 
-uint32_t PixelChannel::getCurrentConsumption() const noexcept {
-    uint32_t total_ma = 0;
+    // Output lags the newest render by up to one render period: the frame that renders
+    // it starts the move towards it and the last frame before the next render reaches it
+    const uint32_t phase = tick % divider;
+    lerp_weight_ = static_cast<uint16_t>((phase + 1) * 256 / divider);
+    if (phase != 0 && !key_to_.empty()) return;
+
+    const bool first = key_to_.empty();
+    key_from_.swap(key_to_);
+    if (downsampled()) {
+        upsample(key_to_, UINT16_MAX);
+    } else if (!output_map_.empty()) {
+        key_to_.resize(config_.pixel_count);
+        gatherSpan(pixel_buffer_.data(), output_map_.data(), key_to_.data(), key_to_.size(),
+                   [](const PixelColor& c) { return c; });
+    } else {
+        key_to_.assign(pixel_buffer_.begin(), pixel_buffer_.end());
+    }
 
-    for (const auto& pixel : pixel_buffer_) {
-        total_ma += (pixel.r * PixelDriver::CURRENT_PER_CHANNEL_MA) / 255;
-        total_ma += (pixel.g * PixelDriver::CURRENT_PER_CHANNEL_MA) / 255;
-        total_ma += (pixel.b * PixelDriver::CURRENT_PER_CHANNEL_MA) / 255;
-        if (config_.format == PixelFormat::RGBW) {
-            total_ma += (pixel.w * PixelDriver::CURRENT_PER_CHANNEL_MA) / 255;
+    // Keyframes are in output order and masked before interpolating, so the encoder never
+    // looks at the transform or the mask
+    const auto& mask = effect_config_.mask;
+    if (!mask.empty()) {
+        for (size_t i = 0; i < key_to_.size(); ++i) {
+            if (i >= mask.size() || !mask[i]) key_to_[i] = PixelColor::Black();
         }
     }
+    if (first) {
+        key_from_ = key_to_;  // Nothing to move from yet
+    }
+    const bool rgbw = config_.format == PixelFormat::RGBW;
+    key_current_ma_ = std::max(frameCurrentMa(key_from_, rgbw), frameCurrentMa(key_to_, rgbw));
+}
 
-    return total_ma;
+void PixelChannel::applyTimeline(uint32_t tick) {
+    if (timeline_.empty()) return;
+    if (timeline_restart_) {
+        timeline_start_ = tick;
+        timeline_restart_ = false;
+    }
+
+    // Timed in frames, so followers of a sync leader stay in step with it
+    const uint32_t rate_hz = std::max<uint32_t>(owner().getUpdateRate(), 1);
+    const auto time_ms = static_cast<uint32_t>(static_cast<uint64_t>(tick - timeline_start_) * 1000 / rate_hz);
+    timeline_.evaluate(time_ms);
+    timeline_position_ms_ = timeline_.position(time_ms);
+
+    // Only actual changes count, so a held value keeps the cycle cache
+    if (timeline_.hasTrack(TimelineParam::Brightness)) {
+        const uint8_t brightness = timeline_.value(TimelineParam::Brightness).r;
+        if (brightness != effect_config_.brightness) setBrightness(brightness);
+    }
+    if (timeline_.hasTrack(TimelineParam::Speed)) {
+        setSpeed(timeline_.value(TimelineParam::Speed).r);
+    }
+    if (timeline_.hasTrack(TimelineParam::Color)) {
+        const PixelColor& color = timeline_.value(TimelineParam::Color);
+        if (color != effect_config_.color) setColor(color);
+    }
+}
+
+bool PixelChannel::temporalDitherWanted() const noexcept {
+    if (load_.level >= DegradeLevel::NoDither) return false;
+    switch (config_.temporal_dither) {
+        case TemporalDither::On:  return true;
+        case TemporalDither::Off: return false;
+        default:                  return getRefreshRate() >= config_.dither_min_refresh_hz;
+    }
 }
 
 void PixelChannel::applyCurrentScaling(float scale_factor) {
+    // Decided per frame: a channel degraded by transmit errors drops below the threshold
+    if (transport_) {
+        transport_->setTemporalDither(temporalDitherWanted());
+    }
+
     const float brightness_scale = effect_config_.brightness / 255.0f;
     const float combined_scale = brightness_scale * std::min(scale_factor, 1.0f);
 
-    for (size_t i = 0; i < pixel_buffer_.size(); ++i) {
-        const auto& orig = pixel_buffer_[i];
-        scaled_buffer_[i] = PixelColor(
-            static_cast<uint8_t>(orig.r * combined_scale),
-            static_cast<uint8_t>(orig.g * combined_scale),
-            static_cast<uint8_t>(orig.b * combined_scale),
-            static_cast<uint8_t>(orig.w * combined_scale)
-        );
+    // Same render, same brightness and the same limiter scale: the source's scaled frame is
+    // this channel's too, as long as both leave the same part of the scaling to the encoder
+    // and reorder the output the same way.
+    // A source restored from its cycle cache skipped scaling.
+    if (render_source_ && !render_source_->cycle_hit_ && transport_ && render_source_->transport_ &&
+        transport_->scalesOnEncode() == render_source_->transport_->scalesOnEncode() &&
+        output_map_hash_ == render_source_->output_map_hash_) {
+        const PixelChannel& source = *render_source_;
+        output_scale_ = source.output_scale_;
+        if (config_.color_depth == ColorDepth::Bits16) {
+            std::copy(source.scaled_buffer16_.begin(), source.scaled_buffer16_.end(), scaled_buffer16_.begin());
+        } else if (!interpolating()) {
+            std::copy(source.scaled_buffer_.begin(), source.scaled_buffer_.end(), scaled_buffer_.begin());
+        }
+        return;
+    }
+
+    // A restored cycle frame is already encoded, but only valid at the scale it was stored
+    // with; otherwise it is scaled and encoded as usual and replaces the cached cycle
+    cycle_scale_ = static_cast<uint16_t>(combined_scale * UINT16_MAX);
+    if (cycle_hit_) {
+        if (cycle_scale_ == cycle_cache_.scale() && !transport_->encodedFrame().empty()) return;
+        cycle_hit_ = false;
+    }
+
+    if (config_.color_depth == ColorDepth::Bits16) {
+        applyScaling16(combined_scale);
+        return;
+    }
+
+    // Interpolated frames are lerped and scaled inside the encoder
+    if (interpolating()) {
+        output_scale_ = cycle_scale_;
+        return;
+    }
+
+    // Transports that scale while encoding (hardware brightness, temporal dither) get the
+    // full-precision scale instead. Reduced render resolution is upsampled in this pass, and
+    // an output transform is a gather through output_map_ in the same read of the buffer.
+    const uint16_t* map = output_map_.empty() ? nullptr : output_map_.data();
+    if (downsampled()) {
+        const bool encoder_scales = transport_ && transport_->scalesOnEncode();
+        output_scale_ = encoder_scales ? cycle_scale_ : UINT16_MAX;
+        upsample(scaled_buffer_, encoder_scales ? UINT16_MAX : cycle_scale_);
+    } else if (transport_ && transport_->scalesOnEncode()) {
+        output_scale_ = static_cast<uint16_t>(combined_scale * UINT16_MAX);
+        if (map) {
+            gatherSpan(pixel_buffer_.data(), map, scaled_buffer_.data(), scaled_buffer_.size(),
+                       [](const PixelColor& c) { return c; });
+        } else {
+            std::copy(pixel_buffer_.begin(), pixel_buffer_.end(), scaled_buffer_.begin());
+        }
+    } else {
+        output_scale_ = UINT16_MAX;
+        const auto scale = [combined_scale](const PixelColor& orig) {
+            return PixelColor(
+                static_cast<uint8_t>(orig.r * combined_scale),
+                static_cast<uint8_t>(orig.g * combined_scale),
+                static_cast<uint8_t>(orig.b * combined_scale),
+                static_cast<uint8_t>(orig.w * combined_scale)
+            );
+        };
+        if (map) {
+            gatherSpan(pixel_buffer_.data(), map, scaled_buffer_.data(), scaled_buffer_.size(), scale);
+        } else {
+            for (size_t i = 0; i < pixel_buffer_.size(); ++i) {
+                scaled_buffer_[i] = scale(pixel_buffer_[i]);
+            }
+        }
+    }
+
+    // Masked-off pixels are blanked here so the encoder never has to look at the mask
+    const auto& mask = effect_config_.mask;
+    if (!mask.empty()) {
+        const size_t count = std::min(mask.size(), scaled_buffer_.size());
+        for (size_t i = 0; i < count; ++i) {
+            if (!mask[i]) scaled_buffer_[i] = PixelColor::Black();
+        }
+        std::fill(scaled_buffer_.begin() + count, scaled_buffer_.end(), PixelColor::Black());
     }
 }
 
+void PixelChannel::applyScaling16(float combined_scale) {
+    PixelColor16* out = scaled_buffer16_.data();
+    const size_t count = scaled_buffer16_.size();
+
+    // Keyframes are already in output order; every other source goes through the transform
+    const uint16_t* map = output_map_.empty() ? nullptr : output_map_.data();
+    if (rendersRaw16()) {
+        if (map) {
+            gatherSpan(pixel_buffer16_.data(), map, out, count, [](const PixelColor16& c) { return c; });
+        } else {
+            std::copy(pixel_buffer16_.begin(), pixel_buffer16_.end(), scaled_buffer16_.begin());
+        }
+    } else if (interpolating()) {
+        lerpSpan16(key_from_.data(), key_to_.data(), lerp_weight_, out, count);
+    } else if (downsampled() && map) {
+        upsampleGather(pixel_buffer_.data(), pixel_buffer_.size(), downsample_, map, count,
+                       [&](size_t i, const PixelColor& a, const PixelColor& b, uint32_t inv, uint32_t w) {
+            const auto lerp = [&](uint8_t x, uint8_t y) {
+                return static_cast<uint16_t>(((x * inv + y * w) * 257) >> 8);
+            };
+            out[i] = PixelColor16(lerp(a.r, b.r), lerp(a.g, b.g), lerp(a.b, b.b), lerp(a.w, b.w));
+        }, [&](size_t i) { out[i] = PixelColor16(); });
+    } else if (downsampled()) {
+        upsampleSpan16(pixel_buffer_.data(), pixel_buffer_.size(), downsample_, out, count);
+    } else if (map) {
+        gatherSpan(pixel_buffer_.data(), map, out, count, [](const PixelColor& c) { return PixelColor16::from8(c); });
+    } else {
+        widenSpan(pixel_buffer_.data(), out, count);
+    }
+
+    // Gamma on the content first, brightness and limiting are then linear dimming on top
+    if (config_.gamma_correct) {
+        gammaSpan16(out, count);
+    }
+
+    const auto scale = static_cast<uint16_t>(combined_scale * UINT16_MAX);
+    if (transport_ && transport_->scalesOnEncode()) {
+        output_scale_ = scale;
+    } else {
+        output_scale_ = UINT16_MAX;
+        scaleSpan16(out, count, scale);
+    }
+
+    const auto& mask = effect_config_.mask;
+    if (!mask.empty()) {
+        maskSpan16(out, count, mask.data(), mask.size());
+    }
+}
+
+bool PixelChannel::rendersRaw16() const noexcept {
+    return config_.color_depth == ColorDepth::Bits16 &&
+           strcasecmp(effect_config_.effect.c_str(), "RAW16") == 0;
+}
+
 void PixelChannel::saveToNVS() const {
+    PIXTRACE_SCOPE("nvs save", TraceLane::Api, id_);
     nvs_handle_t handle;
     char key[16];
     snprintf(key, sizeof(key), "ch_%ld", id_);
 
-    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+    if (nvs_open(owner().getConfig().nvs_namespace.c_str(), NVS_READWRITE, &handle) != ESP_OK) {
         ESP_LOGW(TAG, "Failed to open NVS for channel %ld", id_);
         return;
     }
@@ -556,11 +1606,12 @@ void PixelChannel::saveToNVS() const {
 }
 
 void PixelChannel::loadFromNVS() {
+    PIXTRACE_SCOPE("nvs load", TraceLane::Api, id_);
     nvs_handle_t handle;
     char key[16];
     snprintf(key, sizeof(key), "ch_%ld", id_);
 
-    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+    if (nvs_open(owner().getConfig().nvs_namespace.c_str(), NVS_READONLY, &handle) != ESP_OK) {
         ESP_LOGI(TAG, "No saved config for channel %ld", id_);
         return;
     }
@@ -595,67 +1646,23 @@ void PixelChannel::loadFromNVS() {
     }
 
     nvs_close(handle);
-}
-
-void PixelChannel::i2sTaskWrapper(void* param) {
-    static_cast<PixelChannel*>(param)->i2sTask();
-}
-
-void PixelChannel::i2sTask() {
-    size_t bytes_written;
-
-    ESP_LOGD(TAG, "I2S task started for channel %ld", id_);
-
-    while (!terminate_task_) {
-        if (xSemaphoreTake(transmit_semaphore_, portMAX_DELAY) != pdTRUE) {
-            vTaskDelay(pdMS_TO_TICKS(10));
-            continue;
-        }
-
-        if (terminate_task_) break;
-
-        bytes_sent_ = 0;
-
-        esp_err_t ret = i2s_channel_preload_data(i2s_channel_,
-            i2s_buffer_.data(), i2s_buffer_.size(), &bytes_written);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "I2S preload failed: %s", esp_err_to_name(ret));
-            continue;
-        }
-
-        ret = i2s_channel_enable(i2s_channel_);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "I2S enable failed: %s", esp_err_to_name(ret));
-            continue;
-        }
-
-        if (bytes_written < i2s_buffer_.size()) {
-            ret = i2s_channel_write(i2s_channel_,
-                &i2s_buffer_[bytes_written],
-                i2s_buffer_.size() - bytes_written,
-                &bytes_written, pdMS_TO_TICKS(1000));
-            if (ret != ESP_OK) {
-                ESP_LOGW(TAG, "I2S write error: %s", esp_err_to_name(ret));
-            }
-        }
-
-        xSemaphoreTake(complete_semaphore_, portMAX_DELAY);
-        i2s_channel_disable(i2s_channel_);
-    }
-
-    ESP_LOGD(TAG, "I2S task finished for channel %ld", id_);
-    terminate_task_ = false;
-    vTaskDelete(nullptr);
+    effectChanged();
 }
 
 // ============= HTTP API Implementation =============
 
 namespace {
 
+// The pipeline attach_api() registered the handler for
+PixelPipeline& pipelineOf(httpd_req_t* req) {
+    return *static_cast<PixelPipeline*>(req->user_ctx);
+}
+
 // Handler to list available effects
 esp_err_t led_effects_list_handler(httpd_req_t* req) {
+    PIXTRACE_SCOPE("GET /api/led/effects", TraceLane::Api);
     cJSON* root = cJSON_CreateArray();
-    PixelEffectEngine* effect_engine = PixelDriver::getEffectEngine();
+    PixelEffectEngine* effect_engine = pipelineOf(req).getEffectEngine();
     std::vector<PixelEffectEngine::EffectInfo> effects = effect_engine->getAllEffects();
 
     for (size_t i = 0; i < effects.size(); ++i) {
@@ -677,25 +1684,147 @@ esp_err_t led_effects_list_handler(httpd_req_t* req) {
 
 // Handler to get LED configuration (includes version for WASM sync)
 esp_err_t led_config_get_handler(httpd_req_t* req) {
+    PIXTRACE_SCOPE("GET /api/led/config", TraceLane::Api);
+    PixelPipeline& pipeline = pipelineOf(req);
     cJSON* root = cJSON_CreateObject();
 
     // Add version info for WASM bundle synchronization
     cJSON_AddStringToObject(root, "version", PIXDRIVER_GIT_COMMIT);
 
     cJSON* channels = cJSON_CreateArray();
-    std::vector<int32_t> channel_ids = PixelDriver::getChannelIds();
+    std::vector<int32_t> channel_ids = pipeline.getChannelIds();
     for (size_t i = 0; i < channel_ids.size(); ++i) {
-        const PixelChannel* ch = PixelDriver::getChannel(channel_ids[i]);
+        const PixelChannel* ch = pipeline.getChannel(channel_ids[i]);
         if (ch) {
             ChannelConfig config = ch->getConfig();
             cJSON* ch_obj = cJSON_CreateObject();
             cJSON_AddNumberToObject(ch_obj, "index", i);
             cJSON_AddNumberToObject(ch_obj, "num_leds", config.pixel_count);
+            cJSON_AddNumberToObject(ch_obj, "render_pixels", ch->getRenderPixelCount());
+            if (ch->hasOutputTransform()) {
+                const OutputTransform& transform = config.transform;
+                cJSON* transform_obj = cJSON_CreateObject();
+                cJSON_AddBoolToObject(transform_obj, "reverse", transform.reverse);
+                cJSON_AddBoolToObject(transform_obj, "mirror", transform.mirror);
+                cJSON_AddNumberToObject(transform_obj, "rotate", transform.rotate);
+                cJSON_AddNumberToObject(transform_obj, "stride", transform.stride);
+                cJSON_AddBoolToObject(transform_obj, "index_map", !transform.index_map.empty());
+                cJSON_AddItemToObject(ch_obj, "transform", transform_obj);
+            }
             cJSON_AddStringToObject(ch_obj, "type", config.format == PixelFormat::RGB ? "RGB" : "RGBW");
+            const PixelTransport* transport = ch->getTransport();
+            if (transport) {
+                cJSON_AddStringToObject(ch_obj, "bus", transport->busName());
+                cJSON_AddStringToObject(ch_obj, "chipset", transport->chipsetName());
+                cJSON_AddBoolToObject(ch_obj, "temporal_dither", transport->temporalDither());
+            }
+
+            cJSON_AddNumberToObject(ch_obj, "output_hz", ch->getRefreshRate());
+            cJSON_AddNumberToObject(ch_obj, "render_hz", ch->getRenderRate());
+            cJSON_AddNumberToObject(ch_obj, "renders", ch->getRenderCount());
+            cJSON_AddNumberToObject(ch_obj, "render_source", ch->getRenderSource());
+            cJSON_AddNumberToObject(ch_obj, "shared_frames", ch->getSharedFrameCount());
+
+            cJSON* load_obj = cJSON_CreateObject();
+            cJSON_AddNumberToObject(load_obj, "priority", config.priority);
+            cJSON_AddNumberToObject(load_obj, "cost_us", ch->getFrameCostUs());
+            cJSON_AddStringToObject(load_obj, "degrade", degradeLevelName(ch->getDegradeLevel()));
+            cJSON_AddItemToObject(ch_obj, "load", load_obj);
+
+            const TransmitStats tx = ch->getTransmitStats();
+            cJSON* tx_obj = cJSON_CreateObject();
+            cJSON_AddNumberToObject(tx_obj, "frames", tx.frames);
+            cJSON_AddNumberToObject(tx_obj, "underruns", tx.underruns);
+            cJSON_AddNumberToObject(tx_obj, "overflows", tx.overflows);
+            cJSON_AddNumberToObject(tx_obj, "timeouts", tx.timeouts);
+            cJSON_AddNumberToObject(tx_obj, "retransmits", tx.retransmits);
+            cJSON_AddNumberToObject(tx_obj, "frame_divider", tx.frame_divider);
+            cJSON_AddItemToObject(ch_obj, "tx", tx_obj);
+
+            if (const I2sDmaConfig* dma = transport ? transport->dmaConfig() : nullptr) {
+                cJSON* dma_obj = cJSON_CreateObject();
+                cJSON_AddNumberToObject(dma_obj, "desc_num", dma->desc_num);
+                cJSON_AddNumberToObject(dma_obj, "desc_bytes", dma->desc_bytes);
+                cJSON_AddNumberToObject(dma_obj, "irqs_per_frame", dma->irqs_per_frame);
+                cJSON_AddBoolToObject(dma_obj, "whole_frame", dma->whole_frame);
+                cJSON_AddItemToObject(ch_obj, "dma", dma_obj);
+            }
+
+            if (config.cycle_cache_bytes > 0) {
+                const CycleCacheStats cache = ch->getCycleCacheStats();
+                cJSON* cache_obj = cJSON_CreateObject();
+                cJSON_AddNumberToObject(cache_obj, "period", cache.period);
+                cJSON_AddNumberToObject(cache_obj, "cached", cache.cached);
+                cJSON_AddNumberToObject(cache_obj, "bytes", cache.bytes);
+                cJSON_AddNumberToObject(cache_obj, "hits", cache.hits);
+                cJSON_AddNumberToObject(cache_obj, "stores", cache.stores);
+                cJSON_AddItemToObject(ch_obj, "cycle_cache", cache_obj);
+            }
+
+            if (ch->hasTimeline()) {
+                const PixelTimeline& timeline = ch->getTimeline();
+                cJSON* timeline_obj = cJSON_CreateObject();
+                cJSON_AddNumberToObject(timeline_obj, "keys", timeline.size());
+                cJSON_AddNumberToObject(timeline_obj, "duration_ms", timeline.durationMs());
+                cJSON_AddBoolToObject(timeline_obj, "loop", timeline.loops());
+                cJSON_AddNumberToObject(timeline_obj, "position_ms", ch->getTimelinePositionMs());
+                cJSON_AddItemToObject(ch_obj, "timeline", timeline_obj);
+            }
             cJSON_AddItemToArray(channels, ch_obj);
         }
     }
     cJSON_AddItemToObject(root, "channels", channels);
+
+    if (pipeline.isSyncEnabled()) {
+        const SyncStats sync = pipeline.getSyncStats();
+        cJSON* sync_obj = cJSON_CreateObject();
+        cJSON_AddBoolToObject(sync_obj, "locked", sync.locked);
+        cJSON_AddNumberToObject(sync_obj, "error_us", sync.error_us);
+        cJSON_AddNumberToObject(sync_obj, "mean_abs_error_us", sync.mean_abs_error_us);
+        cJSON_AddNumberToObject(sync_obj, "max_abs_error_us", sync.max_abs_error_us);
+        cJSON_AddNumberToObject(sync_obj, "rate_ppm", sync.rate_ppm);
+        cJSON_AddNumberToObject(sync_obj, "beacons", sync.beacons);
+        cJSON_AddNumberToObject(sync_obj, "lost", sync.lost);
+        cJSON_AddNumberToObject(sync_obj, "steps", sync.steps);
+        cJSON_AddNumberToObject(sync_obj, "rejected", sync.rejected);
+        cJSON_AddNumberToObject(sync_obj, "spikes", sync.spikes);
+        cJSON_AddItemToObject(root, "frame_sync", sync_obj);
+    }
+
+    if (pipeline.isAudioEnabled()) {
+        const AudioStats stats = pipeline.getAudioStats();
+        const AudioFrame frame = pipeline.getAudioFrame();
+        cJSON* audio_obj = cJSON_CreateObject();
+        cJSON_AddNumberToObject(audio_obj, "level", frame.level);
+        cJSON_AddNumberToObject(audio_obj, "bpm", frame.bpm);
+        cJSON_AddNumberToObject(audio_obj, "peak_hz", frame.peak_hz);
+        cJSON_AddNumberToObject(audio_obj, "blocks", stats.blocks);
+        cJSON_AddNumberToObject(audio_obj, "read_errors", stats.read_errors);
+        cJSON_AddNumberToObject(audio_obj, "mean_us_per_block", stats.mean_us_per_block);
+        cJSON_AddNumberToObject(audio_obj, "mean_cycles_per_block", stats.mean_cycles_per_block);
+        cJSON_AddNumberToObject(audio_obj, "max_cycles_per_block", stats.max_cycles_per_block);
+        cJSON_AddItemToObject(root, "audio", audio_obj);
+    }
+
+    const FrameBudgetStats budget = pipeline.getFrameBudgetStats();
+    cJSON* budget_obj = cJSON_CreateObject();
+    cJSON_AddBoolToObject(budget_obj, "enabled", pipeline.getBudgetPolicy().enabled);
+    cJSON_AddNumberToObject(budget_obj, "budget_us", budget.budget_us);
+    cJSON_AddNumberToObject(budget_obj, "work_us", budget.work_us);
+    cJSON_AddNumberToObject(budget_obj, "peak_work_us", budget.peak_work_us);
+    cJSON_AddNumberToObject(budget_obj, "overruns", budget.overruns);
+    cJSON_AddNumberToObject(budget_obj, "degrades", budget.degrades);
+    cJSON_AddNumberToObject(budget_obj, "restores", budget.restores);
+    cJSON_AddItemToObject(root, "budget", budget_obj);
+
+    const StartSkewStats skew = pipeline.getStartSkewStats();
+    cJSON* sync = cJSON_CreateObject();
+    cJSON_AddNumberToObject(sync, "last_skew_us", skew.last_skew_us);
+    cJSON_AddNumberToObject(sync, "max_skew_us", skew.max_skew_us);
+    cJSON_AddNumberToObject(sync, "skew_bound_us", pipeline.getMaxStartSkew());
+    cJSON_AddNumberToObject(sync, "frames_over_bound", skew.over_budget);
+    cJSON_AddItemToObject(root, "sync", sync);
+
     char* json = cJSON_Print(root);
     httpd_resp_set_type(req, "application/json");
     httpd_resp_send(req, json, strlen(json));
@@ -706,6 +1835,7 @@ esp_err_t led_config_get_handler(httpd_req_t* req) {
 
 // Handler to get a single channel configuration (GET /api/led/channel/*)
 esp_err_t led_channel_get_handler(httpd_req_t* req) {
+    PIXTRACE_SCOPE("GET /api/led/channel", TraceLane::Api);
     int channel_idx = -1;
     // Parse from URI path
     const char* uri = req->uri;
@@ -717,7 +1847,7 @@ esp_err_t led_channel_get_handler(httpd_req_t* req) {
         httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid channel index");
         return ESP_FAIL;
     }
-    const PixelChannel* ch = PixelDriver::getChannel(channel_idx);
+    const PixelChannel* ch = pipelineOf(req).getChannel(channel_idx);
     if (!ch) {
         httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Channel not found");
         return ESP_FAIL;
@@ -747,6 +1877,7 @@ esp_err_t led_channel_get_handler(httpd_req_t* req) {
 
 // Handler to configure a channel (POST /api/led/channel/*)
 esp_err_t led_channel_config_handler(httpd_req_t* req) {
+    PIXTRACE_SCOPE("POST /api/led/channel", TraceLane::Api);
     int channel_idx = -1;
     // Parse from URI path
     const char* uri = req->uri;
@@ -758,7 +1889,7 @@ esp_err_t led_channel_config_handler(httpd_req_t* req) {
         httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid channel index");
         return ESP_FAIL;
     }
-    PixelChannel* ch = PixelDriver::getChannel(channel_idx);
+    PixelChannel* ch = pipelineOf(req).getChannel(channel_idx);
     if (!ch) {
         httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Channel not found");
         return ESP_FAIL;
@@ -805,40 +1936,207 @@ esp_err_t led_channel_config_handler(httpd_req_t* req) {
     return led_channel_get_handler(req); // Return updated config
 }
 
+// Channel index from /api/led/<resource>/<index>, -1 if missing
+int channelIndexFromUri(const char* uri, const char* base) {
+    if (strncmp(uri, base, strlen(base)) != 0) return -1;
+    return atoi(uri + strlen(base));
+}
+
+// One timeline key: {"t": ms, "param": "brightness"|"speed"|"color", "value": level or
+// {"r","g","b","w"}, "easing": "step"|"linear"|"ease_in"|"ease_out"|"ease_in_out"}
+bool parseTimelineKey(const cJSON* item, TimelineKey& key) {
+    const cJSON* t = cJSON_GetObjectItem(item, "t");
+    const cJSON* param = cJSON_GetObjectItem(item, "param");
+    const cJSON* value = cJSON_GetObjectItem(item, "value");
+    const cJSON* easing = cJSON_GetObjectItem(item, "easing");
+    if (!cJSON_IsNumber(t) || t->valuedouble < 0 || !cJSON_IsString(param) || !value) return false;
+
+    const auto param_id = timelineParamFromName(param->valuestring);
+    if (!param_id) return false;
+    key.time_ms = static_cast<uint32_t>(t->valuedouble);
+    key.param = *param_id;
+    if (easing) {
+        const auto easing_id = cJSON_IsString(easing) ? timelineEasingFromName(easing->valuestring) : std::nullopt;
+        if (!easing_id) return false;
+        key.easing = *easing_id;
+    }
+
+    if (key.param == TimelineParam::Color) {
+        if (!cJSON_IsObject(value)) return false;
+        const cJSON* r = cJSON_GetObjectItem(value, "r");
+        const cJSON* g = cJSON_GetObjectItem(value, "g");
+        const cJSON* b = cJSON_GetObjectItem(value, "b");
+        const cJSON* w = cJSON_GetObjectItem(value, "w");
+        if (cJSON_IsNumber(r)) key.value.r = std::clamp(r->valueint, 0, 255);
+        if (cJSON_IsNumber(g)) key.value.g = std::clamp(g->valueint, 0, 255);
+        if (cJSON_IsNumber(b)) key.value.b = std::clamp(b->valueint, 0, 255);
+        if (cJSON_IsNumber(w)) key.value.w = std::clamp(w->valueint, 0, 255);
+    } else {
+        if (!cJSON_IsNumber(value)) return false;
+        key.value.r = static_cast<uint8_t>(std::clamp(value->valueint, 0, 255));
+    }
+    return true;
+}
+
+// Handler to upload a timeline (POST /api/led/timeline/*):
+// {"loop": bool, "duration_ms": ms, "keys": [key, ...]}
+esp_err_t led_timeline_post_handler(httpd_req_t* req) {
+    PIXTRACE_SCOPE("POST /api/led/timeline", TraceLane::Api);
+    constexpr size_t MAX_TIMELINE_BODY = 32768;
+
+    const int channel_idx = channelIndexFromUri(req->uri, "/api/led/timeline/");
+    if (channel_idx < 0 || !pipelineOf(req).getChannel(channel_idx)) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Channel not found");
+        return ESP_FAIL;
+    }
+    if (req->content_len == 0 || req->content_len > MAX_TIMELINE_BODY) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Timeline body missing or too large");
+        return ESP_FAIL;
+    }
+
+    std::string body(req->content_len, '\0');
+    size_t received = 0;
+    while (received < body.size()) {
+        const int ret = httpd_req_recv(req, body.data() + received, body.size() - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) continue;
+        if (ret <= 0) {
+            httpd_resp_send_500(req);
+            return ESP_FAIL;
+        }
+        received += ret;
+    }
+
+    cJSON* json = cJSON_ParseWithLength(body.data(), body.size());
+    if (!json) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+    const cJSON* keys = cJSON_GetObjectItem(json, "keys");
+    const cJSON* duration = cJSON_GetObjectItem(json, "duration_ms");
+    const cJSON* loop = cJSON_GetObjectItem(json, "loop");
+
+    std::vector<TimelineKey> parsed;
+    bool valid = cJSON_IsArray(keys) && cJSON_GetArraySize(keys) <= static_cast<int>(PixelTimeline::MAX_KEYS);
+    if (valid) {
+        parsed.resize(cJSON_GetArraySize(keys));
+        size_t i = 0;
+        const cJSON* item = nullptr;
+        cJSON_ArrayForEach(item, keys) {
+            if (!parseTimelineKey(item, parsed[i++])) {
+                valid = false;
+                break;
+            }
+        }
+    }
+    PixelTimeline timeline;
+    valid = valid && timeline.load(std::move(parsed),
+                                   cJSON_IsNumber(duration) && duration->valuedouble > 0
+                                       ? static_cast<uint32_t>(duration->valuedouble) : 0,
+                                   cJSON_IsTrue(loop));
+    cJSON_Delete(json);
+    if (!valid) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid timeline");
+        return ESP_FAIL;
+    }
+
+    pipelineOf(req).setTimeline(channel_idx, std::move(timeline));
+    httpd_resp_set_status(req, "204 No Content");
+    return httpd_resp_send(req, nullptr, 0);
+}
+
+// Handler to stop a timeline (DELETE /api/led/timeline/*); parameters keep their last values
+esp_err_t led_timeline_delete_handler(httpd_req_t* req) {
+    PIXTRACE_SCOPE("DELETE /api/led/timeline", TraceLane::Api);
+    const int channel_idx = channelIndexFromUri(req->uri, "/api/led/timeline/");
+    if (channel_idx < 0 || !pipelineOf(req).clearTimeline(channel_idx)) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Channel not found");
+        return ESP_FAIL;
+    }
+    httpd_resp_set_status(req, "204 No Content");
+    return httpd_resp_send(req, nullptr, 0);
+}
+
+#ifdef PIXDRIVER_TRACE
+// The trace ring as Chrome trace JSON, streamed in 1 KB chunks
+esp_err_t led_trace_get_handler(httpd_req_t* req) {
+    httpd_resp_set_type(req, "application/json");
+    char chunk[1024];
+    size_t used = 0;
+    bool ok = true;
+    writeChromeTrace(pixelTrace(), [&](const char* data, size_t length) {
+        if (used + length > sizeof(chunk)) {
+            ok = ok && httpd_resp_send_chunk(req, chunk, used) == ESP_OK;
+            used = 0;
+        }
+        std::memcpy(chunk + used, data, length);
+        used += length;
+    });
+    if (used) ok = ok && httpd_resp_send_chunk(req, chunk, used) == ESP_OK;
+    httpd_resp_send_chunk(req, nullptr, 0);
+    return ok ? ESP_OK : ESP_FAIL;
+}
+#endif
+
 } // anonymous namespace
 
-void PixelDriver::attach_api(httpd_handle_t server) {
-    static httpd_uri_t effects_uri = {
+void PixelPipeline::attach_api(httpd_handle_t server) {
+    httpd_uri_t effects_uri = {
         .uri = "/api/led/effects",
         .method = HTTP_GET,
         .handler = led_effects_list_handler,
-        .user_ctx = NULL
+        .user_ctx = this
     };
     httpd_register_uri_handler(server, &effects_uri);
 
-    static httpd_uri_t config_uri = {
+    httpd_uri_t config_uri = {
         .uri = "/api/led/config",
         .method = HTTP_GET,
         .handler = led_config_get_handler,
-        .user_ctx = NULL
+        .user_ctx = this
     };
     httpd_register_uri_handler(server, &config_uri);
 
-    static httpd_uri_t channel_get_uri = {
+    httpd_uri_t channel_get_uri = {
         .uri = "/api/led/channel/*",
         .method = HTTP_GET,
         .handler = led_channel_get_handler,
-        .user_ctx = NULL
+        .user_ctx = this
     };
     httpd_register_uri_handler(server, &channel_get_uri);
 
-    static httpd_uri_t channel_post_uri = {
+    httpd_uri_t channel_post_uri = {
         .uri = "/api/led/channel/*",
         .method = HTTP_POST,
         .handler = led_channel_config_handler,
-        .user_ctx = NULL
+        .user_ctx = this
     };
     httpd_register_uri_handler(server, &channel_post_uri);
 
+    httpd_uri_t timeline_post_uri = {
+        .uri = "/api/led/timeline/*",
+        .method = HTTP_POST,
+        .handler = led_timeline_post_handler,
+        .user_ctx = this
+    };
+    httpd_register_uri_handler(server, &timeline_post_uri);
+
+    httpd_uri_t timeline_delete_uri = {
+        .uri = "/api/led/timeline/*",
+        .method = HTTP_DELETE,
+        .handler = led_timeline_delete_handler,
+        .user_ctx = this
+    };
+    httpd_register_uri_handler(server, &timeline_delete_uri);
+
+#ifdef PIXDRIVER_TRACE
+    httpd_uri_t trace_uri = {
+        .uri = "/api/led/trace",
+        .method = HTTP_GET,
+        .handler = led_trace_get_handler,
+        .user_ctx = this
+    };
+    httpd_register_uri_handler(server, &trace_uri);
+#endif
+
     ESP_LOGI(TAG, "LED API attached (version: %s)", PIXDRIVER_GIT_COMMIT);
 }
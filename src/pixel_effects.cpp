@@ -1,6 +1,7 @@
 #include "pixel_effects.h"
 #include "pixel_platform.h"
 #include "pixel_core.h"
+#include "pixel_show.h"
 #include <algorithm>
 #include <cmath>
 #include <cctype>
@@ -72,6 +73,15 @@ PixelEffectEngine::PixelEffectEngine(uint32_t update_rate_hz)
     reg("PULSE", "Pulse", &PixelEffectEngine::applyPulse);
     reg("METEOR", "Meteor", &PixelEffectEngine::applyMeteor);
     reg("RUNNING_LIGHTS", "Running Lights", &PixelEffectEngine::applyRunningLights);
+    reg("IMAGE", "Image", &PixelEffectEngine::applyImage);
+
+    // Sound-reactive effects, driven by PixelDriver::enableAudio()
+    registerEffect("SPECTRUM", "Spectrum", [](PixelEffectEngine* e, PixelChannel* c, uint32_t) {
+        e->applySpectrum(c);
+    });
+    registerEffect("BEAT", "Beat", [](PixelEffectEngine* e, PixelChannel* c, uint32_t) {
+        e->applyBeat(c);
+    });
 }
 
 void PixelEffectEngine::updateEffect(PixelChannel* channel, uint32_t tick) {
@@ -82,8 +92,8 @@ void PixelEffectEngine::updateEffect(PixelChannel* channel, uint32_t tick) {
 
     const std::string& effect_name = config.effect;
 
-    // Raw mode - firmware manages buffer directly
-    if (equalsIgnoreCase(effect_name, "RAW")) {
+    // Raw mode - firmware manages buffer directly (RAW16: the 16-bit buffer)
+    if (equalsIgnoreCase(effect_name, "RAW") || equalsIgnoreCase(effect_name, "RAW16")) {
         return;
     }
 
@@ -118,10 +128,7 @@ void PixelEffectEngine::applyBlink(PixelChannel* channel, uint32_t tick) {
 
     const uint32_t interval = getEffectInterval(config.speed);
 
-    if (tick - state.last_update_tick >= interval) {
-        state.direction = !state.direction;
-        state.last_update_tick = tick;
-    }
+    state.direction = effectStep(tick, interval) & 1;
 
     const PixelColor color = state.direction ? config.color : PixelColor::Black();
     std::fill(buffer.begin(), buffer.end(), color);
@@ -134,23 +141,9 @@ void PixelEffectEngine::applyBreathe(PixelChannel* channel, uint32_t tick) {
 
     const uint32_t interval = getEffectInterval(config.speed) / 4;
 
-    if (tick - state.last_update_tick >= interval) {
-        if (state.breathe.increasing) {
-            state.breathe.brightness += 5;
-            if (state.breathe.brightness >= 250) {
-                state.breathe.brightness = 255;
-                state.breathe.increasing = false;
-            }
-        } else {
-            if (state.breathe.brightness <= 5) {
-                state.breathe.brightness = 0;
-                state.breathe.increasing = true;
-            } else {
-                state.breathe.brightness -= 5;
-            }
-        }
-        state.last_update_tick = tick;
-    }
+    // Triangle 0 -> 255 -> 0 in steps of 5
+    const uint32_t step = effectStep(tick, interval) % 102;
+    state.breathe.brightness = static_cast<uint8_t>((step <= 51 ? step : 102 - step) * 5);
 
     // Use gamma correction for smoother breathing
     const uint8_t gamma_brightness = gammaCorrect(state.breathe.brightness);
@@ -166,10 +159,7 @@ void PixelEffectEngine::applyCyclic(PixelChannel* channel, uint32_t tick) {
     const uint32_t interval = getEffectInterval(config.speed);
     const size_t size = buffer.size();
 
-    if (tick - state.last_update_tick >= interval) {
-        state.cyclic.offset = (state.cyclic.offset + 1) % size;
-        state.last_update_tick = tick;
-    }
+    state.cyclic.offset = static_cast<uint8_t>(effectStep(tick, interval) % size);
 
     std::fill(buffer.begin(), buffer.end(), PixelColor::Black());
 
@@ -189,10 +179,8 @@ void PixelEffectEngine::applyRainbow(PixelChannel* channel, uint32_t tick) {
     const uint32_t interval = getEffectInterval(config.speed);
     const size_t size = buffer.size();
 
-    if (tick - state.last_update_tick >= interval) {
-        state.rainbow.offset = (state.rainbow.offset + 1) % 256;
-        state.last_update_tick = tick;
-    }
+    state.rainbow.offset = static_cast<uint8_t>(effectStep(tick, interval));
+    if (channel->restoreCycleFrame(state.rainbow.offset, 256)) return;
 
     for (size_t i = 0; i < size; ++i) {
         const uint8_t hue = static_cast<uint8_t>((i * 256 / size) + state.rainbow.offset);
@@ -208,15 +196,10 @@ void PixelEffectEngine::applyColorWipe(PixelChannel* channel, uint32_t tick) {
     const uint32_t interval = getEffectInterval(config.speed);
     const size_t size = buffer.size();
 
-    if (tick - state.last_update_tick >= interval) {
-        if (state.wipe.pixel < size) {
-            state.wipe.pixel++;
-        } else {
-            state.wipe.clearing = !state.wipe.clearing;
-            state.wipe.pixel = 0;
-        }
-        state.last_update_tick = tick;
-    }
+    // size + 1 steps filling, then as many clearing
+    const uint32_t step = effectStep(tick, interval) % (2 * (size + 1));
+    state.wipe.clearing = step > size;
+    state.wipe.pixel = static_cast<uint16_t>(step % (size + 1));
 
     const PixelColor fill = state.wipe.clearing ? PixelColor::Black() : config.color;
     const PixelColor rest = state.wipe.clearing ? config.color : PixelColor::Black();
@@ -233,10 +216,8 @@ void PixelEffectEngine::applyTheaterChase(PixelChannel* channel, uint32_t tick)
 
     const uint32_t interval = getEffectInterval(config.speed);
 
-    if (tick - state.last_update_tick >= interval) {
-        state.chase.offset = (state.chase.offset + 1) % 3;
-        state.last_update_tick = tick;
-    }
+    state.chase.offset = static_cast<uint8_t>(effectStep(tick, interval) % 3);
+    if (channel->restoreCycleFrame(state.chase.offset, 3)) return;
 
     for (size_t i = 0; i < buffer.size(); ++i) {
         buffer[i] = ((i + state.chase.offset) % 3 == 0) ? config.color : PixelColor::Black();
@@ -274,13 +255,7 @@ void PixelEffectEngine::applyComet(PixelChannel* channel, uint32_t tick) {
     const int size = static_cast<int>(buffer.size());
     const int tail_length = std::max(3, size / 4);
 
-    if (tick - state.last_update_tick >= interval) {
-        state.comet.head++;
-        if (state.comet.head >= size + tail_length) {
-            state.comet.head = -tail_length;
-        }
-        state.last_update_tick = tick;
-    }
+    state.comet.head = static_cast<int16_t>(effectStep(tick, interval) % (size + 2 * tail_length)) - tail_length;
 
     // Fade existing pixels
     for (auto& pixel : buffer) {
@@ -360,10 +335,8 @@ void PixelEffectEngine::applyWave(PixelChannel* channel, uint32_t tick) {
     const uint32_t interval = getEffectInterval(config.speed) / 4;
     const size_t size = buffer.size();
 
-    if (tick - state.last_update_tick >= interval) {
-        state.wave.position++;
-        state.last_update_tick = tick;
-    }
+    state.wave.position = static_cast<uint8_t>(effectStep(tick, interval));
+    if (channel->restoreCycleFrame(state.wave.position, 256)) return;
 
     for (size_t i = 0; i < size; ++i) {
         // Create smooth sine wave
@@ -406,10 +379,8 @@ void PixelEffectEngine::applyGradient(PixelChannel* channel, uint32_t tick) {
     const uint32_t interval = getEffectInterval(config.speed);
     const size_t size = buffer.size();
 
-    if (tick - state.last_update_tick >= interval) {
-        state.phase++;
-        state.last_update_tick = tick;
-    }
+    state.phase = effectStep(tick, interval);
+    if (channel->restoreCycleFrame(state.phase % 256, 256)) return;
 
     // Create gradient from color to complementary color
     const PixelColor complement(
@@ -434,10 +405,7 @@ void PixelEffectEngine::applyPulse(PixelChannel* channel, uint32_t tick) {
     const size_t size = buffer.size();
     const size_t center = size / 2;
 
-    if (tick - state.last_update_tick >= interval) {
-        state.phase++;
-        state.last_update_tick = tick;
-    }
+    state.phase = effectStep(tick, interval);
 
     std::fill(buffer.begin(), buffer.end(), PixelColor::Black());
 
@@ -498,10 +466,8 @@ void PixelEffectEngine::applyRunningLights(PixelChannel* channel, uint32_t tick)
     const uint32_t interval = getEffectInterval(config.speed) / 4;
     const size_t size = buffer.size();
 
-    if (tick - state.last_update_tick >= interval) {
-        state.phase++;
-        state.last_update_tick = tick;
-    }
+    state.phase = effectStep(tick, interval);
+    if (channel->restoreCycleFrame(state.phase % 64, 64)) return;  // phase * 4 wraps at 256
 
     for (size_t i = 0; i < size; ++i) {
         // Create running wave pattern
@@ -510,6 +476,44 @@ void PixelEffectEngine::applyRunningLights(PixelChannel* channel, uint32_t tick)
     }
 }
 
+// Column-scanned image attached with PixelDriver::setImage(), black without one
+void PixelEffectEngine::applyImage(PixelChannel* channel, uint32_t tick) {
+    auto& buffer = channel->getPixelBuffer();
+    PixelImage* image = channel->getImage();
+    if (!image) {
+        std::fill(buffer.begin(), buffer.end(), PixelColor::Black());
+        return;
+    }
+    image->render(buffer, tick, channel->getEffectConfig().speed, update_rate_hz_);
+}
+
+// Audio analysis (PixelDriver::enableAudio()): one bar per band, lowest band first, each
+// lit from the start of its segment in proportion to the band level
+void PixelEffectEngine::applySpectrum(PixelChannel* channel) {
+    const auto& config = channel->getEffectConfig();
+    auto& buffer = channel->getPixelBuffer();
+    std::fill(buffer.begin(), buffer.end(), PixelColor::Black());
+    const size_t bands = audio_frame_.band_count;
+    if (bands == 0) return;
+
+    const size_t size = buffer.size();
+    for (size_t b = 0; b < bands; ++b) {
+        const size_t begin = b * size / bands;
+        const size_t end = (b + 1) * size / bands;
+        const size_t lit = (end - begin) * audio_frame_.bands[b] / 255;
+        const PixelColor color = PixelColor::fromHSV(static_cast<uint8_t>(b * 200 / bands), 255, config.brightness);
+        std::fill(buffer.begin() + begin, buffer.begin() + begin + lit, color);
+    }
+}
+
+// The effect color flashed on every beat, falling back to a glow that follows the level
+void PixelEffectEngine::applyBeat(PixelChannel* channel) {
+    const auto& config = channel->getEffectConfig();
+    auto& buffer = channel->getPixelBuffer();
+    const uint8_t brightness = std::max<uint8_t>(audio_frame_.beat_pulse, audio_frame_.level / 4);
+    std::fill(buffer.begin(), buffer.end(), config.color.scale(brightness));
+}
+
 // ============= HELPER FUNCTIONS =============
 
 uint32_t PixelEffectEngine::getEffectInterval(uint8_t speed) const noexcept {
@@ -0,0 +1,406 @@
+#include "pixel_show.h"
+#include "kd_pixdriver.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include <algorithm>
+
+namespace {
+constexpr const char* TAG = "pixel_show";
+
+// Frames decoded per driver frame at most when the show runs faster than the driver or
+// playback fell behind; beyond that the show clock is moved instead
+constexpr uint32_t MAX_CATCHUP_FRAMES = 4;
+
+class ShowPartitionSource final : public ShowSource {
+public:
+    explicit ShowPartitionSource(const esp_partition_t* partition) : partition_(partition) {}
+
+    size_t readAt(size_t offset, uint8_t* out, size_t len) override {
+        if (offset >= partition_->size) return 0;
+        const size_t n = std::min<size_t>(len, partition_->size - offset);
+        return esp_partition_read(partition_, offset, out, n) == ESP_OK ? n : 0;
+    }
+
+private:
+    const esp_partition_t* partition_;
+};
+} // anonymous namespace
+
+// ============= PixelShowPlayer =============
+
+PixelShowPlayer::PixelShowPlayer() : PixelShowPlayer(PixelDriver::pipeline()) {}
+
+PixelShowPlayer::PixelShowPlayer(PixelPipeline& pipeline)
+    : pipeline_(pipeline), mutex_(xSemaphoreCreateMutex()) {}
+
+PixelShowPlayer::~PixelShowPlayer() {
+    stop();
+    if (mutex_) {
+        vSemaphoreDelete(mutex_);
+    }
+}
+
+bool PixelShowPlayer::openPartition(const char* label) {
+    const esp_partition_t* partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!partition) {
+        ESP_LOGE(TAG, "Partition '%s' not found", label);
+        return false;
+    }
+    return openSource(std::make_unique<ShowPartitionSource>(partition), label);
+}
+
+bool PixelShowPlayer::openFile(const char* path) {
+    auto source = std::make_unique<ShowFileSource>(path);
+    if (!source->isOpen()) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return false;
+    }
+    return openSource(std::move(source), path);
+}
+
+bool PixelShowPlayer::openSource(std::unique_ptr<ShowSource> source, const char* name) {
+    stop();
+    auto decoder = std::make_unique<ShowDecoder>(*source);
+    if (!decoder->open()) {
+        ESP_LOGE(TAG, "%s is not a pixel show", name);
+        return false;
+    }
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    source_ = std::move(source);
+    decoder_ = std::move(decoder);
+
+    // Default binding: tracks in channel creation order
+    const std::vector<int32_t> ids = pipeline_.getChannelIds();
+    const size_t tracks = decoder_->tracks().size();
+    track_channels_.assign(tracks, -1);
+    std::copy_n(ids.begin(), std::min(tracks, ids.size()), track_channels_.begin());
+
+    const ShowHeader& header = decoder_->header();
+    ESP_LOGI(TAG, "Opened %s: %u tracks, %lu frames at %u Hz", name, header.track_count,
+             header.frame_count, header.frame_rate_hz);
+    xSemaphoreGive(mutex_);
+    return true;
+}
+
+void PixelShowPlayer::close() {
+    stop();
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    decoder_.reset();
+    source_.reset();
+    track_channels_.clear();
+    xSemaphoreGive(mutex_);
+}
+
+bool PixelShowPlayer::bindTrack(uint8_t track, int32_t channel_id) {
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    const bool ok = track < track_channels_.size();
+    if (ok) {
+        track_channels_[track] = channel_id;
+    }
+    xSemaphoreGive(mutex_);
+    return ok;
+}
+
+bool PixelShowPlayer::play(bool loop) {
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    if (!decoder_) {
+        xSemaphoreGive(mutex_);
+        ESP_LOGW(TAG, "No show open");
+        return false;
+    }
+    decoder_->rewind();
+    loop_ = loop;
+    clock_started_ = false;
+    playing_ = true;
+    xSemaphoreGive(mutex_);
+
+    pipeline_.setShowPlayer(this);
+    return true;
+}
+
+void PixelShowPlayer::stop() {
+    playing_ = false;
+    // Returns once the driver task is no longer inside renderFrame()
+    pipeline_.clearShowPlayer(this);
+}
+
+ShowHeader PixelShowPlayer::getHeader() const {
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    const ShowHeader header = decoder_ ? decoder_->header() : ShowHeader{};
+    xSemaphoreGive(mutex_);
+    return header;
+}
+
+uint32_t PixelShowPlayer::getFrameIndex() const {
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    const uint32_t index = decoder_ ? decoder_->frameIndex() : 0;
+    xSemaphoreGive(mutex_);
+    return index;
+}
+
+bool PixelShowPlayer::ownsChannel(int32_t channel_id) const noexcept {
+    return playing_ && std::find(track_channels_.begin(), track_channels_.end(), channel_id) != track_channels_.end();
+}
+
+void PixelShowPlayer::renderFrame(uint32_t tick) {
+    // Never stall the frame clock behind open()/bindTrack() in another task
+    if (!playing_ || xSemaphoreTake(mutex_, 0) != pdTRUE) return;
+
+    if (!clock_started_) {
+        start_tick_ = tick;
+        clock_started_ = true;
+    }
+
+    // Show frame due at this driver frame; decode up to it
+    const uint32_t show_hz = decoder_->header().frame_rate_hz;
+    const uint32_t driver_hz = std::max<uint32_t>(pipeline_.getUpdateRate(), 1);
+    uint64_t target = static_cast<uint64_t>(tick - start_tick_) * show_hz / driver_hz;
+
+    for (uint32_t steps = 0; decoder_->frameIndex() <= target; ++steps) {
+        if (steps == MAX_CATCHUP_FRAMES) {
+            // Too far behind: drop the backlog instead of lagging forever
+            start_tick_ = tick - static_cast<uint32_t>((decoder_->frameIndex() - 1) * uint64_t(driver_hz) / show_hz);
+            break;
+        }
+        const ShowStatus status = decoder_->decodeFrame();
+        if (status == ShowStatus::END && loop_ && decoder_->frameIndex() > 0) {
+            decoder_->rewind();
+            start_tick_ = tick;
+            target = 0;
+            continue;
+        }
+        if (status != ShowStatus::OK) {
+            if (status == ShowStatus::CORRUPT) {
+                ESP_LOGE(TAG, "Corrupt show data in frame %lu, stopping", decoder_->frameIndex());
+            }
+            playing_ = false;
+            break;
+        }
+    }
+
+    // Rewritten every frame so a channel that was disabled in between comes back intact
+    if (decoder_->frameIndex() > 0) {
+        for (size_t t = 0; t < track_channels_.size(); ++t) {
+            PixelChannel* channel = pipeline_.getChannel(track_channels_[t]);
+            if (channel && channel->getEffectConfig().enabled) {
+                unpackTrack(t, *channel);
+            }
+        }
+    }
+    xSemaphoreGive(mutex_);
+}
+
+void PixelShowPlayer::unpackTrack(size_t track, PixelChannel& channel) const {
+    const ShowTrack& info = decoder_->tracks()[track];
+    const uint8_t* data = decoder_->trackData(track);
+    auto& buffer = channel.getPixelBuffer();
+
+    const size_t count = std::min<size_t>(info.pixel_count, buffer.size());
+    if (info.colors == 4) {
+        for (size_t i = 0; i < count; ++i, data += 4) {
+            buffer[i] = PixelColor(data[0], data[1], data[2], data[3]);
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i, data += 3) {
+            buffer[i] = PixelColor(data[0], data[1], data[2]);
+        }
+    }
+    std::fill(buffer.begin() + count, buffer.end(), PixelColor::Black());
+}
+
+// ============= PixelImage =============
+
+bool PixelImage::openPartition(const char* label) {
+    const esp_partition_t* partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!partition) {
+        ESP_LOGE(TAG, "Partition '%s' not found", label);
+        return false;
+    }
+    return openSource(std::make_unique<ShowPartitionSource>(partition), label);
+}
+
+bool PixelImage::openFile(const char* path) {
+    auto source = std::make_unique<ShowFileSource>(path);
+    if (!source->isOpen()) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return false;
+    }
+    return openSource(std::move(source), path);
+}
+
+bool PixelImage::openMemory(const uint8_t* data, size_t size) {
+    return openSource(std::make_unique<ShowMemorySource>(data, size), "image");
+}
+
+bool PixelImage::openSource(std::unique_ptr<ShowSource> source, const char* name) {
+    auto decoder = std::make_unique<ImageDecoder>(*source);
+    if (!decoder->open()) {
+        ESP_LOGE(TAG, "%s is not a pixel image", name);
+        return false;
+    }
+    source_ = std::move(source);
+    decoder_ = std::move(decoder);
+    started_ = false;
+    failed_ = false;
+
+    const ImageHeader& header = decoder_->header();
+    ESP_LOGI(TAG, "Opened %s: %ux%u %s at %u columns/s, %u bytes to play", name, header.width,
+             header.height, header.colors == 4 ? "RGBW" : "RGB", header.column_rate_hz,
+             static_cast<unsigned>(decoder_->memoryBytes()));
+    return true;
+}
+
+void PixelImage::render(std::vector<PixelColor>& buffer, uint32_t tick, uint8_t speed, uint32_t frame_rate_hz) {
+    if (!decoder_ || failed_ || buffer.empty()) {
+        std::fill(buffer.begin(), buffer.end(), PixelColor::Black());
+        return;
+    }
+    if (!started_) {
+        clock_.start(tick);
+        started_ = true;
+    }
+
+    // Column due at this frame
+    const ImageHeader& header = decoder_->header();
+    const uint32_t rate = playback_.column_rate_hz ? playback_.column_rate_hz : header.column_rate_hz;
+    const uint64_t position = clock_.advance(tick, rate, std::clamp<uint8_t>(speed, 1, 10), frame_rate_hz);
+    if (!playback_.loop && position >= header.width) {
+        std::fill(buffer.begin(), buffer.end(), PixelColor::Black());
+        return;
+    }
+    uint16_t column = static_cast<uint16_t>(position % header.width);
+    if (playback_.reverse) column = static_cast<uint16_t>(header.width - 1 - column);
+
+    const ShowStatus status = decoder_->seek(column);
+    if (status != ShowStatus::OK) {
+        ESP_LOGE(TAG, "Corrupt image data in column %u, stopping", column);
+        failed_ = true;
+        std::fill(buffer.begin(), buffer.end(), PixelColor::Black());
+        return;
+    }
+
+    // Scale the column to the buffer, rotated by the (scrolling) row offset
+    const int64_t height = header.height;
+    const int64_t scrolled = static_cast<int64_t>(clock_.elapsedFrames(tick)) * playback_.scroll_rows_hz /
+                             static_cast<int64_t>(std::max<uint32_t>(frame_rate_hz, 1));
+    const auto offset = static_cast<size_t>(((playback_.row_offset + scrolled) % height + height) % height);
+    const uint8_t* data = decoder_->columnData();
+    const size_t count = buffer.size();
+    for (size_t i = 0; i < count; ++i) {
+        size_t row = i * header.height / count + offset;
+        if (row >= header.height) row -= header.height;
+        const uint8_t* p = data + row * header.colors;
+        buffer[i] = header.colors == 4 ? PixelColor(p[0], p[1], p[2], p[3]) : PixelColor(p[0], p[1], p[2]);
+    }
+}
+
+// ============= PixelShowRecorder =============
+
+PixelShowRecorder::PixelShowRecorder() : PixelShowRecorder(PixelDriver::pipeline()) {}
+
+PixelShowRecorder::~PixelShowRecorder() {
+    stop();
+}
+
+bool PixelShowRecorder::start(const char* path, const std::vector<int32_t>& channel_ids,
+                              uint16_t keyframe_interval) {
+    stop();
+
+    channel_ids_ = channel_ids.empty() ? pipeline_.getChannelIds() : channel_ids;
+    if (channel_ids_.empty() || channel_ids_.size() > SHOW_MAX_TRACKS) {
+        ESP_LOGE(TAG, "Cannot record %u channels", channel_ids_.size());
+        return false;
+    }
+
+    std::vector<ShowTrack> tracks;
+    size_t max_bytes = 0;
+    for (const int32_t id : channel_ids_) {
+        const PixelChannel* channel = pipeline_.getChannel(id);
+        if (!channel) {
+            ESP_LOGE(TAG, "Channel %ld not found", id);
+            return false;
+        }
+        // Render resolution, never above ChannelConfig::pixel_count, so it fits the track
+        static_assert(sizeof(decltype(ChannelConfig::pixel_count)) <= sizeof(decltype(ShowTrack::pixel_count)));
+        ShowTrack track;
+        track.pixel_count = static_cast<uint16_t>(channel->getRenderPixelCount());
+        track.colors = static_cast<uint8_t>(channel->getConfig().format);
+        max_bytes = std::max(max_bytes, track.bytes());
+        tracks.push_back(track);
+    }
+
+    ShowHeader header;
+    header.frame_rate_hz = static_cast<uint16_t>(pipeline_.getUpdateRate());
+    header.keyframe_interval = keyframe_interval;
+
+    file_ = std::fopen(path, "wb");
+    if (!file_) {
+        ESP_LOGE(TAG, "Cannot create %s", path);
+        return false;
+    }
+    encoder_ = std::make_unique<ShowEncoder>(header, std::move(tracks));
+    track_bytes_.resize(max_bytes);
+    pending_ = encoder_->encodeHeader();  // Frame count 0 until stop(): a cut-off file still plays
+    pending_.reserve(SHOW_CHUNK_BYTES * 2);
+    failed_ = false;
+
+    pipeline_.setShowRecorder(this);
+    ESP_LOGI(TAG, "Recording %u channels to %s", channel_ids_.size(), path);
+    return true;
+}
+
+bool PixelShowRecorder::stop() {
+    if (!file_) return false;
+    // Returns once the driver task is no longer inside captureFrame()
+    pipeline_.clearShowRecorder(this);
+
+    bool ok = flush() && !failed_;
+    if (ok) {
+        const std::vector<uint8_t> header = encoder_->encodeHeader();
+        ok = std::fseek(file_, 0, SEEK_SET) == 0 &&
+             std::fwrite(header.data(), 1, header.size(), file_) == header.size();
+    }
+    ok = (std::fclose(file_) == 0) && ok;
+    file_ = nullptr;
+
+    ESP_LOGI(TAG, "Recorded %lu frames%s", encoder_->frameCount(), ok ? "" : " (write failed)");
+    return ok;
+}
+
+void PixelShowRecorder::captureFrame() {
+    if (!file_ || failed_) return;
+
+    encoder_->beginFrame();
+    for (size_t t = 0; t < channel_ids_.size(); ++t) {
+        const PixelChannel* channel = pipeline_.getChannel(channel_ids_[t]);
+        const ShowTrack& track = encoder_->tracks()[t];
+        uint8_t* out = track_bytes_.data();
+        std::fill(out, out + track.bytes(), uint8_t(0));  // A removed channel records black
+
+        if (channel) {
+            const auto& buffer = channel->getPixelBuffer();
+            const size_t count = std::min<size_t>(track.pixel_count, buffer.size());
+            for (size_t i = 0; i < count; ++i) {
+                *out++ = buffer[i].r;
+                *out++ = buffer[i].g;
+                *out++ = buffer[i].b;
+                if (track.colors == 4) *out++ = buffer[i].w;
+            }
+        }
+        encoder_->encodeTrack(t, track_bytes_.data(), pending_);
+    }
+
+    if (pending_.size() >= SHOW_CHUNK_BYTES && !flush()) {
+        ESP_LOGE(TAG, "Show write failed, recording stopped");
+        failed_ = true;
+    }
+}
+
+bool PixelShowRecorder::flush() {
+    const bool ok = std::fwrite(pending_.data(), 1, pending_.size(), file_) == pending_.size();
+    pending_.clear();
+    return ok;
+}
@@ -0,0 +1,657 @@
+#include "pixel_transport.h"
+#include "kd_pixdriver.h"
+#include "pixel_transmit.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "driver/i2s_common.h"
+#include <algorithm>
+
+namespace {
+constexpr const char* TAG = "pixel_transport";
+
+// Smallest chunk the RMT encoder callback is asked for: one whole data byte
+constexpr size_t RMT_MIN_CHUNK_SYMBOLS = 8;
+
+static_assert(sizeof(rmt_symbol_word_t) == sizeof(uint32_t));
+
+// How long abort() waits for an SPI transaction that cannot be cancelled
+constexpr uint32_t SPI_ABORT_WAIT_MS = 100;
+} // anonymous namespace
+
+std::unique_ptr<PixelTransport> PixelTransport::create(int32_t channel_id, const ChannelConfig& config) {
+    switch (config.bus) {
+        case PixelBus::SPI:
+            return std::make_unique<SpiTransport>(channel_id, config);
+        case PixelBus::RMT:
+            return std::make_unique<RmtTransport>(channel_id, config);
+        case PixelBus::I2S:
+        default:
+            return std::make_unique<I2sTransport>(channel_id, config);
+    }
+}
+
+void PixelTransport::encodeLerp(const std::vector<PixelColor>& from, const std::vector<PixelColor>& to,
+                                uint16_t weight, uint16_t scale) {
+    // Scale here too unless encode() applies it
+    const bool scale_here = !scalesOnEncode();
+    const uint32_t factor = (scale_here ? static_cast<uint32_t>(scale) : UINT16_MAX) + 1;
+    const auto level = [&](uint8_t a, uint8_t b) {
+        return static_cast<uint8_t>((lerpLevel(a, b, weight) * factor) >> 24);
+    };
+
+    lerp_scratch_.resize(to.size());
+    for (size_t i = 0; i < to.size(); ++i) {
+        lerp_scratch_[i] = PixelColor(level(from[i].r, to[i].r), level(from[i].g, to[i].g),
+                                      level(from[i].b, to[i].b), level(from[i].w, to[i].w));
+    }
+    encode(lerp_scratch_, scale_here ? UINT16_MAX : scale);
+}
+
+// ============= I2sTransport =============
+
+I2sTransport::I2sTransport(int32_t channel_id, const ChannelConfig& config)
+    : channel_id_(channel_id)
+    , pin_(config.pin)
+    , pixel_count_(config.pixel_count)
+    , format_(config.format)
+    , dma_irq_hz_(config.dma_irq_hz)
+    , max_dma_bytes_(config.max_dma_bytes)
+    , protocol_(&getPixelProtocol(config.chipset))
+    , encoders_(selectI2sEncoders(config.color_order, config.format, protocol_->bytes_per_color)) {
+
+    // Header + pixel data + reset, padded to whole 16-bit stereo DMA frames
+    const PixelProtocol& proto = *protocol_;
+    const size_t bytes_per_pixel = proto.bytes_per_color * static_cast<size_t>(config.format);
+    const size_t data_size = (proto.header_len * proto.bytes_per_color) +
+                             (config.pixel_count * bytes_per_pixel);
+    const size_t buffer_size = data_size + proto.reset_bytes;
+    buffer_.resize((buffer_size + I2S_DMA_BYTES_PER_FRAME - 1) & ~size_t(I2S_DMA_BYTES_PER_FRAME - 1),
+                   proto.idle_byte);
+}
+
+I2sTransport::~I2sTransport() {
+    if (channel_) {
+        i2s_del_channel(channel_);
+        channel_ = nullptr;
+    }
+}
+
+IRAM_ATTR bool I2sTransport::onSent(i2s_chan_handle_t, i2s_event_data_t* event, void* user_ctx) {
+    auto* self = static_cast<I2sTransport*>(user_ctx);
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    if (self && event && self->tx_task_) {
+        self->bytes_sent_ = self->bytes_sent_ + event->size;
+        // DMA sent a buffer we had not filled yet: zeros went out mid-frame
+        const size_t frame_size = self->buffer_.size();
+        if (self->bytes_queued_ < frame_size && self->bytes_sent_ > self->bytes_queued_) {
+            self->events_ = self->events_ | TransmitHealth::EVENT_UNDERRUN;
+        }
+        // Wake the service task only when it has something to do for this slot:
+        // refill the DMA queue or retire the finished frame
+        const bool done = self->bytes_sent_ >= frame_size;
+        if (done && self->done_time_us_ == 0) {
+            self->done_time_us_ = esp_timer_get_time();
+        }
+        const bool idle_pending = self->idle_queued_ < self->idle_tail_.size();
+        if (done || self->bytes_queued_ < frame_size || idle_pending) {
+            xTaskNotifyFromISR(self->tx_task_, TransmitScheduler::bit(self->tx_slot_),
+                               eSetBits, &higher_priority_task_woken);
+        }
+    }
+    return higher_priority_task_woken == pdTRUE;
+}
+
+IRAM_ATTR bool I2sTransport::onSendQueueOverflow(i2s_chan_handle_t, i2s_event_data_t*, void* user_ctx) {
+    auto* self = static_cast<I2sTransport*>(user_ctx);
+    // Once the frame is out the queue overflows by design while we wait to disable
+    if (self && self->bytes_sent_ < self->buffer_.size()) {
+        self->events_ = self->events_ | TransmitHealth::EVENT_OVERFLOW;
+    }
+    return false;
+}
+
+bool I2sTransport::initialize(TaskHandle_t tx_task, int32_t tx_slot) {
+    tx_task_ = tx_task;
+    tx_slot_ = tx_slot;
+
+    // Size the DMA ring for this strip instead of the driver's fixed default
+    const uint32_t bitrate = protocol_->profile->bitrate;
+    dma_config_ = computeI2sDmaConfig(buffer_.size(), bitrate, dma_irq_hz_, max_dma_bytes_);
+
+    i2s_chan_config_t chan_config = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_AUTO, I2S_ROLE_MASTER);
+    chan_config.dma_desc_num = dma_config_.desc_num;
+    chan_config.dma_frame_num = dma_config_.frame_num;
+    // Send zeros (reset level) once the frame runs out instead of repeating stale DMA buffers.
+    // Zeros are the active level on idle-high lines, so those keep the ring and queue an
+    // idle-level descriptor behind each frame instead (see refill())
+    const bool idle_high = protocol_->profile->inverted;
+    chan_config.auto_clear = !idle_high;
+
+    i2s_std_config_t std_config = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(bitrate / 16 / 2),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO),
+        .gpio_cfg = {
+            .mclk = I2S_GPIO_UNUSED,
+            .bclk = I2S_GPIO_UNUSED,
+            .ws = I2S_GPIO_UNUSED,
+            .dout = pin_,
+            .din = I2S_GPIO_UNUSED,
+            .invert_flags = { .mclk_inv = false, .bclk_inv = false, .ws_inv = false },
+        },
+    };
+
+    esp_err_t ret = i2s_new_channel(&chan_config, &channel_, nullptr);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create I2S channel: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    ret = i2s_channel_init_std_mode(channel_, &std_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init I2S: %s", esp_err_to_name(ret));
+        i2s_del_channel(channel_);
+        channel_ = nullptr;
+        return false;
+    }
+
+    i2s_event_callbacks_t callbacks = {
+        .on_recv = nullptr,
+        .on_recv_q_ovf = nullptr,
+        .on_sent = onSent,
+        .on_send_q_ovf = onSendQueueOverflow,
+    };
+
+    ret = i2s_channel_register_event_callback(channel_, &callbacks, this);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register I2S callbacks: %s", esp_err_to_name(ret));
+        i2s_del_channel(channel_);
+        channel_ = nullptr;
+        return false;
+    }
+
+    if (idle_high) {
+        idle_tail_.assign(dma_config_.desc_bytes, protocol_->idle_byte);
+    }
+
+    ESP_LOGI(TAG, "Channel %ld DMA: %lu x %lu bytes, %lu irqs/frame%s", channel_id_,
+             dma_config_.desc_num, dma_config_.desc_bytes, dma_config_.irqs_per_frame,
+             dma_config_.whole_frame ? " (whole frame preloaded)" : "");
+    return true;
+}
+
+size_t I2sTransport::encodeHeader(size_t pixel_count) {
+    const PixelProtocol& proto = *protocol_;
+    uint8_t* out = buffer_.data();
+    size_t pos = 0;
+
+    // Header values go through the same table, bytes swapped for the stereo slot order
+    for (uint8_t i = 0; i < proto.header_len; ++i) {
+        const uint8_t* seq = &proto.table[proto.header[i] * proto.bytes_per_color];
+        for (size_t j = 0; j < proto.bytes_per_color; ++j, ++pos) {
+            out[pos ^ 1] = seq[j];
+        }
+    }
+
+    const size_t data_size = pos + pixel_count * proto.bytes_per_color * static_cast<size_t>(format_);
+
+    // Reset bytes, starting on an even index so the pairwise swap cannot leave a gap
+    std::fill(buffer_.begin() + (data_size & ~size_t(1)), buffer_.end(), proto.idle_byte);
+    return pos;
+}
+
+void I2sTransport::encode(const std::vector<PixelColor>& pixels, uint16_t scale) {
+    const size_t pos = encodeHeader(pixels.size());
+    if (temporal_dither_) {
+        encoders_.dither(pixels.data(), pixels.size(), scale, dither_residue_.data(),
+                         protocol_->table, buffer_.data(), pos);
+    } else {
+        encoders_.plain(pixels.data(), pixels.size(), protocol_->table, buffer_.data(), pos);
+    }
+}
+
+void I2sTransport::encode16(const std::vector<PixelColor16>& pixels, uint16_t scale) {
+    // Only reached while dithering (see encodes16())
+    const size_t pos = encodeHeader(pixels.size());
+    encoders_.dither16(pixels.data(), pixels.size(), scale, dither_residue_.data(),
+                       protocol_->table, buffer_.data(), pos);
+}
+
+void I2sTransport::encodeLerp(const std::vector<PixelColor>& from, const std::vector<PixelColor>& to,
+                              uint16_t weight, uint16_t scale) {
+    const size_t pos = encodeHeader(to.size());
+    const I2sLerpEncodeFn fn = temporal_dither_ ? encoders_.lerp_dither : encoders_.lerp;
+    fn(from.data(), to.data(), to.size(), weight, scale, dither_residue_.data(),
+       protocol_->table, buffer_.data(), pos);
+}
+
+void I2sTransport::setTemporalDither(bool enabled) {
+    if (enabled && dither_residue_.empty()) {
+        // Staggered starting fractions so LEDs at the same level do not step in unison
+        dither_residue_.resize(static_cast<size_t>(pixel_count_) * static_cast<size_t>(format_));
+        for (size_t i = 0; i < dither_residue_.size(); ++i) {
+            dither_residue_[i] = static_cast<uint8_t>(i * 157);
+        }
+    }
+    temporal_dither_ = enabled;
+}
+
+std::span<const uint8_t> I2sTransport::encodedFrame() const noexcept {
+    // Dithered frames differ even for identical pixels
+    if (temporal_dither_) return {};
+    return buffer_;
+}
+
+void I2sTransport::loadEncodedFrame(std::span<const uint8_t> frame) {
+    std::copy_n(frame.begin(), std::min(frame.size(), buffer_.size()), buffer_.begin());
+}
+
+bool I2sTransport::prepare() {
+    bytes_sent_ = 0;
+    bytes_queued_ = 0;
+    idle_queued_ = 0;
+    resetFrameState();
+
+    // Fill the DMA buffers while the channel is idle so output starts with data
+    size_t bytes_loaded = 0;
+    const esp_err_t ret = i2s_channel_preload_data(channel_, buffer_.data(), buffer_.size(), &bytes_loaded);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "I2S preload failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+    bytes_queued_ = bytes_loaded;
+    return true;
+}
+
+bool I2sTransport::start() {
+    const esp_err_t ret = i2s_channel_enable(channel_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "I2S enable failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+    return true;
+}
+
+void I2sTransport::refill() {
+    // Never block the service task; the rest goes out on the next on_sent notification
+    size_t bytes_written = 0;
+    esp_err_t ret = ESP_OK;
+    if (bytes_queued_ < buffer_.size()) {
+        ret = i2s_channel_write(channel_, &buffer_[bytes_queued_],
+                                buffer_.size() - bytes_queued_, &bytes_written, 0);
+        bytes_queued_ += bytes_written;
+    } else if (idle_queued_ < idle_tail_.size()) {
+        // Whatever the ring reaches before the channel is disabled is at the idle level
+        // rather than a stale copy of the frame
+        ret = i2s_channel_write(channel_, &idle_tail_[idle_queued_],
+                                idle_tail_.size() - idle_queued_, &bytes_written, 0);
+        idle_queued_ = idle_queued_ + bytes_written;
+    }
+    if (ret != ESP_OK && ret != ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "I2S write error: %s", esp_err_to_name(ret));
+    }
+}
+
+bool I2sTransport::service() {
+    if (bytes_sent_ >= buffer_.size()) {
+        i2s_channel_disable(channel_);
+        return true;
+    }
+    refill();
+    return false;
+}
+
+void I2sTransport::abort() {
+    i2s_channel_disable(channel_);
+}
+
+int64_t I2sTransport::wireTimeUs() const noexcept {
+    return static_cast<int64_t>(buffer_.size()) * 8 * 1000000 / protocol_->profile->bitrate;
+}
+
+// ============= RmtTransport =============
+
+RmtTransport::RmtTransport(int32_t channel_id, const ChannelConfig& config)
+    : channel_id_(channel_id)
+    , pin_(config.pin)
+    , resolution_hz_(config.resolution_hz)
+    , protocol_(&getPixelProtocol(config.chipset))
+    , symbols_(makeRmtPixelSymbols(*protocol_->profile, config.resolution_hz))
+    , pack_fn_(selectRmtPacker(config.color_order, config.format)) {
+    frame_.resize(protocol_->header_len + static_cast<size_t>(config.pixel_count) * static_cast<size_t>(config.format));
+    if (protocol_->header_len > 0) {
+        std::copy(protocol_->header, protocol_->header + protocol_->header_len, frame_.begin());
+    }
+}
+
+RmtTransport::~RmtTransport() {
+    release();
+}
+
+IRAM_ATTR size_t RmtTransport::encodeSymbols(const void* data, size_t data_size, size_t symbols_written,
+                                             size_t symbols_free, rmt_symbol_word_t* symbols, bool* done, void* arg) {
+    const auto* self = static_cast<const RmtTransport*>(arg);
+    const size_t count = encodeRmtSymbols(self->symbols_, static_cast<const uint8_t*>(data), data_size,
+                                          symbols_written, reinterpret_cast<uint32_t*>(symbols), symbols_free);
+    *done = symbols_written + count >= rmtFrameSymbols(data_size);
+    return count;
+}
+
+IRAM_ATTR bool RmtTransport::onTransDone(rmt_channel_handle_t, const rmt_tx_done_event_data_t*, void* user_ctx) {
+    auto* self = static_cast<RmtTransport*>(user_ctx);
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    if (self && self->tx_task_) {
+        self->done_time_us_ = esp_timer_get_time();
+        xTaskNotifyFromISR(self->tx_task_, TransmitScheduler::bit(self->tx_slot_),
+                           eSetBits, &higher_priority_task_woken);
+    }
+    return higher_priority_task_woken == pdTRUE;
+}
+
+bool RmtTransport::initialize(TaskHandle_t tx_task, int32_t tx_slot) {
+    tx_task_ = tx_task;
+    tx_slot_ = tx_slot;
+
+    if (!rmtPixelSymbolsValid(*protocol_->profile, resolution_hz_)) {
+        ESP_LOGE(TAG, "Channel %ld: %s timing cannot be met at %lu Hz RMT resolution",
+                 channel_id_, protocol_->profile->name, resolution_hz_);
+        return false;
+    }
+
+    rmt_tx_channel_config_t chan_config = {};
+    chan_config.gpio_num = pin_;
+    chan_config.clk_src = RMT_CLK_SRC_DEFAULT;
+    chan_config.resolution_hz = resolution_hz_;
+    chan_config.mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL;
+    chan_config.trans_queue_depth = 1;
+
+    esp_err_t ret = rmt_new_tx_channel(&chan_config, &channel_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Channel %ld: no free RMT channel: %s", channel_id_, esp_err_to_name(ret));
+        return false;
+    }
+
+    rmt_simple_encoder_config_t encoder_config = {};
+    encoder_config.callback = encodeSymbols;
+    encoder_config.arg = this;
+    encoder_config.min_chunk_size = RMT_MIN_CHUNK_SYMBOLS;
+
+    ret = rmt_new_simple_encoder(&encoder_config, &encoder_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create RMT encoder: %s", esp_err_to_name(ret));
+        release();
+        return false;
+    }
+
+    rmt_tx_event_callbacks_t callbacks = {};
+    callbacks.on_trans_done = onTransDone;
+    ret = rmt_tx_register_event_callbacks(channel_, &callbacks, this);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register RMT callbacks: %s", esp_err_to_name(ret));
+        release();
+        return false;
+    }
+
+    ret = rmt_enable(channel_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "RMT enable failed: %s", esp_err_to_name(ret));
+        release();
+        return false;
+    }
+    enabled_ = true;
+
+    ESP_LOGI(TAG, "Channel %ld RMT: %s, %lu Hz, %u symbols/frame", channel_id_,
+             protocol_->profile->name, resolution_hz_, rmtFrameSymbols(frame_.size()));
+    return true;
+}
+
+void RmtTransport::release() {
+    if (enabled_) {
+        rmt_disable(channel_);
+        enabled_ = false;
+    }
+    if (encoder_) {
+        rmt_del_encoder(encoder_);
+        encoder_ = nullptr;
+    }
+    if (channel_) {
+        rmt_del_channel(channel_);
+        channel_ = nullptr;
+    }
+}
+
+void RmtTransport::encode(const std::vector<PixelColor>& pixels, uint16_t) {
+    // scale is unused: scalesOnEncode() is false, so the scaling pass already applied it
+    // Header values were written once by the constructor
+    pack_fn_(pixels.data(), pixels.size(), frame_.data() + protocol_->header_len);
+}
+
+void RmtTransport::loadEncodedFrame(std::span<const uint8_t> frame) {
+    std::copy_n(frame.begin(), std::min(frame.size(), frame_.size()), frame_.begin());
+}
+
+bool RmtTransport::prepare() {
+    // Symbols are generated while sending, nothing to stage
+    resetFrameState();
+    return true;
+}
+
+bool RmtTransport::start() {
+    rmt_transmit_config_t tx_config = {};
+    tx_config.loop_count = 0;
+    tx_config.flags.eot_level = protocol_->profile->inverted ? 1 : 0;
+
+    const esp_err_t ret = rmt_transmit(channel_, encoder_, frame_.data(), frame_.size(), &tx_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "RMT transmit failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+    sending_ = true;
+    return true;
+}
+
+bool RmtTransport::service() {
+    if (!sending_ || done_time_us_ == 0) return false;
+    sending_ = false;
+    return true;
+}
+
+void RmtTransport::abort() {
+    if (!sending_) return;
+
+    // Disabling the channel drops the pending transaction; the encoder restarts clean
+    rmt_disable(channel_);
+    rmt_encoder_reset(encoder_);
+    if (rmt_enable(channel_) != ESP_OK) {
+        ESP_LOGW(TAG, "Channel %ld: RMT re-enable failed", channel_id_);
+        enabled_ = false;
+    }
+    sending_ = false;
+}
+
+int64_t RmtTransport::wireTimeUs() const noexcept {
+    const uint64_t ticks = static_cast<uint64_t>(frame_.size()) * 8 * symbols_.bit_ticks + symbols_.reset_ticks;
+    return static_cast<int64_t>(ticks * 1000000 / std::max<uint32_t>(resolution_hz_, 1));
+}
+
+// ============= SpiTransport =============
+
+SpiTransport::SpiTransport(int32_t channel_id, const ChannelConfig& config)
+    : channel_id_(channel_id)
+    , data_pin_(config.pin)
+    , clock_pin_(config.clock_pin)
+    , clock_hz_(config.resolution_hz)
+    , chipset_(config.clocked_chipset)
+    , pack_fn_(selectClockedPacker<PixelColor>(config.clocked_chipset, config.color_order))
+    , pack16_fn_(selectClockedPacker<PixelColor16>(config.clocked_chipset, config.color_order))
+    , frame_bytes_(clockedFrameBytes(config.clocked_chipset, config.pixel_count)) {}
+
+SpiTransport::~SpiTransport() {
+    releaseBus();
+    if (buffer_) {
+        heap_caps_free(buffer_);
+        buffer_ = nullptr;
+    }
+}
+
+IRAM_ATTR void SpiTransport::onTransferDone(spi_transaction_t* transaction) {
+    auto* self = static_cast<SpiTransport*>(transaction->user);
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    if (self && self->tx_task_) {
+        self->done_time_us_ = esp_timer_get_time();
+        xTaskNotifyFromISR(self->tx_task_, TransmitScheduler::bit(self->tx_slot_),
+                           eSetBits, &higher_priority_task_woken);
+    }
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+bool SpiTransport::initialize(TaskHandle_t tx_task, int32_t tx_slot) {
+    tx_task_ = tx_task;
+    tx_slot_ = tx_slot;
+
+    if (clock_pin_ == GPIO_NUM_NC) {
+        ESP_LOGE(TAG, "Channel %ld: SPI strips need a clock pin", channel_id_);
+        return false;
+    }
+
+    // The SPI DMA reads the frame in place, so it must live in DMA-capable memory
+    const size_t alloc_bytes = (frame_bytes_ + 3) & ~size_t(3);
+    buffer_ = static_cast<uint8_t*>(heap_caps_malloc(alloc_bytes, MALLOC_CAP_DMA));
+    if (!buffer_) {
+        ESP_LOGE(TAG, "Channel %ld: no DMA memory for a %u byte frame", channel_id_, alloc_bytes);
+        return false;
+    }
+    std::fill(buffer_, buffer_ + alloc_bytes, uint8_t(0));
+
+    spi_bus_config_t bus_config = {};
+    bus_config.mosi_io_num = data_pin_;
+    bus_config.miso_io_num = -1;
+    bus_config.sclk_io_num = clock_pin_;
+    bus_config.quadwp_io_num = -1;
+    bus_config.quadhd_io_num = -1;
+    bus_config.max_transfer_sz = static_cast<int>(alloc_bytes);
+
+    // Each strip gets a bus of its own; take the first general purpose host still free
+    constexpr spi_host_device_t HOSTS[] = {
+        SPI2_HOST,
+#if SOC_SPI_PERIPH_NUM > 2
+        SPI3_HOST,
+#endif
+    };
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    for (const spi_host_device_t host : HOSTS) {
+        ret = spi_bus_initialize(host, &bus_config, SPI_DMA_CH_AUTO);
+        if (ret == ESP_OK) {
+            host_ = host;
+            bus_initialized_ = true;
+            break;
+        }
+    }
+    if (!bus_initialized_) {
+        ESP_LOGE(TAG, "Channel %ld: no free SPI host: %s", channel_id_, esp_err_to_name(ret));
+        return false;
+    }
+
+    spi_device_interface_config_t device_config = {};
+    device_config.mode = 0;
+    device_config.clock_speed_hz = static_cast<int>(clock_hz_);
+    device_config.spics_io_num = -1;
+    device_config.queue_size = 1;
+    device_config.flags = SPI_DEVICE_NO_DUMMY;
+    device_config.post_cb = onTransferDone;
+
+    ret = spi_bus_add_device(host_, &device_config, &device_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add SPI device: %s", esp_err_to_name(ret));
+        releaseBus();
+        return false;
+    }
+
+    transaction_ = {};
+    transaction_.length = frame_bytes_ * 8;
+    transaction_.tx_buffer = buffer_;
+    transaction_.user = this;
+
+    ESP_LOGI(TAG, "Channel %ld SPI%d: %s, %lu Hz, %u byte frame", channel_id_, host_ + 1,
+             clockedChipsetName(chipset_), clock_hz_, frame_bytes_);
+    return true;
+}
+
+void SpiTransport::releaseBus() {
+    if (device_) {
+        spi_bus_remove_device(device_);
+        device_ = nullptr;
+    }
+    if (bus_initialized_) {
+        spi_bus_free(host_);
+        bus_initialized_ = false;
+    }
+}
+
+void SpiTransport::encode(const std::vector<PixelColor>& pixels, uint16_t scale) {
+    packClockedFrame(pack_fn_, chipset_, pixels.data(), pixels.size(), scale, buffer_);
+}
+
+void SpiTransport::encode16(const std::vector<PixelColor16>& pixels, uint16_t scale) {
+    packClockedFrame(pack16_fn_, chipset_, pixels.data(), pixels.size(), scale, buffer_);
+}
+
+void SpiTransport::loadEncodedFrame(std::span<const uint8_t> frame) {
+    if (buffer_) {
+        std::copy_n(frame.begin(), std::min(frame.size(), frame_bytes_), buffer_);
+    }
+}
+
+bool SpiTransport::prepare() {
+    // The DMA streams straight from the frame buffer, nothing to stage. A transaction left
+    // over from an abort() still owns it: skip frames until it is collected.
+    if (inFlight()) return false;
+    resetFrameState();
+    return true;
+}
+
+bool SpiTransport::start() {
+    const esp_err_t ret = spi_device_queue_trans(device_, &transaction_, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPI queue failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+    queued_ = true;
+    return true;
+}
+
+bool SpiTransport::service() {
+    if (!queued_ || done_time_us_ == 0) return false;
+
+    spi_transaction_t* result = nullptr;
+    spi_device_get_trans_result(device_, &result, 0);
+    queued_ = false;
+    return true;
+}
+
+void SpiTransport::abort() {
+    if (!queued_) return;
+
+    // A queued SPI transaction cannot be cancelled; give it a last chance to finish
+    spi_transaction_t* result = nullptr;
+    if (spi_device_get_trans_result(device_, &result, pdMS_TO_TICKS(SPI_ABORT_WAIT_MS)) != ESP_OK) {
+        // queued_ stays set: inFlight() keeps the buffer untouched until the result comes back
+        ESP_LOGW(TAG, "Channel %ld: SPI transaction still pending", channel_id_);
+        return;
+    }
+    queued_ = false;
+}
+
+bool SpiTransport::inFlight() {
+    if (!queued_) return false;
+
+    spi_transaction_t* result = nullptr;
+    if (spi_device_get_trans_result(device_, &result, 0) == ESP_OK) {
+        queued_ = false;
+    }
+    return queued_;
+}
+
+int64_t SpiTransport::wireTimeUs() const noexcept {
+    return static_cast<int64_t>(frame_bytes_) * 8 * 1000000 / std::max<uint32_t>(clock_hz_, 1);
+}
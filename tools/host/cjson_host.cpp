@@ -0,0 +1,428 @@
+/* Host cJSON: parse, print and build items the way IDF's cJSON does (see cJSON.h). */
+#include "cJSON.h"
+
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <strings.h>
+
+namespace {
+
+constexpr int kNestingLimit = 1000;
+
+cJSON* newItem(int type) {
+    auto* item = static_cast<cJSON*>(std::calloc(1, sizeof(cJSON)));
+    if (item) item->type = type;
+    return item;
+}
+
+char* copyString(const char* s, size_t length) {
+    auto* copy = static_cast<char*>(std::malloc(length + 1));
+    if (!copy) return nullptr;
+    std::memcpy(copy, s, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+void setNumber(cJSON* item, double number) {
+    item->valuedouble = number;
+    if (number >= INT_MAX) {
+        item->valueint = INT_MAX;
+    } else if (number <= static_cast<double>(INT_MIN)) {
+        item->valueint = INT_MIN;
+    } else {
+        item->valueint = static_cast<int>(number);
+    }
+}
+
+void append(cJSON* parent, cJSON* item) {
+    if (!parent->child) {
+        parent->child = item;
+        item->prev = item;  // cJSON keeps the tail in the head's prev
+        return;
+    }
+    cJSON* tail = parent->child->prev;
+    tail->next = item;
+    item->prev = tail;
+    parent->child->prev = item;
+}
+
+// Parsing
+
+struct Parser {
+    const char* p;
+    const char* end;
+
+    void skipSpace() {
+        while (p < end && static_cast<unsigned char>(*p) <= 32) ++p;
+    }
+    bool consume(const char* word) {
+        const size_t n = std::strlen(word);
+        if (static_cast<size_t>(end - p) < n || std::strncmp(p, word, n) != 0) return false;
+        p += n;
+        return true;
+    }
+    bool hex4(unsigned& out) {
+        if (end - p < 4) return false;
+        out = 0;
+        for (int i = 0; i < 4; ++i, ++p) {
+            const char c = *p;
+            out <<= 4;
+            if (c >= '0' && c <= '9') out |= c - '0';
+            else if (c >= 'a' && c <= 'f') out |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') out |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+    static void utf8(std::string& out, unsigned cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    char* string() {
+        if (p >= end || *p != '"') return nullptr;
+        ++p;
+        std::string out;
+        while (p < end && *p != '"') {
+            if (*p != '\\') {
+                out += *p++;
+                continue;
+            }
+            if (++p >= end) return nullptr;
+            const char c = *p++;
+            switch (c) {
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case '"': case '\\': case '/': out += c; break;
+                case 'u': {
+                    unsigned cp;
+                    if (!hex4(cp)) return nullptr;
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        unsigned low;
+                        if (!consume("\\u") || !hex4(low) || low < 0xDC00 || low > 0xDFFF) return nullptr;
+                        cp = 0x10000 + (((cp & 0x3FF) << 10) | (low & 0x3FF));
+                    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                        return nullptr;
+                    }
+                    utf8(out, cp);
+                    break;
+                }
+                default: return nullptr;
+            }
+        }
+        if (p >= end) return nullptr;
+        ++p;
+        return copyString(out.data(), out.size());
+    }
+    cJSON* value(int depth) {
+        skipSpace();
+        if (p >= end) return nullptr;
+        if (consume("null")) return newItem(cJSON_NULL);
+        if (consume("false")) return newItem(cJSON_False);
+        if (consume("true")) {
+            cJSON* item = newItem(cJSON_True);
+            item->valueint = 1;
+            return item;
+        }
+        if (*p == '"') {
+            char* s = string();
+            if (!s) return nullptr;
+            cJSON* item = newItem(cJSON_String);
+            item->valuestring = s;
+            return item;
+        }
+        if (*p == '-' || (*p >= '0' && *p <= '9')) {
+            const std::string text(p, static_cast<size_t>(end - p) < 64 ? static_cast<size_t>(end - p) : 64);
+            char* after = nullptr;
+            const double number = std::strtod(text.c_str(), &after);
+            if (after == text.c_str()) return nullptr;
+            p += after - text.c_str();
+            cJSON* item = newItem(cJSON_Number);
+            setNumber(item, number);
+            return item;
+        }
+        if (*p == '[' || *p == '{') {
+            if (depth >= kNestingLimit) return nullptr;
+            const bool object = *p == '{';
+            const char close = object ? '}' : ']';
+            ++p;
+            cJSON* container = newItem(object ? cJSON_Object : cJSON_Array);
+            skipSpace();
+            if (p < end && *p == close) {
+                ++p;
+                return container;
+            }
+            while (true) {
+                char* key = nullptr;
+                if (object) {
+                    skipSpace();
+                    key = string();
+                    skipSpace();
+                    if (!key || p >= end || *p != ':') {
+                        std::free(key);
+                        cJSON_Delete(container);
+                        return nullptr;
+                    }
+                    ++p;
+                }
+                cJSON* child = value(depth + 1);
+                if (!child) {
+                    std::free(key);
+                    cJSON_Delete(container);
+                    return nullptr;
+                }
+                child->string = key;
+                append(container, child);
+                skipSpace();
+                if (p < end && *p == ',') {
+                    ++p;
+                    continue;
+                }
+                if (p < end && *p == close) {
+                    ++p;
+                    return container;
+                }
+                cJSON_Delete(container);
+                return nullptr;
+            }
+        }
+        return nullptr;
+    }
+};
+
+// Printing
+
+void printString(std::string& out, const char* s) {
+    out += '"';
+    for (const char* c = s ? s : ""; *c; ++c) {
+        switch (*c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(*c) < 32) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*c));
+                    out += escaped;
+                } else {
+                    out += *c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void printNumber(std::string& out, const cJSON* item) {
+    const double d = item->valuedouble;
+    char buffer[26];
+    if (std::isnan(d) || std::isinf(d)) {
+        std::snprintf(buffer, sizeof(buffer), "null");
+    } else if (d == static_cast<double>(item->valueint)) {
+        std::snprintf(buffer, sizeof(buffer), "%d", item->valueint);
+    } else {
+        // The shortest of 15 or 17 digits that reads back the same, as cJSON prints
+        std::snprintf(buffer, sizeof(buffer), "%1.15g", d);
+        if (std::strtod(buffer, nullptr) != d) std::snprintf(buffer, sizeof(buffer), "%1.17g", d);
+    }
+    out += buffer;
+}
+
+void printValue(std::string& out, const cJSON* item, int depth, bool format) {
+    switch (item->type & 0xFF) {
+        case cJSON_NULL: out += "null"; return;
+        case cJSON_False: out += "false"; return;
+        case cJSON_True: out += "true"; return;
+        case cJSON_Number: printNumber(out, item); return;
+        case cJSON_String: printString(out, item->valuestring); return;
+        case cJSON_Raw: out += item->valuestring ? item->valuestring : ""; return;
+        case cJSON_Array:
+            out += '[';
+            for (const cJSON* child = item->child; child; child = child->next) {
+                printValue(out, child, depth + 1, format);
+                if (child->next) out += format ? ", " : ",";
+            }
+            out += ']';
+            return;
+        case cJSON_Object:
+            out += '{';
+            if (format) out += '\n';
+            for (const cJSON* child = item->child; child; child = child->next) {
+                if (format) out.append(depth + 1, '\t');
+                printString(out, child->string);
+                out += format ? ":\t" : ":";
+                printValue(out, child, depth + 1, format);
+                if (child->next) out += ',';
+                if (format) out += '\n';
+            }
+            if (format) out.append(depth, '\t');
+            out += '}';
+            return;
+        default: return;
+    }
+}
+
+char* print(const cJSON* item, bool format) {
+    if (!item) return nullptr;
+    std::string out;
+    printValue(out, item, 0, format);
+    return copyString(out.data(), out.size());
+}
+
+cJSON* addToObject(cJSON* object, const char* name, cJSON* item) {
+    if (!cJSON_AddItemToObject(object, name, item)) {
+        cJSON_Delete(item);
+        return nullptr;
+    }
+    return item;
+}
+
+} // anonymous namespace
+
+cJSON* cJSON_Parse(const char* value) {
+    return value ? cJSON_ParseWithLength(value, std::strlen(value) + 1) : nullptr;
+}
+
+cJSON* cJSON_ParseWithLength(const char* value, size_t buffer_length) {
+    if (!value || buffer_length == 0) return nullptr;
+    Parser parser{value, value + buffer_length};
+    return parser.value(0);
+}
+
+char* cJSON_Print(const cJSON* item) {
+    return print(item, true);
+}
+
+char* cJSON_PrintUnformatted(const cJSON* item) {
+    return print(item, false);
+}
+
+void cJSON_Delete(cJSON* item) {
+    while (item) {
+        cJSON* next = item->next;
+        cJSON_Delete(item->child);
+        std::free(item->valuestring);
+        std::free(item->string);
+        std::free(item);
+        item = next;
+    }
+}
+
+int cJSON_GetArraySize(const cJSON* array) {
+    int size = 0;
+    if (array) {
+        for (const cJSON* child = array->child; child; child = child->next) ++size;
+    }
+    return size;
+}
+
+cJSON* cJSON_GetArrayItem(const cJSON* array, int index) {
+    if (!array || index < 0) return nullptr;
+    cJSON* child = array->child;
+    while (child && index-- > 0) child = child->next;
+    return child;
+}
+
+cJSON* cJSON_GetObjectItem(const cJSON* object, const char* string) {
+    if (!object || !string) return nullptr;
+    cJSON* child = object->child;
+    while (child && (!child->string || strcasecmp(child->string, string) != 0)) child = child->next;
+    return child;
+}
+
+cJSON* cJSON_GetObjectItemCaseSensitive(const cJSON* object, const char* string) {
+    if (!object || !string) return nullptr;
+    cJSON* child = object->child;
+    while (child && (!child->string || std::strcmp(child->string, string) != 0)) child = child->next;
+    return child;
+}
+
+cJSON_bool cJSON_IsInvalid(const cJSON* item) { return item && (item->type & 0xFF) == cJSON_Invalid; }
+cJSON_bool cJSON_IsFalse(const cJSON* item) { return item && (item->type & 0xFF) == cJSON_False; }
+cJSON_bool cJSON_IsTrue(const cJSON* item) { return item && (item->type & 0xFF) == cJSON_True; }
+cJSON_bool cJSON_IsBool(const cJSON* item) { return item && (item->type & (cJSON_True | cJSON_False)) != 0; }
+cJSON_bool cJSON_IsNull(const cJSON* item) { return item && (item->type & 0xFF) == cJSON_NULL; }
+cJSON_bool cJSON_IsNumber(const cJSON* item) { return item && (item->type & 0xFF) == cJSON_Number; }
+cJSON_bool cJSON_IsString(const cJSON* item) { return item && (item->type & 0xFF) == cJSON_String; }
+cJSON_bool cJSON_IsArray(const cJSON* item) { return item && (item->type & 0xFF) == cJSON_Array; }
+cJSON_bool cJSON_IsObject(const cJSON* item) { return item && (item->type & 0xFF) == cJSON_Object; }
+
+cJSON* cJSON_CreateNull() { return newItem(cJSON_NULL); }
+cJSON* cJSON_CreateTrue() { return newItem(cJSON_True); }
+cJSON* cJSON_CreateFalse() { return newItem(cJSON_False); }
+cJSON* cJSON_CreateBool(cJSON_bool boolean) { return newItem(boolean ? cJSON_True : cJSON_False); }
+cJSON* cJSON_CreateArray() { return newItem(cJSON_Array); }
+cJSON* cJSON_CreateObject() { return newItem(cJSON_Object); }
+
+cJSON* cJSON_CreateNumber(double num) {
+    cJSON* item = newItem(cJSON_Number);
+    if (item) setNumber(item, num);
+    return item;
+}
+
+cJSON* cJSON_CreateString(const char* string) {
+    cJSON* item = newItem(cJSON_String);
+    if (!item) return nullptr;
+    item->valuestring = copyString(string ? string : "", string ? std::strlen(string) : 0);
+    return item;
+}
+
+cJSON_bool cJSON_AddItemToArray(cJSON* array, cJSON* item) {
+    if (!array || !item || array == item) return 0;
+    append(array, item);
+    return 1;
+}
+
+cJSON_bool cJSON_AddItemToObject(cJSON* object, const char* string, cJSON* item) {
+    if (!object || !string || !item || object == item) return 0;
+    std::free(item->string);
+    item->string = copyString(string, std::strlen(string));
+    append(object, item);
+    return 1;
+}
+
+cJSON* cJSON_AddNullToObject(cJSON* object, const char* name) {
+    return addToObject(object, name, cJSON_CreateNull());
+}
+
+cJSON* cJSON_AddBoolToObject(cJSON* object, const char* name, cJSON_bool boolean) {
+    return addToObject(object, name, cJSON_CreateBool(boolean));
+}
+
+cJSON* cJSON_AddNumberToObject(cJSON* object, const char* name, double number) {
+    return addToObject(object, name, cJSON_CreateNumber(number));
+}
+
+cJSON* cJSON_AddStringToObject(cJSON* object, const char* name, const char* string) {
+    return addToObject(object, name, cJSON_CreateString(string));
+}
+
+cJSON* cJSON_AddObjectToObject(cJSON* object, const char* name) {
+    return addToObject(object, name, cJSON_CreateObject());
+}
+
+cJSON* cJSON_AddArrayToObject(cJSON* object, const char* name) {
+    return addToObject(object, name, cJSON_CreateArray());
+}
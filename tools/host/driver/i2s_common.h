@@ -0,0 +1,16 @@
+#pragma once
+
+#include "driver/i2s_types.h"
+
+// A simulated TX channel (tools/host/idf_host.cpp): the DMA ring drains one descriptor per
+// descriptor time at the configured sample rate, raising on_sent, or on_send_q_ovf when
+// nothing was queued, from the timer thread
+esp_err_t i2s_new_channel(const i2s_chan_config_t* config, i2s_chan_handle_t* tx, i2s_chan_handle_t* rx);
+esp_err_t i2s_del_channel(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_enable(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_disable(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_preload_data(i2s_chan_handle_t handle, const void* src, size_t size, size_t* loaded);
+esp_err_t i2s_channel_write(i2s_chan_handle_t handle, const void* src, size_t size, size_t* written,
+                            uint32_t timeout_ms);
+esp_err_t i2s_channel_register_event_callback(i2s_chan_handle_t handle, const i2s_event_callbacks_t* callbacks,
+                                              void* user_ctx);
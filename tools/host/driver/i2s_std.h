@@ -0,0 +1,47 @@
+#pragma once
+
+#include "driver/i2s_common.h"
+
+typedef enum { I2S_DATA_BIT_WIDTH_16BIT = 16 } i2s_data_bit_width_t;
+typedef enum { I2S_SLOT_MODE_MONO = 1, I2S_SLOT_MODE_STEREO = 2 } i2s_slot_mode_t;
+
+typedef struct {
+    uint32_t sample_rate_hz;
+    int clk_src;
+    int mclk_multiple;
+} i2s_std_clk_config_t;
+
+typedef struct {
+    int data_bit_width;
+    int slot_bit_width;
+    int slot_mode;
+    int slot_mask;
+    int ws_width;
+    bool ws_pol;
+    bool bit_shift;
+} i2s_std_slot_config_t;
+
+typedef struct {
+    bool mclk_inv;
+    bool bclk_inv;
+    bool ws_inv;
+} i2s_std_gpio_invert_t;
+
+typedef struct {
+    gpio_num_t mclk, bclk, ws, dout, din;
+    i2s_std_gpio_invert_t invert_flags;
+} i2s_std_gpio_config_t;
+
+typedef struct {
+    i2s_std_clk_config_t clk_cfg;
+    i2s_std_slot_config_t slot_cfg;
+    i2s_std_gpio_config_t gpio_cfg;
+} i2s_std_config_t;
+
+#define I2S_STD_CLK_DEFAULT_CONFIG(rate) { .sample_rate_hz = (uint32_t)(rate), .clk_src = 0, .mclk_multiple = 256 }
+#define I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(bits, mode) { \
+    .data_bit_width = bits, .slot_bit_width = 0, .slot_mode = mode, .slot_mask = 3, .ws_width = bits, \
+    .ws_pol = false, .bit_shift = true }
+
+// Byte rate from the sample rate and slot layout; the pins are ignored
+esp_err_t i2s_channel_init_std_mode(i2s_chan_handle_t handle, const i2s_std_config_t* config);
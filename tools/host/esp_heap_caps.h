@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+// Every host allocation qualifies for every capability
+void* heap_caps_malloc(size_t size, uint32_t caps);
+void heap_caps_free(void* ptr);
@@ -0,0 +1,102 @@
+#pragma once
+
+// Host build of the esp_http_server API the LED handlers use (tools/host/httpd_host.cpp):
+// one server task on loopback serving every connection, one request at a time.
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include <vector>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#define HTTPD_MAX_URI_LEN 512
+#define HTTPD_RESP_USE_STRLEN -1
+#define HTTPD_SOCK_ERR_FAIL -1
+#define HTTPD_SOCK_ERR_INVALID -2
+#define HTTPD_SOCK_ERR_TIMEOUT -3
+#define ESP_ERR_HTTPD_HANDLERS_FULL 0xb001
+#define ESP_ERR_HTTPD_HANDLER_EXISTS 0xb002
+
+typedef void* httpd_handle_t;
+
+typedef enum {
+    HTTP_DELETE = 0,
+    HTTP_GET = 1,
+    HTTP_HEAD = 2,
+    HTTP_POST = 3,
+    HTTP_PUT = 4,
+} httpd_method_t;
+
+typedef enum {
+    HTTPD_500_INTERNAL_SERVER_ERROR = 0,
+    HTTPD_501_METHOD_NOT_IMPLEMENTED,
+    HTTPD_505_VERSION_NOT_SUPPORTED,
+    HTTPD_400_BAD_REQUEST,
+    HTTPD_401_UNAUTHORIZED,
+    HTTPD_403_FORBIDDEN,
+    HTTPD_404_NOT_FOUND,
+    HTTPD_405_METHOD_NOT_ALLOWED,
+    HTTPD_408_REQ_TIMEOUT,
+    HTTPD_411_LENGTH_REQUIRED,
+    HTTPD_414_URI_TOO_LONG,
+    HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE,
+} httpd_err_code_t;
+
+typedef struct httpd_req {
+    httpd_handle_t handle;
+    int method;
+    char uri[HTTPD_MAX_URI_LEN + 1];
+    size_t content_len;
+    void* aux;  // The connection's request and response state
+    void* user_ctx;
+    void* sess_ctx;
+} httpd_req_t;
+
+typedef struct httpd_uri {
+    const char* uri;
+    httpd_method_t method;
+    esp_err_t (*handler)(httpd_req_t* req);
+    void* user_ctx;
+} httpd_uri_t;
+
+typedef bool (*httpd_uri_match_func_t)(const char* reference_uri, const char* uri_to_match, size_t match_upto);
+
+typedef struct {
+    unsigned task_priority;
+    size_t stack_size;
+    BaseType_t core_id;
+    uint16_t server_port;  // 0 picks a free port, see httpd_host_port()
+    uint16_t max_open_sockets;
+    uint16_t max_uri_handlers;
+    httpd_uri_match_func_t uri_match_fn;  // nullptr matches URIs exactly
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG() {          \
+    .task_priority = 5,                   \
+    .stack_size = 4096,                   \
+    .core_id = tskNO_AFFINITY,            \
+    .server_port = 80,                    \
+    .max_open_sockets = 7,                \
+    .max_uri_handlers = 8,                \
+    .uri_match_fn = nullptr,              \
+}
+
+esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config);
+esp_err_t httpd_stop(httpd_handle_t handle);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler);
+bool httpd_uri_match_wildcard(const char* reference_uri, const char* uri_to_match, size_t match_upto);
+
+int httpd_req_recv(httpd_req_t* req, char* buf, size_t buf_len);
+esp_err_t httpd_resp_set_status(httpd_req_t* req, const char* status);
+esp_err_t httpd_resp_set_type(httpd_req_t* req, const char* type);
+esp_err_t httpd_resp_send(httpd_req_t* req, const char* buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t* req, const char* buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_err(httpd_req_t* req, httpd_err_code_t error, const char* message);
+inline esp_err_t httpd_resp_send_500(httpd_req_t* req) {
+    return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
+}
+
+// Host only: the port the server listens on
+uint16_t httpd_host_port(httpd_handle_t handle);
+// Host only: how long each handler call took so far, in microseconds
+std::vector<int64_t> httpd_host_handler_us(httpd_handle_t handle);
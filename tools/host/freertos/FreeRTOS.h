@@ -0,0 +1,37 @@
+#pragma once
+
+// Host build of the FreeRTOS API the component uses, implemented in tools/host/idf_host.cpp.
+// Tasks are threads and a tick is a millisecond. Critical sections are mutexes rather than
+// spinlocks, so a SCHED_FIFO task cannot spin forever on one held by a task it preempted.
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFu)
+#define configMAX_PRIORITIES 25
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define IRAM_ATTR
+
+struct portMUX_TYPE {
+    std::mutex mutex;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
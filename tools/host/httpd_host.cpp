@@ -0,0 +1,336 @@
+/* Host esp_http_server: the server task, request parsing and the response calls the LED
+ * handlers make (see esp_http_server.h). Like the device server, a handler returning an
+ * error closes its connection.
+ */
+#include "esp_http_server.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+struct HostServer {
+    httpd_config_t config;
+    int listen_fd = -1;
+    uint16_t port = 0;
+    std::vector<httpd_uri_t> handlers;
+    TaskHandle_t task = nullptr;
+    std::atomic<bool> stopping{false};
+    std::mutex stats_lock;
+    std::vector<int64_t> handler_us;
+};
+
+// One request being handled, req->aux
+struct HostRequest {
+    int fd;
+    const char* body;
+    size_t body_read = 0;
+    std::string status = "200 OK";
+    std::string type = "text/html";
+    bool headers_sent = false;
+    bool failed = false;
+};
+
+bool sendAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        const ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+HostRequest& requestOf(httpd_req_t* req) {
+    return *static_cast<HostRequest*>(req->aux);
+}
+
+bool sendHeaders(HostRequest& request, const char* length_header) {
+    const std::string head = "HTTP/1.1 " + request.status + "\r\nContent-Type: " + request.type + "\r\n" +
+                             length_header + "\r\n\r\n";
+    request.headers_sent = true;
+    return sendAll(request.fd, head.data(), head.size());
+}
+
+httpd_method_t methodFromName(const std::string& name, bool& known) {
+    known = true;
+    if (name == "GET") return HTTP_GET;
+    if (name == "POST") return HTTP_POST;
+    if (name == "PUT") return HTTP_PUT;
+    if (name == "DELETE") return HTTP_DELETE;
+    if (name == "HEAD") return HTTP_HEAD;
+    known = false;
+    return HTTP_GET;
+}
+
+const char* statusLine(httpd_err_code_t error) {
+    switch (error) {
+        case HTTPD_400_BAD_REQUEST: return "400 Bad Request";
+        case HTTPD_401_UNAUTHORIZED: return "401 Unauthorized";
+        case HTTPD_403_FORBIDDEN: return "403 Forbidden";
+        case HTTPD_404_NOT_FOUND: return "404 Not Found";
+        case HTTPD_405_METHOD_NOT_ALLOWED: return "405 Method Not Allowed";
+        case HTTPD_408_REQ_TIMEOUT: return "408 Request Timeout";
+        case HTTPD_411_LENGTH_REQUIRED: return "411 Length Required";
+        case HTTPD_414_URI_TOO_LONG: return "414 URI Too Long";
+        case HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE: return "431 Request Header Fields Too Large";
+        case HTTPD_501_METHOD_NOT_IMPLEMENTED: return "501 Method Not Implemented";
+        case HTTPD_505_VERSION_NOT_SUPPORTED: return "505 Version Not Supported";
+        case HTTPD_500_INTERNAL_SERVER_ERROR:
+        default: return "500 Internal Server Error";
+    }
+}
+
+// Handler lookup and call; false closes the connection
+bool dispatch(HostServer& server, int fd, const std::string& method_name, const std::string& uri,
+              const char* body, size_t content_len) {
+    httpd_req_t req = {};
+    HostRequest request{fd, body};
+    req.handle = &server;
+    req.aux = &request;
+    req.content_len = content_len;
+    std::snprintf(req.uri, sizeof(req.uri), "%s", uri.c_str());
+
+    bool known = false;
+    const httpd_method_t method = methodFromName(method_name, known);
+    req.method = method;
+    const size_t match_upto = std::min(uri.find('?'), uri.size());
+    const httpd_uri_t* handler = nullptr;
+    bool uri_found = false;
+    for (const httpd_uri_t& candidate : server.handlers) {
+        const bool matches = server.config.uri_match_fn
+            ? server.config.uri_match_fn(candidate.uri, req.uri, match_upto)
+            : std::strlen(candidate.uri) == match_upto && std::strncmp(candidate.uri, req.uri, match_upto) == 0;
+        if (!matches) continue;
+        uri_found = true;
+        if (known && candidate.method == method) {
+            handler = &candidate;
+            break;
+        }
+    }
+    if (!handler) {
+        httpd_resp_send_err(&req, uri_found ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND,
+                            uri_found ? "Request method for this URI is not handled by server"
+                                      : "This URI does not exist");
+        return false;
+    }
+
+    req.user_ctx = handler->user_ctx;
+    const int64_t start_us = esp_timer_get_time();
+    const esp_err_t ret = handler->handler(&req);
+    {
+        std::lock_guard<std::mutex> lock(server.stats_lock);
+        server.handler_us.push_back(esp_timer_get_time() - start_us);
+    }
+    return ret == ESP_OK && !request.failed;
+}
+
+void serverTask(void* param) {
+    auto& server = *static_cast<HostServer*>(param);
+    struct Client {
+        int fd;
+        std::string in;
+    };
+    std::vector<Client> clients;
+    while (!server.stopping) {
+        std::vector<pollfd> fds{{server.listen_fd, POLLIN, 0}};
+        for (const Client& c : clients) fds.push_back({c.fd, POLLIN, 0});
+        if (::poll(fds.data(), fds.size(), 50) <= 0) continue;
+
+        if (fds[0].revents & POLLIN) {
+            const int fd = ::accept(server.listen_fd, nullptr, nullptr);
+            if (fd >= 0 && clients.size() < server.config.max_open_sockets) {
+                const int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                clients.push_back({fd, {}});
+            } else if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        for (size_t i = 1; i < fds.size(); ++i) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            Client& client = clients[i - 1];
+            char chunk[4096];
+            const ssize_t n = ::recv(client.fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                ::close(client.fd);
+                client.fd = -1;
+                continue;
+            }
+            client.in.append(chunk, static_cast<size_t>(n));
+
+            // Every complete request in the buffer
+            size_t header_end;
+            while (client.fd >= 0 && (header_end = client.in.find("\r\n\r\n")) != std::string::npos) {
+                size_t content_len = 0;
+                for (size_t line = client.in.find("\r\n"); line < header_end; line = client.in.find("\r\n", line + 2)) {
+                    if (strncasecmp(client.in.c_str() + line + 2, "Content-Length:", 15) == 0) {
+                        content_len = std::strtoul(client.in.c_str() + line + 17, nullptr, 10);
+                    }
+                }
+                if (client.in.size() < header_end + 4 + content_len) break;
+
+                const size_t method_end = client.in.find(' ');
+                const size_t uri_end = client.in.find(' ', method_end + 1);
+                const std::string method = client.in.substr(0, method_end);
+                const std::string uri = client.in.substr(method_end + 1, uri_end - method_end - 1);
+                const bool keep = dispatch(server, client.fd, method, uri, client.in.data() + header_end + 4,
+                                           content_len);
+                client.in.erase(0, header_end + 4 + content_len);
+                if (!keep) {
+                    ::close(client.fd);
+                    client.fd = -1;
+                }
+            }
+        }
+        std::erase_if(clients, [](const Client& c) { return c.fd < 0; });
+    }
+    for (const Client& c : clients) ::close(c.fd);
+    vTaskDelete(nullptr);
+}
+
+} // anonymous namespace
+
+esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config) {
+    auto* server = new HostServer;
+    server->config = *config;
+    server->listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    const int one = 1;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(config->server_port);
+    socklen_t len = sizeof(addr);
+    if (server->listen_fd < 0 || ::bind(server->listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(server->listen_fd, 16) != 0 ||
+        getsockname(server->listen_fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        if (server->listen_fd >= 0) ::close(server->listen_fd);
+        delete server;
+        return ESP_FAIL;
+    }
+    server->port = ntohs(addr.sin_port);
+    xTaskCreatePinnedToCore(serverTask, "httpd", static_cast<uint32_t>(config->stack_size), server,
+                            config->task_priority, &server->task, config->core_id);
+    *handle = server;
+    return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle) {
+    auto* server = static_cast<HostServer*>(handle);
+    if (!server) return ESP_ERR_INVALID_ARG;
+    server->stopping = true;
+    vTaskDelete(server->task);
+    ::close(server->listen_fd);
+    delete server;
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler) {
+    auto* server = static_cast<HostServer*>(handle);
+    if (!server || !uri_handler) return ESP_ERR_INVALID_ARG;
+    for (const httpd_uri_t& existing : server->handlers) {
+        if (existing.method == uri_handler->method && std::strcmp(existing.uri, uri_handler->uri) == 0) {
+            return ESP_ERR_HTTPD_HANDLER_EXISTS;
+        }
+    }
+    if (server->handlers.size() >= server->config.max_uri_handlers) return ESP_ERR_HTTPD_HANDLERS_FULL;
+    server->handlers.push_back(*uri_handler);
+    return ESP_OK;
+}
+
+// A trailing * matches any rest, including none after a final /; a trailing ? makes the
+// character before it optional
+bool httpd_uri_match_wildcard(const char* reference_uri, const char* uri_to_match, size_t match_upto) {
+    const size_t ref_len = std::strlen(reference_uri);
+    if (ref_len > 0 && reference_uri[ref_len - 1] == '*') {
+        size_t prefix = ref_len - 1;
+        if (match_upto >= prefix) return std::strncmp(reference_uri, uri_to_match, prefix) == 0;
+        if (prefix > 0 && reference_uri[prefix - 1] == '/') --prefix;
+        return match_upto == prefix && std::strncmp(reference_uri, uri_to_match, prefix) == 0;
+    }
+    if (ref_len > 0 && reference_uri[ref_len - 1] == '?') {
+        const size_t exact = ref_len - 1;
+        if (match_upto == exact) return std::strncmp(reference_uri, uri_to_match, exact) == 0;
+        return match_upto + 1 == exact && std::strncmp(reference_uri, uri_to_match, match_upto) == 0;
+    }
+    return ref_len == match_upto && std::strncmp(reference_uri, uri_to_match, match_upto) == 0;
+}
+
+int httpd_req_recv(httpd_req_t* req, char* buf, size_t buf_len) {
+    HostRequest& request = requestOf(req);
+    const size_t n = std::min(buf_len, req->content_len - request.body_read);
+    std::memcpy(buf, request.body + request.body_read, n);
+    request.body_read += n;
+    return static_cast<int>(n);
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t* req, const char* status) {
+    requestOf(req).status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t* req, const char* type) {
+    requestOf(req).type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t* req, const char* buf, ssize_t buf_len) {
+    HostRequest& request = requestOf(req);
+    if (request.headers_sent) return ESP_ERR_INVALID_STATE;
+    const size_t length = buf_len == HTTPD_RESP_USE_STRLEN ? (buf ? std::strlen(buf) : 0) : static_cast<size_t>(buf_len);
+    const std::string length_header = "Content-Length: " + std::to_string(length);
+    if (!sendHeaders(request, length_header.c_str()) || !sendAll(request.fd, buf, length)) {
+        request.failed = true;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t* req, const char* buf, ssize_t buf_len) {
+    HostRequest& request = requestOf(req);
+    if (!request.headers_sent && !sendHeaders(request, "Transfer-Encoding: chunked")) {
+        request.failed = true;
+        return ESP_FAIL;
+    }
+    const size_t length = buf_len == HTTPD_RESP_USE_STRLEN ? (buf ? std::strlen(buf) : 0) : static_cast<size_t>(buf_len);
+    char size_line[16];
+    const int n = std::snprintf(size_line, sizeof(size_line), "%zx\r\n", length);
+    if (!sendAll(request.fd, size_line, static_cast<size_t>(n)) || (length && !sendAll(request.fd, buf, length)) ||
+        !sendAll(request.fd, "\r\n", 2)) {
+        request.failed = true;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t* req, httpd_err_code_t error, const char* message) {
+    HostRequest& request = requestOf(req);
+    request.status = statusLine(error);
+    request.type = "text/html";
+    return httpd_resp_send(req, message ? message : request.status.c_str(), HTTPD_RESP_USE_STRLEN);
+}
+
+uint16_t httpd_host_port(httpd_handle_t handle) {
+    return static_cast<HostServer*>(handle)->port;
+}
+
+std::vector<int64_t> httpd_host_handler_us(httpd_handle_t handle) {
+    auto* server = static_cast<HostServer*>(handle);
+    std::lock_guard<std::mutex> lock(server->stats_lock);
+    return server->handler_us;
+}
@@ -0,0 +1,749 @@
+/* Host implementation of the ESP-IDF and FreeRTOS calls the component makes, so the real
+ * src/ files build and run in the host tools (see tools/pixload.cpp, tools/pixpipe.cpp)
+ *
+ * Every blocking primitive waits on one kernel lock and condition variable. A task deleted
+ * by another leaves at its next blocking call by unwinding to its thread entry, and
+ * vTaskDelete() returns once it has. The I2S channel is simulated on the timer thread;
+ * RMT and SPI are not, and fail to initialize.
+ */
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "driver/i2s_std.h"
+#include "driver/rmt_tx.h"
+#include "driver/spi_master.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <pthread.h>
+#include <random>
+#include <sched.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============= Kernel =============
+
+struct tskTaskControlBlock {
+    std::string name;
+    uint32_t notify_value = 0;
+    bool notified = false;
+    bool deleted = false;
+    bool exited = false;
+};
+
+struct QueueDefinition {
+    uint32_t count;
+};
+
+struct EventGroupDef_t {
+    struct Waiter {
+        EventBits_t bits;
+        bool wait_for_all;
+        bool clear_on_exit;
+        bool released = false;
+        EventBits_t result = 0;
+    };
+
+    EventBits_t bits = 0;
+    std::vector<Waiter*> waiters;
+};
+
+namespace {
+
+struct Kernel {
+    std::mutex lock;
+    std::condition_variable changed;
+};
+
+// Never destroyed: detached task threads may still be waiting on it at exit
+Kernel& kernel() {
+    static Kernel* instance = new Kernel;
+    return *instance;
+}
+
+// Unwinds a deleted task to its thread entry
+struct TaskExit {};
+
+// Threads that were not created as tasks get a control block on first use. Blocks are
+// never freed, so a late notify to a task that has ended is harmless.
+thread_local TaskHandle_t current_task = nullptr;
+
+// Waits until ready() or the timeout; a deleted task leaves from here
+template <typename Ready>
+bool block(std::unique_lock<std::mutex>& lock, TickType_t ticks, Ready ready) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    const auto wake = [&] { return self->deleted || ready(); };
+    if (ticks == portMAX_DELAY) {
+        kernel().changed.wait(lock, wake);
+    } else {
+        kernel().changed.wait_for(lock, std::chrono::milliseconds(ticks), wake);
+    }
+    if (self->deleted) throw TaskExit{};
+    return ready();
+}
+
+// Pin and prioritize as the host allows; without the privilege the thread stays as it is
+void placeThread(std::thread& thread, UBaseType_t priority, BaseType_t core) {
+    if (core != tskNO_AFFINITY && core >= 0 && static_cast<unsigned>(core) < std::thread::hardware_concurrency()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+    }
+    if (priority > 0) {
+        sched_param param{};
+        param.sched_priority = std::min<int>(static_cast<int>(priority), sched_get_priority_max(SCHED_FIFO));
+        pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param);
+    }
+}
+
+} // anonymous namespace
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    (void)stack_depth;
+    auto* task = new tskTaskControlBlock;
+    task->name = name ? name : "";
+    if (handle) *handle = task;  // Before the task can run, as on FreeRTOS
+
+    std::thread thread([task, fn, param] {
+        current_task = task;
+        try {
+            fn(param);
+        } catch (const TaskExit&) {
+        }
+        std::lock_guard<std::mutex> lock(kernel().lock);
+        task->exited = true;
+        kernel().changed.notify_all();
+    });
+    placeThread(thread, priority, core);
+    thread.detach();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(kernel().lock);
+    if (!task || task == self) {
+        self->deleted = true;
+        throw TaskExit{};
+    }
+    task->deleted = true;
+    kernel().changed.notify_all();
+    kernel().changed.wait(lock, [task] { return task->exited; });
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel().lock);
+    block(lock, ticks, [] { return false; });
+}
+
+TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(esp_timer_get_time() / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (!current_task) {
+        current_task = new tskTaskControlBlock;
+        current_task->name = "host";
+    }
+    return current_task;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    std::lock_guard<std::mutex> lock(kernel().lock);
+    switch (action) {
+        case eSetBits:
+            task->notify_value |= value;
+            break;
+        case eIncrement:
+            ++task->notify_value;
+            break;
+        case eSetValueWithOverwrite:
+            task->notify_value = value;
+            break;
+        case eSetValueWithoutOverwrite:
+            if (task->notified) return pdFAIL;
+            task->notify_value = value;
+            break;
+        case eNoAction:
+            break;
+    }
+    task->notified = true;
+    kernel().changed.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value, TickType_t ticks) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(kernel().lock);
+    if (!self->notified) self->notify_value &= ~clear_on_entry;
+    const bool received = block(lock, ticks, [self] { return self->notified; });
+    if (value) *value = self->notify_value;
+    if (!received) return pdFALSE;
+    self->notify_value &= ~clear_on_exit;
+    self->notified = false;
+    return pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(kernel().lock);
+    block(lock, ticks, [self] { return self->notify_value != 0; });
+    const uint32_t value = self->notify_value;
+    if (value != 0) self->notify_value = clear_on_exit ? 0 : value - 1;
+    self->notified = false;
+    return value;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new QueueDefinition{1};
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return new QueueDefinition{0};
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel().lock);
+    if (!block(lock, ticks, [semaphore] { return semaphore->count > 0; })) return pdFALSE;
+    --semaphore->count;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    std::lock_guard<std::mutex> lock(kernel().lock);
+    if (semaphore->count > 0) return pdFALSE;
+    ++semaphore->count;
+    kernel().changed.notify_all();
+    return pdTRUE;
+}
+
+EventGroupHandle_t xEventGroupCreate() {
+    return new EventGroupDef_t;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group) {
+    delete group;
+}
+
+namespace {
+bool eventBitsMet(EventBits_t current, EventBits_t wanted, bool all) {
+    return all ? (current & wanted) == wanted : (current & wanted) != 0;
+}
+} // anonymous namespace
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    std::lock_guard<std::mutex> lock(kernel().lock);
+    group->bits |= bits;
+    EventBits_t clear = 0;
+    for (EventGroupDef_t::Waiter* waiter : group->waiters) {
+        if (waiter->released || !eventBitsMet(group->bits, waiter->bits, waiter->wait_for_all)) continue;
+        waiter->released = true;
+        waiter->result = group->bits;
+        if (waiter->clear_on_exit) clear |= waiter->bits;
+    }
+    group->bits &= ~clear;
+    kernel().changed.notify_all();
+    return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    std::lock_guard<std::mutex> lock(kernel().lock);
+    const EventBits_t before = group->bits;
+    group->bits &= ~bits;
+    return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    std::lock_guard<std::mutex> lock(kernel().lock);
+    return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(kernel().lock);
+    if (eventBitsMet(group->bits, bits, wait_for_all)) {
+        const EventBits_t result = group->bits;
+        if (clear_on_exit) group->bits &= ~bits;
+        return result;
+    }
+
+    EventGroupDef_t::Waiter waiter{bits, wait_for_all == pdTRUE, clear_on_exit == pdTRUE};
+    group->waiters.push_back(&waiter);
+    struct Unlink {
+        EventGroupDef_t* group;
+        EventGroupDef_t::Waiter* waiter;
+        ~Unlink() { std::erase(group->waiters, waiter); }
+    } unlink{group, &waiter};
+    return block(lock, ticks, [&waiter] { return waiter.released; }) ? waiter.result : group->bits;
+}
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+    mux->mutex.lock();
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+    mux->mutex.unlock();
+}
+
+// ============= esp_timer =============
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    int64_t due_us = -1;  // -1 while disarmed
+    uint64_t period_us = 0;
+};
+
+namespace {
+
+struct TimerService {
+    std::vector<esp_timer*> timers;
+    esp_timer* running = nullptr;  // Callback in progress
+    std::thread::id thread_id;
+};
+
+TimerService& timerService() {
+    static TimerService* instance = new TimerService;
+    return *instance;
+}
+
+// The esp_timer task: due callbacks one at a time, outside the kernel lock
+void runTimers() {
+    TimerService& service = timerService();
+    std::unique_lock<std::mutex> lock(kernel().lock);
+    while (true) {
+        esp_timer* next = nullptr;
+        for (esp_timer* timer : service.timers) {
+            if (timer->due_us >= 0 && (!next || timer->due_us < next->due_us)) next = timer;
+        }
+        if (!next) {
+            kernel().changed.wait(lock);
+            continue;
+        }
+        const int64_t now_us = esp_timer_get_time();
+        if (next->due_us > now_us) {
+            kernel().changed.wait_for(lock, std::chrono::microseconds(next->due_us - now_us));
+            continue;
+        }
+        next->due_us = next->period_us ? next->due_us + static_cast<int64_t>(next->period_us) : -1;
+        service.running = next;
+        lock.unlock();
+        next->callback(next->arg);
+        lock.lock();
+        service.running = nullptr;
+        kernel().changed.notify_all();
+    }
+}
+
+// Caller holds the kernel lock
+void waitForCallback(std::unique_lock<std::mutex>& lock, esp_timer_handle_t timer) {
+    TimerService& service = timerService();
+    if (std::this_thread::get_id() == service.thread_id) return;
+    kernel().changed.wait(lock, [&] { return service.running != timer; });
+}
+
+} // anonymous namespace
+
+int64_t esp_timer_get_time() {
+    using namespace std::chrono;
+    static const steady_clock::time_point boot = steady_clock::now();
+    return duration_cast<microseconds>(steady_clock::now() - boot).count();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* timer) {
+    if (!args || !args->callback || !timer) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(kernel().lock);
+    TimerService& service = timerService();
+    if (service.thread_id == std::thread::id{}) {
+        std::thread thread(runTimers);
+        service.thread_id = thread.get_id();
+        thread.detach();
+    }
+    *timer = new esp_timer{args->callback, args->arg};
+    service.timers.push_back(*timer);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    std::lock_guard<std::mutex> lock(kernel().lock);
+    if (timer->due_us >= 0) return ESP_ERR_INVALID_STATE;
+    timer->due_us = esp_timer_get_time() + static_cast<int64_t>(timeout_us);
+    timer->period_us = 0;
+    kernel().changed.notify_all();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    if (period_us == 0) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(kernel().lock);
+    if (timer->due_us >= 0) return ESP_ERR_INVALID_STATE;
+    timer->due_us = esp_timer_get_time() + static_cast<int64_t>(period_us);
+    timer->period_us = period_us;
+    kernel().changed.notify_all();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    std::unique_lock<std::mutex> lock(kernel().lock);
+    const bool armed = timer->due_us >= 0;
+    timer->due_us = -1;
+    waitForCallback(lock, timer);
+    return armed ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    std::unique_lock<std::mutex> lock(kernel().lock);
+    if (timer->due_us >= 0) return ESP_ERR_INVALID_STATE;
+    waitForCallback(lock, timer);
+    std::erase(timerService().timers, timer);
+    delete timer;
+    return ESP_OK;
+}
+
+// ============= I2S =============
+
+struct i2s_channel_obj_t {
+    std::mutex lock;  // Between the DMA callback and the driver calls
+    uint32_t desc_num;
+    uint32_t frame_num;
+    uint32_t desc_bytes = 0;
+    uint32_t bytes_per_s = 0;
+    i2s_event_callbacks_t callbacks{};
+    void* user_ctx = nullptr;
+    esp_timer_handle_t dma = nullptr;
+    std::vector<uint8_t> descriptor;  // Handed to the callbacks as the sent buffer
+    size_t queued = 0;                // Bytes in the ring not sent yet
+    bool enabled = false;
+};
+
+namespace {
+
+constexpr uint32_t I2S_MAX_DESC_BYTES = 4092;
+
+// One descriptor went out: whatever was queued, or a repeat once the ring ran dry
+void i2sDmaTick(void* arg) {
+    auto* channel = static_cast<i2s_channel_obj_t*>(arg);
+    bool underflow;
+    {
+        std::lock_guard<std::mutex> lock(channel->lock);
+        if (!channel->enabled) return;
+        underflow = channel->queued == 0;
+        channel->queued -= std::min<size_t>(channel->queued, channel->desc_bytes);
+    }
+    i2s_event_data_t event{channel->descriptor.data(), channel->desc_bytes};
+    if (underflow && channel->callbacks.on_send_q_ovf) {
+        channel->callbacks.on_send_q_ovf(channel, &event, channel->user_ctx);
+    }
+    if (channel->callbacks.on_sent) channel->callbacks.on_sent(channel, &event, channel->user_ctx);
+}
+
+} // anonymous namespace
+
+esp_err_t i2s_new_channel(const i2s_chan_config_t* config, i2s_chan_handle_t* tx, i2s_chan_handle_t* rx) {
+    if (!config || !tx || rx || config->dma_desc_num < 2 || config->dma_frame_num == 0) return ESP_ERR_INVALID_ARG;
+    auto* channel = new i2s_channel_obj_t;
+    channel->desc_num = config->dma_desc_num;
+    channel->frame_num = config->dma_frame_num;
+    esp_timer_create_args_t args = {};
+    args.callback = i2sDmaTick;
+    args.arg = channel;
+    args.name = "i2s_dma";
+    esp_timer_create(&args, &channel->dma);
+    *tx = channel;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_init_std_mode(i2s_chan_handle_t handle, const i2s_std_config_t* config) {
+    const uint32_t bytes_per_frame = static_cast<uint32_t>(config->slot_cfg.slot_mode) *
+                                     static_cast<uint32_t>(config->slot_cfg.data_bit_width) / 8;
+    const uint32_t desc_bytes = handle->frame_num * bytes_per_frame;
+    if (bytes_per_frame == 0 || desc_bytes > I2S_MAX_DESC_BYTES || config->clk_cfg.sample_rate_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    handle->desc_bytes = desc_bytes;
+    handle->bytes_per_s = config->clk_cfg.sample_rate_hz * bytes_per_frame;
+    handle->descriptor.assign(desc_bytes, 0);
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_register_event_callback(i2s_chan_handle_t handle, const i2s_event_callbacks_t* callbacks,
+                                              void* user_ctx) {
+    std::lock_guard<std::mutex> lock(handle->lock);
+    if (handle->enabled) return ESP_ERR_INVALID_STATE;
+    handle->callbacks = *callbacks;
+    handle->user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_preload_data(i2s_chan_handle_t handle, const void* src, size_t size, size_t* loaded) {
+    (void)src;
+    std::lock_guard<std::mutex> lock(handle->lock);
+    if (handle->enabled) return ESP_ERR_INVALID_STATE;
+    const size_t n = std::min(size, size_t(handle->desc_num) * handle->desc_bytes - handle->queued);
+    handle->queued += n;
+    *loaded = n;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_enable(i2s_chan_handle_t handle) {
+    {
+        std::lock_guard<std::mutex> lock(handle->lock);
+        if (handle->enabled || handle->desc_bytes == 0) return ESP_ERR_INVALID_STATE;
+        handle->enabled = true;
+    }
+    const uint64_t desc_us = std::max<uint64_t>(uint64_t(handle->desc_bytes) * 1000000 / handle->bytes_per_s, 1);
+    return esp_timer_start_periodic(handle->dma, desc_us);
+}
+
+esp_err_t i2s_channel_disable(i2s_chan_handle_t handle) {
+    {
+        std::lock_guard<std::mutex> lock(handle->lock);
+        if (!handle->enabled) return ESP_ERR_INVALID_STATE;
+        handle->enabled = false;
+        handle->queued = 0;
+    }
+    esp_timer_stop(handle->dma);
+    return ESP_OK;
+}
+
+// Never blocks: queues what fits and times out on the rest
+esp_err_t i2s_channel_write(i2s_chan_handle_t handle, const void* src, size_t size, size_t* written,
+                            uint32_t timeout_ms) {
+    (void)src;
+    (void)timeout_ms;
+    std::lock_guard<std::mutex> lock(handle->lock);
+    const size_t n = std::min(size, size_t(handle->desc_num) * handle->desc_bytes - handle->queued);
+    handle->queued += n;
+    if (written) *written = n;
+    return n == size ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t i2s_del_channel(i2s_chan_handle_t handle) {
+    i2s_channel_disable(handle);
+    esp_timer_delete(handle->dma);
+    delete handle;
+    return ESP_OK;
+}
+
+// ============= RMT and SPI: not simulated =============
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t*, rmt_channel_handle_t*) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t, const rmt_tx_event_callbacks_t*, void*) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+esp_err_t rmt_transmit(rmt_channel_handle_t, rmt_encoder_handle_t, const void*, size_t, const rmt_transmit_config_t*) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+esp_err_t rmt_new_simple_encoder(const rmt_simple_encoder_config_t*, rmt_encoder_handle_t*) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t) { return ESP_ERR_INVALID_STATE; }
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t) { return ESP_ERR_INVALID_STATE; }
+esp_err_t rmt_enable(rmt_channel_handle_t) { return ESP_ERR_INVALID_STATE; }
+esp_err_t rmt_disable(rmt_channel_handle_t) { return ESP_ERR_INVALID_STATE; }
+esp_err_t rmt_del_channel(rmt_channel_handle_t) { return ESP_ERR_INVALID_STATE; }
+
+esp_err_t spi_bus_initialize(spi_host_device_t, const spi_bus_config_t*, spi_dma_chan_t) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t spi_bus_free(spi_host_device_t) { return ESP_ERR_INVALID_STATE; }
+esp_err_t spi_bus_add_device(spi_host_device_t, const spi_device_interface_config_t*, spi_device_handle_t*) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+esp_err_t spi_bus_remove_device(spi_device_handle_t) { return ESP_ERR_INVALID_STATE; }
+esp_err_t spi_device_queue_trans(spi_device_handle_t, spi_transaction_t*, TickType_t) { return ESP_ERR_INVALID_STATE; }
+esp_err_t spi_device_get_trans_result(spi_device_handle_t, spi_transaction_t**, TickType_t) {
+    return ESP_ERR_INVALID_STATE;
+}
+
+// ============= System =============
+
+namespace {
+std::atomic<esp_log_level_t> log_level{ESP_LOG_INFO};
+
+// The sources format int32_t as %ld, which is right on the ESP32 where long is 32 bits;
+// dropping a single l keeps the arguments as the ints they are here
+std::string narrowLongs(const char* format) {
+    std::string out;
+    for (const char* p = format; *p; ++p) {
+        out += *p;
+        if (*p != '%') continue;
+        while (p[1] && std::strchr("-+ #0123456789.*", p[1])) out += *++p;
+        if (p[1] == 'l' && p[2] != 'l') ++p;
+    }
+    return out;
+}
+} // anonymous namespace
+
+void esp_log_level_set(const char* tag, esp_log_level_t level) {
+    if (std::strcmp(tag, "*") == 0) log_level = level;
+}
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+    if (level > log_level) return;
+    static constexpr char LETTERS[] = "NEWIDV";
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(message, sizeof(message), narrowLongs(format).c_str(), args);
+    va_end(args);
+    std::fprintf(stderr, "%c (%lld) %s: %s\n", LETTERS[level], static_cast<long long>(esp_timer_get_time() / 1000),
+                 tag, message);
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+uint32_t esp_random() {
+    static std::mutex lock;
+    static std::mt19937 rng{std::random_device{}()};
+    std::lock_guard<std::mutex> guard(lock);
+    return static_cast<uint32_t>(rng());
+}
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    return std::malloc(size);
+}
+
+void heap_caps_free(void* ptr) {
+    std::free(ptr);
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t, esp_partition_subtype_t, const char*) {
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t*, size_t, void*, size_t) {
+    return ESP_ERR_NOT_FOUND;
+}
+
+// ============= NVS =============
+
+namespace {
+
+struct NvsStore {
+    std::mutex lock;
+    std::map<std::string, std::map<std::string, std::vector<uint8_t>>> namespaces;
+    std::map<nvs_handle_t, std::pair<std::string, bool>> handles;  // -> namespace, writable
+    nvs_handle_t next_handle = 1;
+};
+
+NvsStore& nvsStore() {
+    static NvsStore store;
+    return store;
+}
+
+esp_err_t nvsSet(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+    NvsStore& store = nvsStore();
+    std::lock_guard<std::mutex> lock(store.lock);
+    const auto it = store.handles.find(handle);
+    if (it == store.handles.end()) return ESP_ERR_INVALID_ARG;
+    if (!it->second.second) return ESP_ERR_INVALID_STATE;
+    const auto* bytes = static_cast<const uint8_t*>(value);
+    store.namespaces[it->second.first][key].assign(bytes, bytes + length);
+    return ESP_OK;
+}
+
+// out == nullptr asks for the length
+esp_err_t nvsGet(nvs_handle_t handle, const char* key, void* out, size_t* length) {
+    NvsStore& store = nvsStore();
+    std::lock_guard<std::mutex> lock(store.lock);
+    const auto it = store.handles.find(handle);
+    if (it == store.handles.end()) return ESP_ERR_INVALID_ARG;
+    const auto& entries = store.namespaces[it->second.first];
+    const auto entry = entries.find(key);
+    if (entry == entries.end()) return ESP_ERR_NVS_NOT_FOUND;
+    if (out && *length < entry->second.size()) return ESP_ERR_NVS_INVALID_LENGTH;
+    if (out) std::memcpy(out, entry->second.data(), entry->second.size());
+    *length = entry->second.size();
+    return ESP_OK;
+}
+
+} // anonymous namespace
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t mode, nvs_handle_t* handle) {
+    NvsStore& store = nvsStore();
+    std::lock_guard<std::mutex> lock(store.lock);
+    if (mode == NVS_READONLY && !store.namespaces.count(name)) return ESP_ERR_NVS_NOT_FOUND;
+    store.namespaces[name];
+    *handle = store.next_handle++;
+    store.handles[*handle] = {name, mode == NVS_READWRITE};
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+    NvsStore& store = nvsStore();
+    std::lock_guard<std::mutex> lock(store.lock);
+    store.handles.erase(handle);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    NvsStore& store = nvsStore();
+    std::lock_guard<std::mutex> lock(store.lock);
+    return store.handles.count(handle) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char* key, const char* value) {
+    return nvsSet(handle, key, value, std::strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char* key, char* out, size_t* length) {
+    return nvsGet(handle, key, out, length);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+    return nvsSet(handle, key, value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out, size_t* length) {
+    return nvsGet(handle, key, out, length);
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value) {
+    return nvsSet(handle, key, &value, 1);
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char* key, uint8_t* out) {
+    size_t length = 1;
+    return nvsGet(handle, key, out, &length);
+}
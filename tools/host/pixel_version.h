@@ -0,0 +1,6 @@
+#pragma once
+
+// Host tool stand-in for the header CMake generates from include/pixel_version.h.in
+#define PIXDRIVER_GIT_COMMIT "host"
+#define PIXDRIVER_GIT_COMMIT_FULL "host"
+#define PIXDRIVER_BUILD_TIMESTAMP __DATE__ " " __TIME__
@@ -0,0 +1,200 @@
+/* pixaudio: runs the audio analysis (see include/pixel_audio.h) on synthetic PCM and
+ * reports its accuracy and cost per block
+ *
+ * Build:  g++ -std=c++20 -O2 -Iinclude tools/pixaudio.cpp -o pixaudio
+ *
+ *   pixaudio [sample_rate_hz] [fft_size] [bpm]
+ *
+ * fft:    the fixed-point spectrum of random multi-tone blocks against a double
+ *         precision DFT, as signal to error ratio
+ * sweep:  a sine swept across the bands; the reported peak frequency must follow it
+ * beats:  a kick drum at the given tempo under hi-hats and noise; detected beats are
+ *         matched against the true onsets within 50 ms, and the tempo estimate is reported
+ * cost:   nanoseconds and, on x86, TSC cycles per block at each FFT size
+ */
+#include "pixel_audio.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+int16_t clip(double v) {
+    return static_cast<int16_t>(std::clamp(std::lround(v), -32768L, 32767L));
+}
+
+// Signal to error ratio of the fixed-point power spectrum, in dB of magnitude
+double fftAccuracy(uint16_t size, std::mt19937& rng) {
+    AudioFft fft;
+    fft.configure(size);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<int16_t> pcm(size);
+    std::vector<uint32_t> power(size / 2);
+    double signal = 0;
+    double error = 0;
+    for (int trial = 0; trial < 20; ++trial) {
+        for (auto& s : pcm) s = 0;
+        for (int tone = 0; tone < 4; ++tone) {
+            const double f = unit(rng) * 0.45;
+            const double a = 2000 + unit(rng) * 5000;
+            const double phase = unit(rng) * 2 * AUDIO_PI;
+            for (size_t n = 0; n < size; ++n) pcm[n] = clip(pcm[n] + a * std::sin(2 * AUDIO_PI * f * n + phase));
+        }
+        const int shift = fft.transform(pcm.data(), power.data());
+        for (size_t k = 0; k < size / 2; ++k) {
+            double re = 0;
+            double im = 0;
+            for (size_t n = 0; n < size; ++n) {
+                const double w = 0.5 * (1 - std::cos(2 * AUDIO_PI * n / size));
+                re += pcm[n] * w * std::cos(2 * AUDIO_PI * k * n / size);
+                im -= pcm[n] * w * std::sin(2 * AUDIO_PI * k * n / size);
+            }
+            const double expected = std::hypot(re, im) * 2 / size;  // AudioFft scales by 2/N
+            const double got = std::sqrt(static_cast<double>(power[k])) / (1 << shift);
+            signal += expected * expected;
+            error += (got - expected) * (got - expected);
+        }
+    }
+    return 10 * std::log10(signal / std::max(error, 1e-9));
+}
+
+bool sweep(const AudioConfig& config) {
+    AudioAnalyzer analyzer;
+    analyzer.configure(config);
+    const double start = 100;
+    const double end = 6000;
+    const size_t total = config.sample_rate_hz * 4;
+    std::vector<int16_t> pcm(config.hop_samples);
+    double phase = 0;
+    int misses = 0;
+    int checks = 0;
+    for (size_t n = 0; n < total; n += pcm.size()) {
+        double f = 0;
+        for (size_t i = 0; i < pcm.size(); ++i) {
+            f = start * std::pow(end / start, static_cast<double>(n + i) / total);
+            phase += 2 * AUDIO_PI * f / config.sample_rate_hz;
+            pcm[i] = clip(8000 * std::sin(phase));
+        }
+        analyzer.push(pcm.data(), pcm.size());
+        const AudioFrame& frame = analyzer.frame();
+        if (n < config.fft_size * 2) continue;
+        ++checks;
+        const double bin_hz = static_cast<double>(config.sample_rate_hz) / config.fft_size;
+        if (std::fabs(frame.peak_hz - f) > 2 * bin_hz + f * 0.03) ++misses;
+    }
+    std::printf("sweep 100 Hz-6 kHz: peak frequency within two bins in %d of %d blocks\n", checks - misses, checks);
+    return misses * 50 < checks;
+}
+
+bool beats(const AudioConfig& config, double bpm) {
+    AudioAnalyzer analyzer;
+    analyzer.configure(config);
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0, 600);
+    const double rate = config.sample_rate_hz;
+    const double period = 60.0 / bpm;
+    const double seconds = 30;
+    const size_t total = static_cast<size_t>(rate * seconds);
+
+    std::vector<int16_t> pcm(total);
+    std::vector<double> onsets;
+    for (double t = 0.5; t < seconds; t += period) onsets.push_back(t);
+    for (size_t n = 0; n < total; ++n) {
+        const double t = n / rate;
+        double v = noise(rng);
+        for (const double onset : onsets) {
+            const double dt = t - onset;
+            if (dt < 0 || dt > 0.3) continue;
+            // Kick: a falling 120 -> 50 Hz sine with a fast decay
+            v += 20000 * std::exp(-dt * 18) * std::sin(2 * AUDIO_PI * (50 * dt + 70 / 30.0 * (1 - std::exp(-dt * 30))));
+        }
+        const double offbeat = std::fmod(t + period / 2, period / 2);
+        if (offbeat < 0.04) v += 4000 * std::exp(-offbeat * 120) * noise(rng) / 600;  // Hi-hat, eighths
+        pcm[n] = clip(v);
+    }
+
+    std::vector<double> detected;
+    uint16_t tempo = 0;
+    for (size_t n = 0; n + config.hop_samples <= total; n += config.hop_samples) {
+        analyzer.push(&pcm[n], config.hop_samples);
+        if (analyzer.frame().beat) detected.push_back((n + config.hop_samples) / rate);
+        tempo = analyzer.frame().bpm;
+    }
+
+    int hits = 0;
+    for (const double onset : onsets) {
+        for (const double d : detected) {
+            if (d >= onset && d - onset < 0.05 + config.fft_size / rate) {
+                ++hits;
+                break;
+            }
+        }
+    }
+    const int false_beats = static_cast<int>(detected.size()) - hits;
+    std::printf("beats at %.0f BPM: %d of %zu onsets found, %d false, tempo estimate %u BPM\n", bpm, hits,
+                onsets.size(), false_beats, tempo);
+    return hits * 10 >= static_cast<int>(onsets.size()) * 9 && false_beats * 10 <= static_cast<int>(onsets.size()) &&
+           std::abs(static_cast<int>(tempo) - static_cast<int>(std::lround(bpm))) <= 3;
+}
+
+void cost(AudioConfig config) {
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> sample(-12000, 12000);
+    for (const uint16_t size : {256, 512, 1024, 2048}) {
+        config.fft_size = size;
+        config.hop_samples = size / 2;
+        AudioAnalyzer analyzer;
+        if (!analyzer.configure(config)) continue;
+        std::vector<int16_t> pcm(size_t(config.hop_samples) * 256);
+        for (auto& s : pcm) s = static_cast<int16_t>(sample(rng));
+
+        const int blocks = 256 * 8;
+        const auto start = std::chrono::steady_clock::now();
+#if defined(__x86_64__) || defined(__i386__)
+        const uint64_t start_tsc = __rdtsc();
+#endif
+        for (int pass = 0; pass < 8; ++pass) analyzer.push(pcm.data(), pcm.size());
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+#if defined(__x86_64__) || defined(__i386__)
+        std::printf("cost fft %4u: %6.0f ns, %7.0f TSC cycles per block\n", size, ns / blocks,
+                    static_cast<double>(__rdtsc() - start_tsc) / blocks);
+#else
+        std::printf("cost fft %4u: %6.0f ns per block\n", size, ns / blocks);
+#endif
+    }
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    AudioConfig config;
+    config.sample_rate_hz = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 16000;
+    config.fft_size = argc > 2 ? static_cast<uint16_t>(std::atoi(argv[2])) : 512;
+    config.hop_samples = config.fft_size / 2;
+    const double bpm = argc > 3 ? std::atof(argv[3]) : 120;
+    AudioAnalyzer check;
+    if (!check.configure(config) || bpm < 40 || bpm > 240) {
+        std::fprintf(stderr, "usage: pixaudio [sample_rate_hz] [fft_size 64-2048, power of two] [bpm 40-240]\n");
+        return 2;
+    }
+
+    std::mt19937 rng(1);
+    bool ok = true;
+    for (const uint16_t size : {64, 128, 512, 2048}) {
+        const double snr = fftAccuracy(size, rng);
+        std::printf("fft %4u: %.1f dB signal to error\n", size, snr);
+        ok = ok && snr > 40;
+    }
+    ok = sweep(config) && ok;
+    ok = beats(config, bpm) && ok;
+    cost(config);
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
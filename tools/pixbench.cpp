@@ -0,0 +1,842 @@
+/* pixbench: host checks and timings for the portable pixel kernels. The host numbers
+ * quoted in the README come from this tool.
+ *
+ * Build:  g++ -std=c++20 -O2 -pthread -Iinclude -Itools/host tools/pixbench.cpp \
+ *             src/kd_pixdriver.cpp src/pixel_effects.cpp src/pixel_show.cpp src/pixel_transport.cpp \
+ *             src/i2s_pixel_protocol.cpp tools/host/idf_host.cpp tools/host/httpd_host.cpp \
+ *             tools/host/cjson_host.cpp -o pixbench
+ *
+ *   pixbench [section...]     runs every section when none is named
+ *
+ * color16:  the 8-bit output pass against the 16-bit one (widen, scale, dither), with
+ *           and without gamma, each followed by a WS2812B I2S encode, per pixel
+ * dither:   256 temporally dithered frames of 8- and 16-bit levels at several scales
+ *           must average to the exact level within 1/256; cost of the fused encoder
+ * rmt:      random 301-byte frames expanded into RMT symbols in random 1-64 symbol
+ *           chunks, as the refill interrupt does, decode back to the same bits
+ * cache:    a 300 px rainbow rendered, scaled and encoded against the same frames
+ *           replayed from a CycleCache; replayed frames must match byte for byte
+ * lerp:     the interpolating I2S encoder against blending into pixels and encoding
+ *           them, byte for byte over several weights and scales; 600 px timings
+ * timeline: holds, easing endpoints and loop wrap of a small PixelTimeline, then the
+ *           per-frame evaluation cost with 6 and with 999 keys over three tracks
+ * budget:   FrameBudget driving four simulated channels that need 22.3 ms of work in a
+ *           16.7 ms frame, then a lighter load; and half-rate channels with an even
+ *           render_divider, which must keep rendering
+ * share:    four identical 300 px rainbow channels rendered, scaled and encoded each,
+ *           against one render whose pixels and wire frame the other three copy; then
+ *           a pipeline on the host port (tools/host) whose channels each differ from the
+ *           first in brightness, mask, output transform, render_divider or timeline and
+ *           must not share with it, while an identical one sends the same wire frame;
+ *           and two identical channels that part as the frame budget degrades them
+ * transform: OutputTransform::compile() tables for reverse, mirror (odd and even), rotate,
+ *           stride, an index map with out-of-range entries and all of them at once; then
+ *           1200 px scaled plainly, through a reverse+rotate table, and reordered first
+ * transmit: TransmitScheduler slot allocation and release, submits coalescing into one
+ *           claim without touching the kick bit, and the TransmitHealth frame divider
+ *           doubling to and clamping at max_divider
+ *
+ * Timings are host numbers and only meaningful relative to each other; a check that
+ * fails prints FAILED and makes the exit status 1.
+ */
+#include "esp_log.h"
+#include "i2s_pixel_protocol.h"
+#include "kd_pixdriver.h"
+#include "pixel_budget.h"
+#include "pixel_color16.h"
+#include "pixel_cycle_cache.h"
+#include "pixel_timeline.h"
+#include "pixel_transform.h"
+#include "pixel_transmit.h"
+#include "rmt_pixel_protocol.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace {
+
+constexpr auto& WS_TABLE = PIXEL_SYMBOL_TABLE<PixelChipset::WS2812B>;
+constexpr I2sEncodeFn WS_ENCODE = &encodePixels<ColorOrder::GRB, PixelFormat::RGB, 3>;
+constexpr size_t WS_BYTES_PER_PIXEL = 3 * 3;
+
+volatile uint32_t sink = 0;  // Keeps the optimizer from dropping timed work
+
+// Average nanoseconds per call of fn over iterations calls
+template <typename Fn>
+double timeNs(int iterations, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn(i);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+// The RAINBOW effect at one step of its 256-step cycle
+void renderRainbow(std::vector<PixelColor>& pixels, uint8_t offset) {
+    const size_t size = pixels.size();
+    for (size_t i = 0; i < size; ++i) {
+        pixels[i] = PixelColor::fromHSV(static_cast<uint8_t>((i * 256 / size) + offset), 255, 255);
+    }
+}
+
+// The 8-bit pass of PixelChannel::applyCurrentScaling()
+void scalePixels(const std::vector<PixelColor>& in, std::vector<PixelColor>& out, float scale) {
+    for (size_t i = 0; i < in.size(); ++i) {
+        const PixelColor& c = in[i];
+        out[i] = PixelColor(static_cast<uint8_t>(c.r * scale), static_cast<uint8_t>(c.g * scale),
+                            static_cast<uint8_t>(c.b * scale), static_cast<uint8_t>(c.w * scale));
+    }
+}
+
+bool color16() {
+    constexpr size_t count = 1000;
+    constexpr int iterations = 20000;
+    std::vector<PixelColor> pixels(count);
+    std::vector<PixelColor> scaled(count);
+    std::vector<PixelColor16> levels(count);
+    std::vector<uint8_t> wire(count * WS_BYTES_PER_PIXEL);
+    for (size_t i = 0; i < count; ++i) {
+        pixels[i] = PixelColor(static_cast<uint8_t>(i * 7), static_cast<uint8_t>(i * 13), static_cast<uint8_t>(i * 29));
+    }
+    volatile float brightness = 0.37f;
+
+    const double plain = timeNs(iterations, [&](int i) {
+        scalePixels(pixels, scaled, brightness);
+        sink = sink + scaled[i % count].r;
+    });
+    // PixelChannel::applyScaling16() and the spatial dither ahead of an 8-bit transport
+    const auto pass16 = [&](bool gamma) {
+        return timeNs(iterations, [&](int i) {
+            widenSpan(pixels.data(), levels.data(), count);
+            if (gamma) gammaSpan16(levels.data(), count);
+            scaleSpan16(levels.data(), count, static_cast<uint16_t>(brightness * UINT16_MAX));
+            ditherSpan16(levels.data(), scaled.data(), count);
+            sink = sink + scaled[i % count].r;
+        });
+    };
+    const double deep = pass16(false);
+    const double deep_gamma = pass16(true);
+    const double encode = timeNs(iterations, [&](int i) {
+        WS_ENCODE(scaled.data(), count, WS_TABLE.data(), wire.data(), 0);
+        sink = sink + wire[i % wire.size()];
+    });
+
+    const auto perPixel = [](double ns) { return ns / count; };
+    std::printf("color16: %zu px, per pixel with encode: 8-bit %.1f ns, 16-bit %.1f ns (%.2fx), "
+                "16-bit gamma %.1f ns (%.2fx)\n", count, perPixel(plain + encode), perPixel(deep + encode),
+                (deep + encode) / (plain + encode), perPixel(deep_gamma + encode),
+                (deep_gamma + encode) / (plain + encode));
+
+    // Full scale survives the 16-bit pass exactly
+    widenSpan(pixels.data(), levels.data(), count);
+    scaleSpan16(levels.data(), count, UINT16_MAX);
+    ditherSpan16(levels.data(), scaled.data(), count);
+    const bool exact = std::memcmp(pixels.data(), scaled.data(), count * sizeof(PixelColor)) == 0;
+    if (!exact) std::printf("color16: FAILED, 16-bit pass at full scale changed 8-bit content\n");
+    return exact;
+}
+
+// Average wire level of each component over 256 dithered frames against the exact
+// 8.8 level, with an identity table so the wire bytes are the levels themselves
+template <typename Pixel>
+double ditherError(const std::vector<Pixel>& pixels, uint16_t scale) {
+    static constexpr auto IDENTITY = [] {
+        std::array<uint8_t, 256> table{};
+        for (size_t i = 0; i < table.size(); ++i) table[i] = static_cast<uint8_t>(i);
+        return table;
+    }();
+    const size_t components = pixels.size() * 3;
+    std::vector<uint8_t> residue(components);
+    for (size_t i = 0; i < components; ++i) residue[i] = static_cast<uint8_t>(i * 157);
+    std::vector<uint8_t> wire(components + 1);
+    std::vector<uint32_t> sum(components);
+    for (int frame = 0; frame < 256; ++frame) {
+        encodePixelsDithered<ColorOrder::RGB, PixelFormat::RGB, 1, Pixel>(
+            pixels.data(), pixels.size(), scale, residue.data(), IDENTITY.data(), wire.data(), 0);
+        for (size_t i = 0; i < components; ++i) sum[i] += wire[i ^ 1];
+    }
+    double worst = 0;
+    for (size_t i = 0; i < components; ++i) {
+        const double exact = ditherLevel(pixels[i / 3], static_cast<uint8_t>(i % 3), scale) / 256.0;
+        worst = std::max(worst, std::fabs(sum[i] / 256.0 - exact));
+    }
+    return worst;
+}
+
+bool dither() {
+    std::vector<PixelColor> pixels;
+    std::vector<PixelColor16> levels;
+    for (uint32_t v = 0; v < 256; v += 5) {
+        pixels.emplace_back(static_cast<uint8_t>(v), static_cast<uint8_t>(255 - v), static_cast<uint8_t>(v / 3));
+    }
+    for (uint32_t v = 0; v < 65536; v += 257 * 3 + 11) {
+        levels.emplace_back(static_cast<uint16_t>(v), static_cast<uint16_t>(v / 97), static_cast<uint16_t>(65535 - v));
+    }
+    double worst = 0;
+    for (const uint16_t scale : {65535, 40000, 3000, 300}) {
+        worst = std::max({worst, ditherError(pixels, scale), ditherError(levels, scale)});
+    }
+
+    constexpr size_t count = 1000;
+    constexpr int iterations = 20000;
+    std::vector<PixelColor> frame(count);
+    for (size_t i = 0; i < count; ++i) frame[i] = PixelColor(static_cast<uint8_t>(i), static_cast<uint8_t>(i * 3), 40);
+    std::vector<uint8_t> residue(count * 3);
+    std::vector<uint8_t> wire(count * WS_BYTES_PER_PIXEL);
+    const double plain = timeNs(iterations, [&](int i) {
+        WS_ENCODE(frame.data(), count, WS_TABLE.data(), wire.data(), 0);
+        sink = sink + wire[i % wire.size()];
+    });
+    const double dithered = timeNs(iterations, [&](int i) {
+        encodePixelsDithered<ColorOrder::GRB, PixelFormat::RGB, 3, PixelColor>(
+            frame.data(), count, 40000, residue.data(), WS_TABLE.data(), wire.data(), 0);
+        sink = sink + wire[i % wire.size()];
+    });
+
+    const bool ok = worst <= 1.0 / 256;
+    std::printf("dither: 256-frame average within %.4f of the exact level (limit %.4f); "
+                "encode %.1f ns/px plain, %.1f ns/px dithered%s\n", worst, 1.0 / 256, plain / count,
+                dithered / count, ok ? "" : ", FAILED");
+    return ok;
+}
+
+bool rmt() {
+    std::mt19937 rng(86);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<size_t> chunk(1, 64);
+    int failures = 0;
+    int frames = 0;
+    for (const PixelChipset chipset : {PixelChipset::WS2812B, PixelChipset::TM1814}) {
+        const RmtPixelSymbols symbols = makeRmtPixelSymbols(pixelProfile(chipset), RMT_PIXEL_RESOLUTION_HZ);
+        std::vector<uint8_t> data(301);
+        std::vector<uint32_t> out;
+        uint32_t block[64];
+        for (int trial = 0; trial < 200; ++trial, ++frames) {
+            for (auto& b : data) b = static_cast<uint8_t>(byte(rng));
+            out.clear();
+            const size_t total = rmtFrameSymbols(data.size());
+            while (out.size() < total) {
+                const size_t n = encodeRmtSymbols(symbols, data.data(), data.size(), out.size(), block, chunk(rng));
+                if (n == 0) break;
+                out.insert(out.end(), block, block + n);
+            }
+            bool same = out.size() == total && out.back() == symbols.reset;
+            for (size_t bit = 0; same && bit < data.size() * 8; ++bit) {
+                same = out[bit] == symbols.bit[(data[bit / 8] >> (7 - bit % 8)) & 1];
+            }
+            failures += same ? 0 : 1;
+        }
+    }
+    std::printf("rmt: %d of %d chunked frames decode to their input%s\n", frames - failures, frames,
+                failures ? ", FAILED" : "");
+    return failures == 0;
+}
+
+bool cache() {
+    constexpr size_t count = 300;
+    constexpr uint16_t period = 256;
+    constexpr int iterations = period * 100;
+    constexpr float brightness = 0.8f;
+    std::vector<PixelColor> pixels(count);
+    std::vector<PixelColor> scaled(count);
+    std::vector<uint8_t> wire(count * WS_BYTES_PER_PIXEL);
+    const auto renderFrame = [&](uint8_t step) {
+        renderRainbow(pixels, step);
+        scalePixels(pixels, scaled, brightness);
+        WS_ENCODE(scaled.data(), count, WS_TABLE.data(), wire.data(), 0);
+    };
+
+    const double rendered = timeNs(iterations, [&](int i) {
+        renderFrame(static_cast<uint8_t>(i));
+        sink = sink + wire[i % wire.size()];
+    });
+
+    // First pass round the cycle fills the cache, as PixelChannel::transmit() does
+    CycleCache cycle(2 << 20);
+    if (!cycle.configure(period, count, wire.size(), 1)) {
+        std::printf("cache: FAILED, a 300 px period does not fit 2 MB\n");
+        return false;
+    }
+    std::vector<std::vector<uint8_t>> reference(period);
+    for (uint16_t step = 0; step < period; ++step) {
+        renderFrame(static_cast<uint8_t>(step));
+        reference[step] = wire;
+        cycle.store(step, static_cast<uint16_t>(brightness * UINT16_MAX), pixels.data(), wire.data(), 0);
+    }
+
+    // PixelChannel::restoreCycleFrame() and the loadEncodedFrame() copy
+    const double replayed = timeNs(iterations, [&](int i) {
+        const uint16_t step = static_cast<uint16_t>(i % period);
+        const PixelColor* restored = cycle.pixels(step);
+        std::copy(restored, restored + count, pixels.begin());
+        std::memcpy(wire.data(), cycle.frame(step), cycle.frameBytes());
+        sink = sink + wire[i % wire.size()];
+    });
+    int identical = 0;
+    for (uint16_t step = 0; step < period; ++step) {
+        identical += cycle.contains(step) &&
+                     std::memcmp(cycle.frame(step), reference[step].data(), cycle.frameBytes()) == 0;
+    }
+
+    const bool ok = identical == period;
+    std::printf("cache: %zu px rainbow, render+scale+encode %.2f us/frame, from the cache %.2f us/frame; "
+                "%d of %u replayed frames identical%s\n", count, rendered / 1000, replayed / 1000, identical,
+                period, ok ? "" : ", FAILED");
+    return ok;
+}
+
+bool lerp() {
+    constexpr size_t count = 600;
+    constexpr int iterations = 20000;
+    constexpr I2sLerpEncodeFn WS_LERP = &encodePixelsLerp<ColorOrder::GRB, PixelFormat::RGB, 3, false>;
+    std::mt19937 rng(90);
+    std::uniform_int_distribution<int> level(0, 255);
+    std::vector<PixelColor> from(count);
+    std::vector<PixelColor> to(count);
+    std::vector<PixelColor> blended(count);
+    for (size_t i = 0; i < count; ++i) {
+        from[i] = PixelColor(static_cast<uint8_t>(level(rng)), static_cast<uint8_t>(level(rng)), static_cast<uint8_t>(level(rng)));
+        to[i] = PixelColor(static_cast<uint8_t>(level(rng)), static_cast<uint8_t>(level(rng)), static_cast<uint8_t>(level(rng)));
+    }
+    std::vector<uint8_t> reference(count * WS_BYTES_PER_PIXEL);
+    std::vector<uint8_t> fused(count * WS_BYTES_PER_PIXEL);
+
+    // Reference: the in-between frame built as pixels with the same 8.8 lerp and scale
+    int mismatches = 0;
+    int cases = 0;
+    for (const uint16_t weight : {0, 1, 64, 128, 200, 255, 256}) {
+        for (const uint16_t scale : {65535, 52428, 40000, 1000}) {
+            const auto blend = [&](uint8_t a, uint8_t b) {
+                return static_cast<uint8_t>((lerpLevel(a, b, weight) * (static_cast<uint32_t>(scale) + 1)) >> 24);
+            };
+            for (size_t i = 0; i < count; ++i) {
+                blended[i] = PixelColor(blend(from[i].r, to[i].r), blend(from[i].g, to[i].g), blend(from[i].b, to[i].b));
+            }
+            WS_ENCODE(blended.data(), count, WS_TABLE.data(), reference.data(), 0);
+            WS_LERP(from.data(), to.data(), count, weight, scale, nullptr, WS_TABLE.data(), fused.data(), 0);
+            mismatches += reference != fused;
+            ++cases;
+        }
+    }
+    // Weight 256 at full scale is the newest render itself
+    WS_ENCODE(to.data(), count, WS_TABLE.data(), reference.data(), 0);
+    WS_LERP(from.data(), to.data(), count, 256, UINT16_MAX, nullptr, WS_TABLE.data(), fused.data(), 0);
+    mismatches += reference != fused;
+    ++cases;
+
+    std::vector<PixelColor> pixels(count);
+    const double rendered = timeNs(iterations, [&](int i) {
+        renderRainbow(pixels, static_cast<uint8_t>(i));
+        scalePixels(pixels, blended, 0.8f);
+        WS_ENCODE(blended.data(), count, WS_TABLE.data(), reference.data(), 0);
+        sink = sink + reference[i % reference.size()];
+    });
+    const double plain = timeNs(iterations, [&](int i) {
+        WS_ENCODE(to.data(), count, WS_TABLE.data(), reference.data(), 0);
+        sink = sink + reference[i % reference.size()];
+    });
+    const double interpolated = timeNs(iterations, [&](int i) {
+        WS_LERP(from.data(), to.data(), count, static_cast<uint16_t>((i * 37) & 255), 52428, nullptr,
+                WS_TABLE.data(), fused.data(), 0);
+        sink = sink + fused[i % fused.size()];
+    });
+
+    std::printf("lerp: %d of %d weight/scale cases match blend-then-encode; %zu px: encode %.1f us, "
+                "lerp+scale+encode %.1f us, rainbow render+scale+encode %.1f us%s\n", cases - mismatches, cases,
+                count, plain / 1000, interpolated / 1000, rendered / 1000, mismatches ? ", FAILED" : "");
+    return mismatches == 0;
+}
+
+bool timeline() {
+    PixelTimeline small;
+    small.load({
+        TimelineKey::level(500, TimelineParam::Brightness, 0),
+        TimelineKey::level(1500, TimelineParam::Brightness, 200),
+        TimelineKey::color(0, PixelColor(255, 0, 0)),
+        TimelineKey::color(2000, PixelColor(0, 0, 255), TimelineEasing::EaseInOut),
+        TimelineKey::level(500, TimelineParam::Speed, 1, TimelineEasing::Step),
+        TimelineKey::level(1500, TimelineParam::Speed, 10, TimelineEasing::Step),
+    }, 3000, true);
+    const auto at = [&](uint32_t time_ms, TimelineParam param) {
+        small.evaluate(time_ms);
+        return small.value(param);
+    };
+    bool ok = at(0, TimelineParam::Brightness).r == 0 &&            // Holds before the first key
+              at(1000, TimelineParam::Brightness).r == 100 &&       // Linear midpoint
+              at(1499, TimelineParam::Speed).r == 1 &&              // Step waits for its key
+              at(1500, TimelineParam::Speed).r == 10 &&
+              at(1000, TimelineParam::Color).b == 128 &&            // Smoothstep is symmetric
+              at(2500, TimelineParam::Brightness).r == 200 &&       // Holds after the last key
+              at(3250, TimelineParam::Brightness).r == 0;           // Loop wrapped to 250 ms
+    for (const TimelineEasing easing : {TimelineEasing::Linear, TimelineEasing::EaseIn, TimelineEasing::EaseOut,
+                                        TimelineEasing::EaseInOut}) {
+        ok = ok && PixelTimeline::ease(easing, 0) == 0 && PixelTimeline::ease(easing, 65535) <= 65536 &&
+             PixelTimeline::ease(easing, 65535) >= 65534;
+    }
+
+    std::vector<TimelineKey> keys;
+    for (uint32_t i = 0; i < 999; ++i) {
+        keys.push_back(TimelineKey{i * 60, static_cast<TimelineParam>(i % 3), TimelineEasing::EaseInOut,
+                                   PixelColor(static_cast<uint8_t>(i), static_cast<uint8_t>(i * 3),
+                                              static_cast<uint8_t>(i * 7))});
+    }
+    PixelTimeline large;
+    large.load(std::move(keys), 60000, true);
+    // A minute and a half at 60 Hz, including one loop restart, repeated
+    constexpr int iterations = 5400 * 50;
+    const auto cost = [](PixelTimeline& t) {
+        return timeNs(iterations, [&](int i) {
+            t.evaluate(static_cast<uint32_t>(static_cast<uint64_t>(i % 5400) * 1000 / 60));
+            sink = sink + t.value(TimelineParam::Color).g;
+        });
+    };
+    const double short_ns = cost(small);
+    const double long_ns = cost(large);
+
+    std::printf("timeline: evaluation %s; per frame %.0f ns with 6 keys, %.0f ns with 999 keys%s\n",
+                ok ? "matches" : "differs", short_ns, long_ns, ok ? "" : ", FAILED");
+    return ok;
+}
+
+// Work of one simulated channel this frame at its degrade level, and whether it ran
+uint32_t simulatedWork(const ChannelLoad& load, double cost_us, uint32_t tick) {
+    if (load.level >= DegradeLevel::HalfRate && (tick & 1) != load.parity) return 0;
+    if (load.level >= DegradeLevel::NoDither) cost_us *= 0.8;  // Dither off
+    return static_cast<uint32_t>(cost_us);
+}
+
+bool budget() {
+    constexpr uint32_t budget_us = 1000000 / 60;
+    constexpr uint32_t fixed_us = 300;  // Driver work outside the channels
+    const BudgetPolicy policy;
+
+    // Four channels, 22 ms of channel work; at frame 1500 the two heaviest get lighter effects
+    const auto run = [&](bool degrade, uint32_t& overruns_loaded, uint32_t& restores_light) {
+        std::mt19937 rng(93);
+        std::uniform_real_distribution<double> jitter(0.9, 1.1);
+        double cost_us[4] = {5000, 6000, 4000, 7000};
+        ChannelLoad loads[4];
+        const uint8_t priorities[4] = {3, 0, 2, 1};
+        ChannelLoad* pointers[4];
+        for (int i = 0; i < 4; ++i) {
+            loads[i].priority = priorities[i];
+            pointers[i] = &loads[i];
+        }
+        BudgetPolicy used = policy;
+        used.enabled = degrade;
+        FrameBudget frame_budget;
+        for (uint32_t tick = 0; tick < 3000; ++tick) {
+            if (tick == 1500) {
+                overruns_loaded = frame_budget.stats().overruns;
+                cost_us[3] = 1000;
+                cost_us[1] = 2000;
+            }
+            uint32_t work = fixed_us;
+            for (int i = 0; i < 4; ++i) {
+                const uint32_t us = simulatedWork(loads[i], cost_us[i] * jitter(rng), tick);
+                loads[i].add(us);
+                loads[i].endFrame();
+                work += us;
+            }
+            frame_budget.apply(frame_budget.record(work, budget_us, used), pointers, 4, used);
+        }
+        restores_light = frame_budget.stats().restores;
+        return frame_budget.stats();
+    };
+    uint32_t overruns = 0;
+    uint32_t restores = 0;
+    uint32_t overruns_without = 0;
+    uint32_t restores_without = 0;
+    const FrameBudgetStats with = run(true, overruns, restores);
+    run(false, overruns_without, restores_without);
+    bool ok = overruns * 10 < overruns_without && restores > 0 &&
+              static_cast<uint64_t>(with.work_us) * 100 < static_cast<uint64_t>(budget_us) * policy.high_water_pct;
+    std::printf("budget: 22.3 ms of work in a %.1f ms frame, %u of 1500 frames overran with degradation "
+                "and %u without; %u steps down, %u up once the load dropped%s\n", budget_us / 1000.0, overruns,
+                overruns_without, with.degrades, restores, ok ? "" : ", FAILED");
+
+    // Channel 0 is already at half rate on even frames, so the next half-rate channel
+    // would go to odd frames. With render_divider 2 it only renders on even frames.
+    ChannelLoad even_frames;
+    even_frames.level = DegradeLevel::HalfRate;
+    even_frames.priority = 0;
+    ChannelLoad divided[2];
+    divided[0].even_renders = true;   // render_divider 2
+    divided[1].even_renders = false;  // render_divider 1
+    ChannelLoad* pointers[3] = {&even_frames, &divided[0], &divided[1]};
+    for (ChannelLoad* load : pointers) load->add(5000), load->endFrame();
+    BudgetPolicy half_rate = policy;
+    half_rate.max_level = DegradeLevel::HalfRate;
+    FrameBudget frame_budget;
+    for (int step = 0; step < 4; ++step) {
+        frame_budget.apply(FrameBudget::Action::Degrade, pointers, 3, half_rate);
+    }
+    const uint32_t divider[2] = {2, 1};
+    bool renders = true;
+    for (int i = 0; i < 2; ++i) {
+        uint32_t rendered = 0;
+        for (uint32_t tick = 0; tick < 120; ++tick) {
+            const bool active = (tick & 1) == divided[i].parity;
+            rendered += active && tick % divider[i] == 0;
+        }
+        renders = renders && divided[i].level == DegradeLevel::HalfRate && rendered >= 60 / divider[i];
+    }
+    std::printf("budget: half-rate channels with render_divider 2 and 1 on parity %u and %u %s%s\n",
+                divided[0].parity, divided[1].parity, renders ? "keep rendering" : "stop rendering",
+                renders ? "" : ", FAILED");
+    return ok && renders;
+}
+
+// Frames presented by the pipeline; false if it stalls
+bool waitFrames(PixelPipeline& pipeline, int frames) {
+    for (int i = 0; i < frames; ++i) {
+        if (!pipeline.waitForVsync(nullptr, 1000)) return false;
+    }
+    return true;
+}
+
+// Channels that match the first one in all but one compared field, on a running pipeline.
+// Each must render alone, or with a different output map encode alone; an identical
+// twin must copy the first one's render and wire frame.
+bool shareFields() {
+    constexpr uint16_t count = 300;
+    PixelPipeline pipeline;
+    pipeline.initialize(60);  // Below dither_min_refresh_hz, so every frame is kept encoded
+    EffectConfig effect;
+    effect.effect = "RAINBOW";
+    int gpio = 16;
+    const auto add = [&](ChannelConfig config) {
+        config.pin = static_cast<gpio_num_t>(gpio++);
+        PixelChannel* ch = pipeline.getChannel(pipeline.addChannel(config));
+        if (ch) ch->setEffect(effect);
+        return ch;
+    };
+    const ChannelConfig base(GPIO_NUM_16, count);
+    ChannelConfig reversed = base;
+    reversed.transform.reverse = true;
+    ChannelConfig divided = base;
+    divided.render_divider = 2;
+
+    PixelChannel* first = add(base);
+    PixelChannel* twin = add(base);
+    PixelChannel* dimmer = add(base);
+    PixelChannel* masked = add(base);
+    PixelChannel* mirrored = add(reversed);
+    PixelChannel* slower = add(divided);
+    PixelChannel* animated = add(base);
+    if (!first || !twin || !dimmer || !masked || !mirrored || !slower || !animated) {
+        std::printf("share: cannot add the channels, FAILED\n");
+        return false;
+    }
+    dimmer->setBrightness(128);
+    masked->setMask(std::vector<uint8_t>(count, 128));
+    PixelTimeline timeline;  // Holds the brightness the others have, but is a timeline
+    timeline.load({TimelineKey::level(0, TimelineParam::Brightness, 255)}, 1000, true);
+    pipeline.setTimeline(animated->getId(), std::move(timeline));
+
+    pipeline.start();
+    const bool ran = waitFrames(pipeline, 10);
+    pipeline.stop();
+
+    const auto frame = [](const PixelChannel* ch) {
+        const std::span<const uint8_t> bytes = ch->getTransport()->encodedFrame();
+        return std::vector<uint8_t>(bytes.begin(), bytes.end());
+    };
+    const int32_t id = first->getId();
+    const bool copied = twin->getRenderSource() == id && twin->getSharedFrameCount() > 0 &&
+                        !frame(first).empty() && frame(twin) == frame(first);
+    const bool alone = dimmer->getRenderSource() == -1 && masked->getRenderSource() == -1 &&
+                       slower->getRenderSource() == -1 && animated->getRenderSource() == -1;
+    const bool encoded = mirrored->getRenderSource() == id && mirrored->getSharedFrameCount() == 0 &&
+                         frame(mirrored) != frame(first);
+    const bool ok = ran && copied && alone && encoded;
+    std::printf("share: identical channel %s, brightness, mask, render_divider and timeline %s, "
+                "reversed output %s%s\n", copied ? "sends the same wire frame" : "does not share",
+                alone ? "render alone" : "grouped", encoded ? "encodes alone" : "copies the wire frame",
+                ok ? "" : ", FAILED");
+    return ok;
+}
+
+// Two identical channels degraded one step at a time: grouped only while their degrade
+// levels and half-rate parities agree
+bool shareDegrade() {
+    PixelPipeline pipeline;
+    pipeline.initialize(100);
+    EffectConfig effect;
+    effect.effect = "RAINBOW";
+    ChannelConfig config(GPIO_NUM_16, 300);
+    PixelChannel* low = pipeline.getChannel(pipeline.addChannel(config));
+    config.pin = GPIO_NUM_17;
+    config.priority = 1;  // Degrades after the first one has reached max_level
+    PixelChannel* high = pipeline.getChannel(pipeline.addChannel(config));
+    if (!low || !high) {
+        std::printf("share: cannot add the channels, FAILED\n");
+        return false;
+    }
+    low->setEffect(effect);
+    high->setEffect(effect);
+
+    // Every frame is overloaded; a step every 20 frames, never one back
+    BudgetPolicy policy;
+    policy.high_water_pct = 0;
+    policy.low_water_pct = 0;
+    policy.degrade_after = 20;
+    policy.recover_after = UINT16_MAX;
+    policy.max_level = DegradeLevel::HalfRate;
+    pipeline.setBudgetPolicy(policy);
+
+    struct Step {
+        DegradeLevel low;
+        DegradeLevel high;
+        bool grouped;
+    };
+    constexpr Step STEPS[] = {
+        {DegradeLevel::Full, DegradeLevel::Full, true},
+        {DegradeLevel::NoDither, DegradeLevel::Full, false},
+        {DegradeLevel::HalfRate, DegradeLevel::Full, false},
+        {DegradeLevel::HalfRate, DegradeLevel::NoDither, false},
+        {DegradeLevel::HalfRate, DegradeLevel::HalfRate, false},  // On the other parity
+    };
+    pipeline.start();
+    bool ok = true;
+    uint32_t matched = 0;
+    for (uint32_t i = 0; i < std::size(STEPS); ++i) {
+        // Sampled 5 frames after the step, well before the next one
+        while (ok && pipeline.getFrameBudgetStats().degrades < i) ok = waitFrames(pipeline, 1);
+        ok = ok && waitFrames(pipeline, 5);
+        const bool grouped = high->getRenderSource() == low->getId();
+        if (ok && low->getDegradeLevel() == STEPS[i].low && high->getDegradeLevel() == STEPS[i].high &&
+            grouped == STEPS[i].grouped) {
+            ++matched;
+        }
+    }
+    const bool parities = low->activeFrame(0) != high->activeFrame(0);
+    pipeline.stop();
+    ok = ok && matched == std::size(STEPS) && parities;
+    std::printf("share: %lu of %zu degrade steps grouped as expected, half-rate parities %s%s\n",
+                static_cast<unsigned long>(matched), std::size(STEPS), parities ? "differ" : "agree",
+                ok ? "" : ", FAILED");
+    return ok;
+}
+
+bool share() {
+    constexpr size_t count = 300;
+    constexpr size_t channels = 4;
+    constexpr int iterations = 20000;
+    std::vector<std::vector<PixelColor>> pixels(channels, std::vector<PixelColor>(count));
+    std::vector<std::vector<PixelColor>> scaled(channels, std::vector<PixelColor>(count));
+    std::vector<std::vector<uint8_t>> wire(channels, std::vector<uint8_t>(count * WS_BYTES_PER_PIXEL));
+    const auto renderChannel = [&](size_t ch, uint8_t step) {
+        renderRainbow(pixels[ch], step);
+        scalePixels(pixels[ch], scaled[ch], 0.8f);
+        WS_ENCODE(scaled[ch].data(), count, WS_TABLE.data(), wire[ch].data(), 0);
+    };
+
+    const double separate = timeNs(iterations, [&](int i) {
+        for (size_t ch = 0; ch < channels; ++ch) renderChannel(ch, static_cast<uint8_t>(i));
+        sink = sink + wire[channels - 1][i % wire[0].size()];
+    });
+
+    // PixelChannel::copyRender() and the loadEncodedFrame() copy of the source's wire data
+    const double shared = timeNs(iterations, [&](int i) {
+        renderChannel(0, static_cast<uint8_t>(i));
+        for (size_t ch = 1; ch < channels; ++ch) {
+            std::copy(pixels[0].begin(), pixels[0].end(), pixels[ch].begin());
+            std::memcpy(wire[ch].data(), wire[0].data(), wire[0].size());
+        }
+        sink = sink + wire[channels - 1][i % wire[0].size()];
+    });
+    std::printf("share: %zu x %zu px rainbow, %.1f us per frame rendered separately, %.1f us shared\n",
+                channels, count, separate / 1000, shared / 1000);
+
+    esp_log_level_set("*", ESP_LOG_ERROR);  // Each degrade step logs a warning
+    const bool fields = shareFields();
+    return shareDegrade() && fields;
+}
+
+bool transform() {
+    constexpr uint16_t NO = OutputTransform::NO_PIXEL;
+    using Table = std::vector<uint16_t>;
+    const auto compiled = [](size_t count, auto&& setup) {
+        OutputTransform transform;
+        setup(transform);
+        return transform.compile(count);
+    };
+    bool tables =
+        compiled(5, [](auto& t) { t.reverse = true; }) == Table{4, 3, 2, 1, 0} &&
+        compiled(5, [](auto& t) { t.mirror = true; }) == Table{0, 1, 2, 1, 0} &&
+        compiled(6, [](auto& t) { t.mirror = true; }) == Table{0, 1, 2, 2, 1, 0} &&
+        compiled(5, [](auto& t) { t.rotate = 2; }) == Table{2, 3, 4, 0, 1} &&
+        compiled(7, [](auto& t) { t.stride = 3; }) == Table{0, 3, 6, 1, 4, 2, 5} &&
+        compiled(4, [](auto& t) { t.index_map = {3, 4, 0, 7}; }) == Table{3, NO, 0, NO} &&
+        compiled(4, [](auto& t) { t.index_map = {0, 1}; }).empty() &&  // Wrong size: ignored
+        compiled(4, [](auto&) {}).empty();
+    // Every step at once, applied in order: index_map, stride, rotate, reverse, mirror
+    tables = tables && compiled(6, [](auto& t) {
+        t.index_map = {5, 4, 3, 2, 1, 0};
+        t.stride = 2;
+        t.rotate = 1;
+        t.reverse = true;
+        t.mirror = true;
+    }) == Table{0, 1, 2, 0, 2, 1};
+    // The README example: rotate, then reverse
+    const Table example = compiled(300, [](auto& t) {
+        t.reverse = true;
+        t.rotate = 20;
+    });
+    tables = tables && example.size() == 300 && example[0] == 279 && example[280] == 299;
+
+    // The 8-bit scaling pass of PixelChannel::applyCurrentScaling(): plain, gathering
+    // through a reverse plus rotate table, and with the reordering as a pass of its own
+    constexpr size_t count = 1200;
+    constexpr int iterations = 20000;
+    constexpr float brightness = 0.8f;
+    std::vector<PixelColor> pixels(count);
+    std::vector<PixelColor> reordered(count);
+    std::vector<PixelColor> scaled(count);
+    renderRainbow(pixels, 0);
+    const Table map = compiled(count, [](auto& t) {
+        t.reverse = true;
+        t.rotate = 20;
+    });
+    const auto scale = [brightness](const PixelColor& c) {
+        return PixelColor(static_cast<uint8_t>(c.r * brightness), static_cast<uint8_t>(c.g * brightness),
+                          static_cast<uint8_t>(c.b * brightness), static_cast<uint8_t>(c.w * brightness));
+    };
+    const double plain = timeNs(iterations, [&](int i) {
+        scalePixels(pixels, scaled, brightness);
+        sink = sink + scaled[i % count].r;
+    });
+    const double gathered = timeNs(iterations, [&](int i) {
+        gatherSpan(pixels.data(), map.data(), scaled.data(), count, scale);
+        sink = sink + scaled[i % count].r;
+    });
+    const double separate = timeNs(iterations, [&](int i) {
+        gatherSpan(pixels.data(), map.data(), reordered.data(), count, [](const PixelColor& c) { return c; });
+        scalePixels(reordered, scaled, brightness);
+        sink = sink + scaled[i % count].r;
+    });
+    const bool same = [&] {
+        gatherSpan(pixels.data(), map.data(), scaled.data(), count, scale);
+        const std::vector<PixelColor> fused = scaled;
+        gatherSpan(pixels.data(), map.data(), reordered.data(), count, [](const PixelColor& c) { return c; });
+        scalePixels(reordered, scaled, brightness);
+        return fused == scaled;
+    }();
+
+    const bool ok = tables && same;
+    std::printf("transform: tables %s; %zu px scaled in %.2f us, %.2f us through a reverse+rotate table, "
+                "%.2f us with a separate reorder pass%s%s\n", tables ? "ok" : "wrong", count, plain / 1000,
+                gathered / 1000, separate / 1000, same ? "" : ", outputs differ", ok ? "" : ", FAILED");
+    return ok;
+}
+
+bool transmit() {
+    // Every slot once, lowest first, never the kick bit; a released slot is reused first
+    TransmitScheduler scheduler;
+    bool slots = true;
+    for (int32_t i = 0; i < TransmitScheduler::MAX_SLOTS; ++i) {
+        const int32_t slot = scheduler.acquireSlot();
+        slots = slots && slot == i && (TransmitScheduler::bit(slot) & TransmitScheduler::KICK_BIT) == 0;
+    }
+    slots = slots && scheduler.acquireSlot() == -1;
+    scheduler.releaseSlot(5);
+    slots = slots && scheduler.acquireSlot() == 5 && scheduler.acquireSlot() == -1;
+    scheduler.releaseSlot(7);
+    slots = slots && !scheduler.submit(7) && !scheduler.submit(-1) && !scheduler.submit(TransmitScheduler::MAX_SLOTS);
+
+    // Several submits before the service task wakes are claimed together; a busy slot
+    // refuses another frame until complete()
+    bool kicks = scheduler.submit(0) && scheduler.submit(3) && scheduler.submit(30);
+    kicks = kicks && !scheduler.submit(3);
+    const uint32_t taken = scheduler.takeSubmitted();
+    const uint32_t expected = TransmitScheduler::bit(0) | TransmitScheduler::bit(3) | TransmitScheduler::bit(30);
+    kicks = kicks && taken == expected && (taken & TransmitScheduler::KICK_BIT) == 0 &&
+            scheduler.inFlight() == expected && scheduler.takeSubmitted() == 0 && !scheduler.submit(3);
+    scheduler.complete(0);
+    scheduler.complete(3);
+    scheduler.complete(30);
+    kicks = kicks && scheduler.idle() && scheduler.submit(3);
+    scheduler.releaseSlot(3);
+    kicks = kicks && scheduler.idle() && !scheduler.isBusy(3);
+
+    // Every bad frame degrades; the divider doubles up to max_divider, which is clamped to
+    // 1-128 so the uint8_t divider cannot wrap to 0
+    UnderrunPolicy policy;
+    policy.resend_on_error = false;
+    policy.degrade_after = 1;
+    policy.recover_after = 2;
+    const auto dividerAfter = [&](uint8_t max_divider, int bad_frames) {
+        UnderrunPolicy used = policy;
+        used.max_divider = max_divider;
+        TransmitHealth health;
+        for (int i = 0; i < bad_frames; ++i) health.record(TransmitHealth::EVENT_UNDERRUN, false, used);
+        return health;
+    };
+    bool clamp = dividerAfter(8, 2).stats().frame_divider == 4 && dividerAfter(8, 10).stats().frame_divider == 8 &&
+                 dividerAfter(6, 10).stats().frame_divider == 6 && dividerAfter(255, 20).stats().frame_divider == 128 &&
+                 dividerAfter(0, 5).stats().frame_divider == 1;
+    TransmitHealth wrapped = dividerAfter(255, 20);
+    for (uint32_t frame = 0; frame < 256; ++frame) clamp = clamp && wrapped.shouldTransmit(frame) == (frame % 128 == 0);
+    wrapped.record(0, false, policy);
+    wrapped.record(0, false, policy);
+    clamp = clamp && wrapped.stats().frame_divider == 64;
+
+    // A bad frame is resent once, and the resend itself is not
+    TransmitHealth resends;
+    const UnderrunPolicy defaults;
+    const bool resend = resends.record(TransmitHealth::EVENT_TIMEOUT, false, defaults) &&
+                        !resends.record(TransmitHealth::EVENT_TIMEOUT, true, defaults) &&
+                        resends.stats().retransmits == 1 && resends.stats().timeouts == 2;
+
+    const bool ok = slots && kicks && clamp && resend;
+    std::printf("transmit: slot allocation %s, coalesced submits %s, divider clamp %s, resend %s%s\n",
+                slots ? "ok" : "wrong", kicks ? "ok" : "wrong", clamp ? "ok" : "wrong", resend ? "ok" : "wrong",
+                ok ? "" : ", FAILED");
+    return ok;
+}
+
+struct Section {
+    const char* name;
+    bool (*run)();
+};
+
+constexpr Section SECTIONS[] = {
+    {"color16", color16},
+    {"dither", dither},
+    {"rmt", rmt},
+    {"cache", cache},
+    {"lerp", lerp},
+    {"timeline", timeline},
+    {"budget", budget},
+    {"share", share},
+    {"transform", transform},
+    {"transmit", transmit},
+};
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        bool known = false;
+        for (const Section& section : SECTIONS) known |= std::strcmp(argv[i], section.name) == 0;
+        if (!known) {
+            std::fprintf(stderr, "pixbench: unknown section %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    for (const Section& section : SECTIONS) {
+        bool wanted = argc < 2;
+        for (int i = 1; i < argc; ++i) wanted |= std::strcmp(argv[i], section.name) == 0;
+        if (wanted) ok = section.run() && ok;
+    }
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
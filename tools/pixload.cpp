@@ -0,0 +1,342 @@
+/* pixload: load generator for the LED HTTP API, with a local pipeline to run it against
+ *
+ * Build:  g++ -std=c++20 -O2 -pthread -Iinclude -Itools/host tools/pixload.cpp \
+ *             src/kd_pixdriver.cpp src/pixel_effects.cpp src/pixel_show.cpp src/pixel_transport.cpp \
+ *             src/i2s_pixel_protocol.cpp tools/host/idf_host.cpp tools/host/httpd_host.cpp \
+ *             tools/host/cjson_host.cpp -o pixload
+ *
+ *   pixload <host[:port] | local> [seconds] [requests_per_s] [connections] [post_percent] [channels]
+ *
+ * Drives a dashboard-like mix of GET /api/led/config and POST /api/led/channel/<n> at a
+ * fixed rate over keep-alive connections and reports requests/s and latency percentiles.
+ * Latency is measured from when each request was due, so a stalled server is not hidden
+ * by the generator slowing down with it.
+ *
+ * Against a device it measures the real handlers; the frame cost shows up in the
+ * device's frame budget ("budget" in /api/led/config), read before and after the run.
+ *
+ * "local" runs the component itself on the host port of IDF in tools/host: a PixelPipeline
+ * with I2S channels on a simulated DMA, and the real handlers from attach_api() on an
+ * esp_http_server on loopback. Both are pinned to one CPU, httpd below the driver task as
+ * on the device, and the report adds the handler time to the same frame budget readout.
+ */
+#include "kd_pixdriver.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t nowUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// p in 0..100 of a sorted sample
+int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * sorted.size()));
+    return sorted[index];
+}
+
+bool sendAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        const ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// ============= Client =============
+
+class Connection {
+public:
+    Connection(std::string host, uint16_t port) : host_(std::move(host)), port_(port) {}
+    ~Connection() { close(); }
+
+    // One request on the kept-alive connection, reconnecting if the server closed it
+    bool request(const std::string& method, const std::string& uri, const std::string& body,
+                 int& status, std::string& response) {
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            if (fd_ < 0 && !connect()) return false;
+            std::string text = method + " " + uri + " HTTP/1.1\r\nHost: " + host_ + "\r\n";
+            if (!body.empty()) {
+                text += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+            }
+            text += "\r\n" + body;
+            if (sendAll(fd_, text.data(), text.size()) && readResponse(status, response)) return true;
+            close();
+        }
+        return false;
+    }
+
+private:
+    bool connect() {
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &result) != 0) return false;
+        fd_ = ::socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+        const bool ok = fd_ >= 0 && ::connect(fd_, result->ai_addr, result->ai_addrlen) == 0;
+        freeaddrinfo(result);
+        if (!ok) {
+            close();
+            return false;
+        }
+        const int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        buffer_.clear();
+        return true;
+    }
+
+    void close() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    bool fill() {
+        char chunk[4096];
+        const ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer_.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+
+    bool readLine(std::string& line) {
+        size_t end;
+        while ((end = buffer_.find("\r\n")) == std::string::npos) {
+            if (!fill()) return false;
+        }
+        line = buffer_.substr(0, end);
+        buffer_.erase(0, end + 2);
+        return true;
+    }
+
+    bool readBytes(size_t count, std::string& out) {
+        while (buffer_.size() < count) {
+            if (!fill()) return false;
+        }
+        out.append(buffer_, 0, count);
+        buffer_.erase(0, count);
+        return true;
+    }
+
+    // Content-Length and chunked bodies (the trace endpoint streams chunks)
+    bool readResponse(int& status, std::string& body) {
+        std::string line;
+        if (!readLine(line) || line.size() < 12) return false;
+        status = std::atoi(line.c_str() + 9);
+        size_t length = 0;
+        bool chunked = false;
+        bool keep_alive = true;
+        while (readLine(line) && !line.empty()) {
+            std::string lower = line;
+            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+            if (lower.rfind("content-length:", 0) == 0) length = std::strtoul(line.c_str() + 15, nullptr, 10);
+            if (lower.rfind("transfer-encoding:", 0) == 0 && lower.find("chunked") != std::string::npos) chunked = true;
+            if (lower.rfind("connection:", 0) == 0 && lower.find("close") != std::string::npos) keep_alive = false;
+        }
+        body.clear();
+        if (chunked) {
+            while (readLine(line)) {
+                const size_t size = std::strtoul(line.c_str(), nullptr, 16);
+                if (size == 0) {
+                    readLine(line);
+                    break;
+                }
+                if (!readBytes(size, body) || !readLine(line)) return false;
+            }
+        } else if (!readBytes(length, body)) {
+            return false;
+        }
+        if (!keep_alive) close();
+        return true;
+    }
+
+    std::string host_;
+    uint16_t port_;
+    int fd_ = -1;
+    std::string buffer_;
+};
+
+// A number after "key": in JSON text, -1 if absent
+long jsonNumber(const std::string& json, const char* key) {
+    const std::string quoted = std::string("\"") + key + "\"";
+    size_t pos = json.find(quoted);
+    if (pos == std::string::npos) return -1;
+    pos = json.find(':', pos + quoted.size());
+    if (pos == std::string::npos) return -1;
+    return std::strtol(json.c_str() + pos + 1, nullptr, 10);
+}
+
+struct LoadResult {
+    std::vector<int64_t> latency_us;
+    uint32_t errors = 0;
+};
+
+// Open loop: requests go out on schedule whether or not the previous one came back in time
+void runConnection(const std::string& host, uint16_t port, double rate, int seconds, int post_percent,
+                   int channels, int seed, LoadResult& result) {
+    Connection connection(host, port);
+    const auto interval_us = static_cast<int64_t>(1e6 / rate);
+    int64_t due = nowUs() + seed * 997 % std::max<int64_t>(interval_us, 1);
+    const int64_t end = due + int64_t(seconds) * 1000000;
+    uint32_t n = static_cast<uint32_t>(seed);
+    while (due < end) {
+        const int64_t wait = due - nowUs();
+        if (wait > 0) std::this_thread::sleep_for(std::chrono::microseconds(wait));
+
+        n = n * 1103515245u + 12345u;
+        int status = 0;
+        std::string response;
+        bool ok;
+        if (static_cast<int>((n >> 16) % 100) < post_percent) {
+            const int channel = static_cast<int>((n >> 8) % channels);
+            char body[160];
+            std::snprintf(body, sizeof(body),
+                          "{\"brightness\":%u,\"speed\":5,\"on\":true,\"color\":{\"r\":%u,\"g\":%u,\"b\":%u}}",
+                          (n >> 4) & 0xFF, (n >> 6) & 0xFF, (n >> 12) & 0xFF, (n >> 20) & 0xFF);
+            ok = connection.request("POST", "/api/led/channel/" + std::to_string(channel), body, status, response);
+        } else {
+            ok = connection.request("GET", "/api/led/config", "", status, response);
+        }
+        if (!ok || status != 200) ++result.errors;
+        result.latency_us.push_back(nowUs() - due);
+        due += interval_us;
+    }
+}
+
+void printLatency(const char* label, std::vector<int64_t>& values) {
+    std::sort(values.begin(), values.end());
+    std::printf("%-22s p50 %6lld  p90 %6lld  p99 %6lld  max %6lld us\n", label,
+                static_cast<long long>(percentile(values, 50)), static_cast<long long>(percentile(values, 90)),
+                static_cast<long long>(percentile(values, 99)),
+                static_cast<long long>(values.empty() ? 0 : values.back()));
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: pixload <host[:port] | local> [seconds] [requests_per_s] [connections] "
+                             "[post_percent] [channels]\n");
+        return 2;
+    }
+    const std::string target = argv[1];
+    const int seconds = argc > 2 ? std::atoi(argv[2]) : 10;
+    const double rate = argc > 3 ? std::atof(argv[3]) : 50;
+    const int connections = argc > 4 ? std::atoi(argv[4]) : 2;
+    const int post_percent = argc > 5 ? std::atoi(argv[5]) : 50;
+    const int channels = argc > 6 ? std::atoi(argv[6]) : 4;
+    if (seconds < 1 || rate <= 0 || connections < 1 || channels < 1) {
+        std::fprintf(stderr, "seconds, rate, connections and channels must be positive\n");
+        return 2;
+    }
+
+    const bool local = target == "local";
+    std::string host = target;
+    uint16_t port = 80;
+    std::unique_ptr<PixelPipeline> pipeline;
+    httpd_handle_t server = nullptr;
+
+    if (local) {
+        esp_log_level_set("*", ESP_LOG_WARN);
+        pipeline = std::make_unique<PixelPipeline>();
+        PipelineConfig config;
+        config.core = 0;
+        config.nvs_namespace = "pixload";
+        pipeline->initialize(config);
+        for (int i = 0; i < channels; ++i) {
+            if (pipeline->addChannel(ChannelConfig(static_cast<gpio_num_t>(16 + i), 300)) < 0) {
+                std::fprintf(stderr, "cannot add local channel %d\n", i);
+                return 1;
+            }
+        }
+        pipeline->start();
+
+        httpd_config_t httpd_config = HTTPD_DEFAULT_CONFIG();
+        httpd_config.server_port = 0;
+        httpd_config.core_id = 0;
+        httpd_config.max_open_sockets = static_cast<uint16_t>(connections + 1);  // And the budget probe
+        httpd_config.uri_match_fn = httpd_uri_match_wildcard;
+        if (httpd_start(&server, &httpd_config) != ESP_OK) {
+            std::fprintf(stderr, "cannot start the local server\n");
+            return 1;
+        }
+        pipeline->attach_api(server);
+        host = "127.0.0.1";
+        port = httpd_host_port(server);
+        std::printf("local pipeline on port %u, core 0, %d channels of 300 px\n", port, channels);
+    } else if (const size_t colon = target.find(':'); colon != std::string::npos) {
+        host = target.substr(0, colon);
+        port = static_cast<uint16_t>(std::atoi(target.c_str() + colon + 1));
+    }
+
+    // The frame budget before the run
+    std::string before;
+    {
+        Connection probe(host, port);
+        int status = 0;
+        if (!probe.request("GET", "/api/led/config", "", status, before) || status != 200) {
+            std::fprintf(stderr, "cannot reach %s:%u\n", host.c_str(), port);
+            return 1;
+        }
+    }
+
+    std::vector<LoadResult> results(connections);
+    std::vector<std::thread> workers;
+    const int64_t start = nowUs();
+    for (int i = 0; i < connections; ++i) {
+        workers.emplace_back(runConnection, host, port, rate / connections, seconds, post_percent, channels,
+                             i + 1, std::ref(results[i]));
+    }
+    for (auto& worker : workers) worker.join();
+    const double elapsed = (nowUs() - start) / 1e6;
+
+    std::vector<int64_t> latency;
+    uint32_t errors = 0;
+    for (const LoadResult& result : results) {
+        latency.insert(latency.end(), result.latency_us.begin(), result.latency_us.end());
+        errors += result.errors;
+    }
+    std::printf("%zu requests in %.1f s: %.1f req/s, %u errors, %d%% POST\n", latency.size(), elapsed,
+                latency.size() / elapsed, errors, post_percent);
+    printLatency("request latency", latency);
+
+    Connection probe(host, port);
+    int status = 0;
+    std::string after;
+    if (probe.request("GET", "/api/led/config", "", status, after) && status == 200) {
+        std::printf("%s frame budget: work %ld us of %ld, peak %ld us, %ld frames overran during the run\n",
+                    local ? "local" : "device", jsonNumber(after, "work_us"), jsonNumber(after, "budget_us"),
+                    jsonNumber(after, "peak_work_us"), jsonNumber(after, "overruns") - jsonNumber(before, "overruns"));
+    }
+
+    if (local) {
+        std::vector<int64_t> handler_us = httpd_host_handler_us(server);
+        printLatency("handler time", handler_us);
+        httpd_stop(server);
+        pipeline->shutdown();
+    }
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,228 @@
+/* pixpipe: two PixelPipeline instances side by side on the host port of IDF (tools/host)
+ *
+ * Build:  g++ -std=c++20 -O2 -pthread -Iinclude -Itools/host tools/pixpipe.cpp \
+ *             src/kd_pixdriver.cpp src/pixel_effects.cpp src/pixel_show.cpp src/pixel_transport.cpp \
+ *             src/i2s_pixel_protocol.cpp tools/host/idf_host.cpp tools/host/httpd_host.cpp \
+ *             tools/host/cjson_host.cpp -o pixpipe
+ *
+ *   pixpipe
+ *
+ * Pipeline A runs two channels at 60 Hz on core 0, pipeline B one channel at 100 Hz on
+ * core 1, each with its own NVS namespace and its own httpd serving attach_api().
+ *
+ * rates:      each pipeline presents frames at its own rate
+ * api:        a POST to A's server changes A's channel only; each server lists its own
+ *             channels
+ * stop:       B keeps presenting after A is stopped
+ * nvs:        settings A saves load into a channel of A's namespace and not of B's
+ * standalone: a PixelChannel built outside any pipeline takes its rate and namespace
+ *             from the default pipeline
+ *
+ * A check that fails prints FAILED and makes the exit status 1.
+ */
+#include "kd_pixdriver.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// One request on its own connection; the status, or -1 if the server did not answer
+int request(uint16_t port, const std::string& method, const std::string& uri, const std::string& body,
+            std::string& response) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        if (fd >= 0) ::close(fd);
+        return -1;
+    }
+    const std::string text = method + " " + uri + " HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) +
+                             "\r\n\r\n" + body;
+    ::send(fd, text.data(), text.size(), MSG_NOSIGNAL);
+
+    std::string in;
+    size_t header_end = std::string::npos;
+    size_t length = 0;
+    char chunk[4096];
+    while (header_end == std::string::npos || in.size() < header_end + 4 + length) {
+        const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        in.append(chunk, static_cast<size_t>(n));
+        if (header_end == std::string::npos && (header_end = in.find("\r\n\r\n")) != std::string::npos) {
+            const size_t at = in.find("Content-Length:");
+            if (at < header_end) length = std::strtoul(in.c_str() + at + 15, nullptr, 10);
+        }
+    }
+    ::close(fd);
+    if (header_end == std::string::npos || in.size() < 12) return -1;
+    response = in.substr(header_end + 4);
+    return std::atoi(in.c_str() + 9);
+}
+
+struct Instance {
+    PixelPipeline pipeline;
+    httpd_handle_t server = nullptr;
+    uint16_t port = 0;
+    std::atomic<uint32_t> presented{0};
+};
+
+bool startInstance(Instance& instance, uint32_t rate_hz, BaseType_t core, const char* nvs_namespace,
+                   int channels, int first_gpio) {
+    PipelineConfig config;
+    config.update_rate_hz = rate_hz;
+    config.core = core;
+    config.nvs_namespace = nvs_namespace;
+    instance.pipeline.initialize(config);
+    for (int i = 0; i < channels; ++i) {
+        if (instance.pipeline.addChannel(ChannelConfig(static_cast<gpio_num_t>(first_gpio + i), 300)) < 0) {
+            return false;
+        }
+    }
+    instance.pipeline.addFramePresentedCallback([&instance](const FrameInfo&) { ++instance.presented; });
+
+    httpd_config_t httpd_config = HTTPD_DEFAULT_CONFIG();
+    httpd_config.server_port = 0;
+    httpd_config.core_id = core;
+    httpd_config.uri_match_fn = httpd_uri_match_wildcard;
+    if (httpd_start(&instance.server, &httpd_config) != ESP_OK) return false;
+    instance.pipeline.attach_api(instance.server);
+    instance.port = httpd_host_port(instance.server);
+    instance.pipeline.start();
+    return true;
+}
+
+void stopInstance(Instance& instance) {
+    if (instance.server) httpd_stop(instance.server);
+    instance.server = nullptr;
+    instance.pipeline.shutdown();
+}
+
+// Frames presented in one second against the rate, within 10 %
+bool rates(Instance& a, Instance& b) {
+    const uint32_t a0 = a.presented;
+    const uint32_t b0 = b.presented;
+    sleepMs(1000);
+    const uint32_t a_frames = a.presented - a0;
+    const uint32_t b_frames = b.presented - b0;
+    const bool ok = a_frames >= 54 && a_frames <= 66 && b_frames >= 90 && b_frames <= 110;
+    std::printf("rates: A presented %lu frames at 60 Hz, B %lu at 100 Hz in 1 s%s\n",
+                static_cast<unsigned long>(a_frames), static_cast<unsigned long>(b_frames), ok ? "" : ", FAILED");
+    return ok;
+}
+
+bool api(Instance& a, Instance& b) {
+    std::string response;
+    const int posted = request(a.port, "POST", "/api/led/channel/0", "{\"effect_id\":\"FIRE\",\"brightness\":10}",
+                               response);
+    const EffectConfig& a_effect = a.pipeline.getChannel(0)->getEffectConfig();
+    const EffectConfig& b_effect = b.pipeline.getChannel(0)->getEffectConfig();
+    const bool applied = posted == 200 && a_effect.effect == "FIRE" && a_effect.brightness == 10;
+    const bool untouched = b_effect.effect != "FIRE" && b_effect.brightness == 255;
+
+    // Each server lists its own channels: A has a channel 1, B does not
+    const bool listed = request(a.port, "GET", "/api/led/channel/1", "", response) == 200 &&
+                        request(b.port, "GET", "/api/led/channel/1", "", response) == 404 &&
+                        request(b.port, "GET", "/api/led/config", "", response) == 200 &&
+                        response.find("\"index\":\t1") == std::string::npos;
+    const bool ok = applied && untouched && listed;
+    std::printf("api: POST to A %s, B's channel %s, channel lists %s%s\n", applied ? "applied" : "not applied",
+                untouched ? "untouched" : "changed", listed ? "separate" : "mixed", ok ? "" : ", FAILED");
+    return ok;
+}
+
+bool stopped(Instance& a, Instance& b) {
+    a.pipeline.stop();
+    sleepMs(50);
+    const uint32_t a0 = a.presented;
+    const uint32_t b0 = b.presented;
+    sleepMs(300);
+    const uint32_t a_frames = a.presented - a0;
+    const uint32_t b_frames = b.presented - b0;
+    const bool ok = a_frames == 0 && b_frames >= 25;
+    std::printf("stop: with A stopped, A presented %lu frames and B %lu in 300 ms%s\n",
+                static_cast<unsigned long>(a_frames), static_cast<unsigned long>(b_frames), ok ? "" : ", FAILED");
+    return ok;
+}
+
+// A's channel 0 saved, then loaded by fresh pipelines on each namespace
+bool nvs(Instance& a) {
+    a.pipeline.getChannel(0)->saveToNVS();
+    const auto loaded_effect = [](const char* nvs_namespace) {
+        PixelPipeline pipeline;
+        PipelineConfig config;
+        config.nvs_namespace = nvs_namespace;
+        pipeline.initialize(config);
+        const int32_t id = pipeline.addChannel(ChannelConfig(GPIO_NUM_30, 30));
+        return id < 0 ? std::string() : pipeline.getChannel(id)->getEffectConfig().effect;
+    };
+    const std::string same = loaded_effect("pixpipe_a");
+    const std::string other = loaded_effect("pixpipe_b");
+    const bool ok = same == "FIRE" && other != "FIRE";
+    std::printf("nvs: A's namespace loads %s, B's loads %s%s\n", same.c_str(), other.c_str(), ok ? "" : ", FAILED");
+    return ok;
+}
+
+bool standalone() {
+    PixelDriver::initialize(50);
+    ChannelConfig config(GPIO_NUM_31, 30);
+    config.render_divider = 2;
+    EffectConfig effect;
+    effect.effect = "COMET";
+    uint32_t refresh_hz;
+    uint32_t render_hz;
+    {
+        PixelChannel channel(7, config);
+        refresh_hz = channel.getRefreshRate();
+        render_hz = channel.getRenderRate();
+        channel.setEffect(effect);
+        channel.saveToNVS();
+    }
+    PixelChannel reloaded(7, config);
+    reloaded.loadFromNVS();
+    const bool ok = refresh_hz == 50 && render_hz == 25 && reloaded.getEffectConfig().effect == "COMET";
+    std::printf("standalone: %lu Hz refresh, %lu Hz render, saved effect %s on reload%s\n",
+                static_cast<unsigned long>(refresh_hz), static_cast<unsigned long>(render_hz),
+                reloaded.getEffectConfig().effect == "COMET" ? "kept" : "lost", ok ? "" : ", FAILED");
+    PixelDriver::shutdown();
+    return ok;
+}
+
+} // anonymous namespace
+
+int main() {
+    esp_log_level_set("*", ESP_LOG_WARN);
+    Instance a;
+    Instance b;
+    if (!startInstance(a, 60, 0, "pixpipe_a", 2, 16) || !startInstance(b, 100, 1, "pixpipe_b", 1, 20)) {
+        std::fprintf(stderr, "pixpipe: cannot start the pipelines\n");
+        return 1;
+    }
+    sleepMs(200);
+
+    bool ok = rates(a, b);
+    ok = api(a, b) && ok;
+    ok = stopped(a, b) && ok;
+    ok = nvs(a) && ok;
+    stopInstance(a);
+    stopInstance(b);
+    ok = standalone() && ok;
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
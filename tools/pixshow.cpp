@@ -0,0 +1,299 @@
+/* pixshow: host tool for pixel show and image files (see include/pixel_show_format.h and
+ * include/pixel_image_format.h)
+ *
+ * Build:  g++ -std=c++20 -O2 -Iinclude tools/pixshow.cpp -o pixshow
+ *
+ *   pixshow encode <frames.raw> <out.pxs> <track>[,<track>...] [fps] [keyframe_interval]
+ *   pixshow decode <in.pxs> <frames.raw>
+ *   pixshow roundtrip <frames.raw> <track>[,<track>...]
+ *   pixshow info <in.pxs>
+ *   pixshow image <in.ppm> <out.pxim> [column_hz] [keyframe_interval]
+ *
+ * A track is "<pixels>" for RGB or "<pixels>w" for RGBW. Raw frames are the tracks'
+ * bytes (r, g, b[, w] per pixel) back to back, frame after frame, as rendered offline.
+ * An image is a binary PPM (P6) whose x axis is played over time, one column per step,
+ * with the top row on the first pixel of the strip.
+ */
+#include "pixel_image_format.h"
+#include "pixel_show_format.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool readFile(const char* path, std::vector<uint8_t>& out) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+    uint8_t buffer[SHOW_CHUNK_BYTES];
+    size_t n = 0;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out.insert(out.end(), buffer, buffer + n);
+    }
+    std::fclose(file);
+    return true;
+}
+
+bool writeFile(const char* path, const std::vector<uint8_t>& data) {
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) return false;
+    const bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+bool parseTracks(const char* spec, std::vector<ShowTrack>& tracks) {
+    std::string rest(spec);
+    while (!rest.empty()) {
+        const size_t comma = rest.find(',');
+        const std::string item = rest.substr(0, comma);
+        rest = (comma == std::string::npos) ? "" : rest.substr(comma + 1);
+
+        char* end = nullptr;
+        const long pixels = std::strtol(item.c_str(), &end, 10);
+        if (pixels <= 0 || pixels > UINT16_MAX) return false;
+        ShowTrack track;
+        track.pixel_count = static_cast<uint16_t>(pixels);
+        track.colors = (*end == 'w' || *end == 'W') ? 4 : 3;
+        tracks.push_back(track);
+    }
+    return !tracks.empty() && tracks.size() <= SHOW_MAX_TRACKS;
+}
+
+size_t frameBytes(const std::vector<ShowTrack>& tracks) {
+    size_t bytes = 0;
+    for (const auto& track : tracks) bytes += track.bytes();
+    return bytes;
+}
+
+std::vector<uint8_t> encodeShow(const std::vector<uint8_t>& raw, const std::vector<ShowTrack>& tracks,
+                                uint16_t fps, uint16_t keyframe_interval) {
+    ShowHeader header;
+    header.frame_rate_hz = fps;
+    header.keyframe_interval = keyframe_interval;
+    ShowEncoder encoder(header, tracks);
+
+    std::vector<uint8_t> body;
+    const size_t frame_bytes = frameBytes(tracks);
+    for (size_t offset = 0; offset + frame_bytes <= raw.size(); offset += frame_bytes) {
+        encoder.beginFrame();
+        size_t track_offset = offset;
+        for (size_t t = 0; t < tracks.size(); ++t) {
+            encoder.encodeTrack(t, &raw[track_offset], body);
+            track_offset += tracks[t].bytes();
+        }
+    }
+
+    std::vector<uint8_t> out = encoder.encodeHeader();
+    out.insert(out.end(), body.begin(), body.end());
+    return out;
+}
+
+// Decode every frame back to raw; false on a corrupt file
+bool decodeShow(ShowSource& source, std::vector<uint8_t>& raw, ShowHeader* header_out = nullptr) {
+    ShowDecoder decoder(source);
+    if (!decoder.open()) {
+        std::fprintf(stderr, "not a pixel show file\n");
+        return false;
+    }
+    if (header_out) *header_out = decoder.header();
+
+    ShowStatus status;
+    while ((status = decoder.decodeFrame()) == ShowStatus::OK) {
+        for (size_t t = 0; t < decoder.tracks().size(); ++t) {
+            const uint8_t* data = decoder.trackData(t);
+            raw.insert(raw.end(), data, data + decoder.tracks()[t].bytes());
+        }
+    }
+    if (status == ShowStatus::CORRUPT) {
+        std::fprintf(stderr, "corrupt record in frame %u\n", decoder.frameIndex());
+        return false;
+    }
+    return true;
+}
+
+// Binary PPM (P6, maxval 255) to columns: x -> column, y -> pixel
+bool readPpmColumns(const std::vector<uint8_t>& file, ImageHeader& header, std::vector<uint8_t>& columns) {
+    size_t pos = 0;
+    const auto field = [&]() -> long {
+        while (pos < file.size()) {
+            if (file[pos] == '#') {
+                while (pos < file.size() && file[pos] != '\n') ++pos;
+            } else if (std::isspace(file[pos])) {
+                ++pos;
+            } else {
+                break;
+            }
+        }
+        long value = 0;
+        bool digits = false;
+        while (pos < file.size() && std::isdigit(file[pos])) {
+            value = value * 10 + (file[pos++] - '0');
+            digits = true;
+        }
+        return digits ? value : -1;
+    };
+    if (file.size() < 2 || file[0] != 'P' || file[1] != '6') return false;
+    pos = 2;
+    const long width = field();
+    const long height = field();
+    const long maxval = field();
+    ++pos;  // Single whitespace before the pixels
+    if (width <= 0 || width > UINT16_MAX || height <= 0 || height > UINT16_MAX || maxval != 255 ||
+        file.size() < pos + static_cast<size_t>(width) * height * 3) {
+        return false;
+    }
+
+    header.colors = 3;
+    header.width = static_cast<uint16_t>(width);
+    header.height = static_cast<uint16_t>(height);
+    columns.resize(static_cast<size_t>(width) * height * 3);
+    for (long y = 0; y < height; ++y) {
+        for (long x = 0; x < width; ++x) {
+            const uint8_t* in = &file[pos + (static_cast<size_t>(y) * width + x) * 3];
+            std::copy(in, in + 3, &columns[(static_cast<size_t>(x) * height + y) * 3]);
+        }
+    }
+    return true;
+}
+
+// Stream every column back through the decoder, forward and then last to first
+bool checkImage(const std::vector<uint8_t>& image, const std::vector<uint8_t>& columns) {
+    ShowMemorySource source(image.data(), image.size());
+    ImageDecoder decoder(source);
+    if (!decoder.open()) return false;
+    const ImageHeader& header = decoder.header();
+    const size_t size = header.columnBytes();
+    for (int pass = 0; pass < 2; ++pass) {
+        for (uint32_t i = 0; i < header.width; ++i) {
+            const auto c = static_cast<uint16_t>(pass == 0 ? i : header.width - 1 - i);
+            if (decoder.seek(c) != ShowStatus::OK ||
+                !std::equal(decoder.columnData(), decoder.columnData() + size, &columns[c * size])) {
+                std::fprintf(stderr, "mismatch in column %u\n", c);
+                return false;
+            }
+        }
+    }
+    std::printf("round trip ok, %zu bytes of RAM to play\n", decoder.memoryBytes());
+    return true;
+}
+
+int usage() {
+    std::fprintf(stderr,
+                 "usage: pixshow encode <frames.raw> <out.pxs> <tracks> [fps] [keyframe_interval]\n"
+                 "       pixshow decode <in.pxs> <frames.raw>\n"
+                 "       pixshow roundtrip <frames.raw> <tracks>\n"
+                 "       pixshow info <in.pxs>\n"
+                 "       pixshow image <in.ppm> <out.pxim> [column_hz] [keyframe_interval]\n"
+                 "tracks: comma separated pixel counts, 'w' suffix for RGBW (e.g. 300,144w)\n");
+    return 2;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) return usage();
+    const std::string command = argv[1];
+
+    if (command == "encode" || command == "roundtrip") {
+        const bool roundtrip = command == "roundtrip";
+        if (argc < (roundtrip ? 4 : 5)) return usage();
+        std::vector<ShowTrack> tracks;
+        if (!parseTracks(argv[roundtrip ? 3 : 4], tracks)) return usage();
+        const uint16_t fps = (!roundtrip && argc > 5) ? static_cast<uint16_t>(std::atoi(argv[5])) : 60;
+        const uint16_t key = (!roundtrip && argc > 6) ? static_cast<uint16_t>(std::atoi(argv[6])) : fps;
+
+        std::vector<uint8_t> raw;
+        if (!readFile(argv[2], raw)) {
+            std::fprintf(stderr, "cannot read %s\n", argv[2]);
+            return 1;
+        }
+        const size_t frame_bytes = frameBytes(tracks);
+        raw.resize(raw.size() - raw.size() % frame_bytes);  // Whole frames only
+
+        const std::vector<uint8_t> show = encodeShow(raw, tracks, fps ? fps : 60, key);
+        std::printf("%zu frames, %zu -> %zu bytes (%.1f%%)\n", raw.size() / frame_bytes,
+                    raw.size(), show.size(), raw.empty() ? 0.0 : 100.0 * show.size() / raw.size());
+
+        if (!roundtrip) {
+            if (!writeFile(argv[3], show)) {
+                std::fprintf(stderr, "cannot write %s\n", argv[3]);
+                return 1;
+            }
+            return 0;
+        }
+
+        ShowMemorySource source(show.data(), show.size());
+        std::vector<uint8_t> decoded;
+        if (!decodeShow(source, decoded)) return 1;
+        if (decoded != raw) {
+            const auto diff = std::mismatch(decoded.begin(), decoded.end(), raw.begin(), raw.end());
+            std::fprintf(stderr, "mismatch at byte %zu\n", static_cast<size_t>(diff.first - decoded.begin()));
+            return 1;
+        }
+        std::printf("round trip ok\n");
+        return 0;
+    }
+
+    if (command == "decode" || command == "info") {
+        ShowFileSource source(argv[2]);
+        if (!source.isOpen()) {
+            std::fprintf(stderr, "cannot read %s\n", argv[2]);
+            return 1;
+        }
+        std::vector<uint8_t> raw;
+        ShowHeader header;
+        if (!decodeShow(source, raw, &header)) return 1;
+
+        if (command == "info") {
+            ShowDecoder decoder(source);
+            decoder.open();
+            std::printf("%u frames at %u Hz, keyframe every %u\n", header.frame_count,
+                        header.frame_rate_hz, header.keyframe_interval);
+            for (size_t t = 0; t < decoder.tracks().size(); ++t) {
+                std::printf("track %zu: %u pixels, %s\n", t, decoder.tracks()[t].pixel_count,
+                            decoder.tracks()[t].colors == 4 ? "RGBW" : "RGB");
+            }
+            std::printf("%zu raw bytes\n", raw.size());
+            return 0;
+        }
+        if (argc < 4) return usage();
+        return writeFile(argv[3], raw) ? 0 : 1;
+    }
+
+    if (command == "image") {
+        if (argc < 4) return usage();
+        std::vector<uint8_t> file;
+        if (!readFile(argv[2], file)) {
+            std::fprintf(stderr, "cannot read %s\n", argv[2]);
+            return 1;
+        }
+        ImageHeader header;
+        std::vector<uint8_t> columns;
+        if (!readPpmColumns(file, header, columns)) {
+            std::fprintf(stderr, "%s is not a binary PPM with maxval 255\n", argv[2]);
+            return 1;
+        }
+        const int rate = argc > 4 ? std::atoi(argv[4]) : 30;
+        const int key = argc > 5 ? std::atoi(argv[5]) : 16;
+        if (rate <= 0 || rate > UINT16_MAX || key <= 0 || key > UINT16_MAX) return usage();
+        header.column_rate_hz = static_cast<uint16_t>(rate);
+        header.keyframe_interval = static_cast<uint16_t>(key);
+
+        const std::vector<uint8_t> image = encodeImage(header, columns.data());
+        std::printf("%u columns of %u pixels, %zu -> %zu bytes (%.1f%%)\n", header.width, header.height,
+                    columns.size(), image.size(), 100.0 * image.size() / columns.size());
+        if (!checkImage(image, columns)) return 1;
+        if (!writeFile(argv[3], image)) {
+            std::fprintf(stderr, "cannot write %s\n", argv[3]);
+            return 1;
+        }
+        return 0;
+    }
+
+    return usage();
+}
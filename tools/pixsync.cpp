@@ -0,0 +1,145 @@
+/* pixsync: runs one sync leader and several followers on this host over loopback
+ * (see include/pixel_sync.h) and measures how well their frame clocks line up
+ *
+ * Build:  g++ -std=c++20 -O2 -pthread -Iinclude tools/pixsync.cpp -o pixsync
+ *
+ *   pixsync [followers] [seconds] [rate_hz] [address] [port]
+ *
+ * Every node gets its own clock, offset by a few seconds and running up to 200 ppm fast
+ * or slow like a real crystal, and its own frame loop thread. Followers start at random
+ * points in time. The reported error compares the true time each follower frame starts
+ * with the leader's start of the same frame, after a warm-up; next to it is the error
+ * the follower itself measured from the beacons (SyncStats).
+ */
+#include "pixel_sync.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+int64_t realNowUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// A controller's view of time
+struct NodeClock {
+    double ppm = 0;
+    int64_t offset_us = 0;
+
+    [[nodiscard]] int64_t local(int64_t real_us) const {
+        return static_cast<int64_t>(real_us * (1.0 + ppm * 1e-6)) + offset_us;
+    }
+    [[nodiscard]] int64_t real(int64_t local_us) const {
+        return static_cast<int64_t>((local_us - offset_us) / (1.0 + ppm * 1e-6));
+    }
+};
+
+struct Node {
+    NodeClock clock;
+    std::unique_ptr<SyncNode> sync;
+    std::unordered_map<uint32_t, int64_t> frame_starts;  // Frame -> true start time
+    std::thread frame_thread;
+    std::thread receive_thread;
+};
+
+void frameLoop(Node& node, uint16_t rate_hz, const std::atomic<bool>& running) {
+    FrameClock clock;
+    clock.start(node.clock.local(realNowUs()), rate_hz);
+    while (running) {
+        node.frame_starts[clock.frame()] = node.clock.real(clock.frameStartUs());
+        node.sync->onFrame(clock);
+        clock.advance(node.clock.local(realNowUs()));
+        const int64_t wait = node.clock.real(clock.frameStartUs()) - realNowUs();
+        if (wait > 0) std::this_thread::sleep_for(std::chrono::microseconds(wait));
+    }
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    const int followers = argc > 1 ? std::atoi(argv[1]) : 4;
+    const int seconds = argc > 2 ? std::atoi(argv[2]) : 20;
+    const auto rate_hz = static_cast<uint16_t>(argc > 3 ? std::atoi(argv[3]) : 60);
+    const std::string address = argc > 4 ? argv[4] : "239.255.80.88";
+    const auto port = static_cast<uint16_t>(argc > 5 ? std::atoi(argv[5]) : SYNC_DEFAULT_PORT);
+    if (followers < 1 || seconds < 5 || rate_hz == 0) {
+        std::fprintf(stderr, "usage: pixsync [followers] [seconds >= 5] [rate_hz] [address] [port]\n");
+        return 2;
+    }
+
+    std::srand(static_cast<unsigned>(realNowUs()));
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (int i = 0; i <= followers; ++i) {
+        auto node = std::make_unique<Node>();
+        node->clock.ppm = (std::rand() % 401) - 200;
+        node->clock.offset_us = (std::rand() % 5000000) - 2500000;
+        node->sync = std::make_unique<SyncNode>([clock = node->clock] { return clock.local(realNowUs()); });
+
+        SyncConfig config;
+        config.role = i == 0 ? SyncRole::Leader : SyncRole::Follower;
+        config.address = address;
+        config.port = port;
+        config.node_id = 1;
+        if (!node->sync->open(config, rate_hz)) {
+            std::fprintf(stderr, "cannot open sync socket for node %d (%s:%u)\n", i, address.c_str(), port);
+            return 1;
+        }
+        nodes.push_back(std::move(node));
+    }
+
+    std::atomic<bool> running{true};
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        Node& node = *nodes[i];
+        if (i > 0) {
+            node.receive_thread = std::thread([&node, &running] {
+                while (running) node.sync->receive(100);
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 500));
+        }
+        node.frame_thread = std::thread(frameLoop, std::ref(node), rate_hz, std::cref(running));
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running = false;
+    for (auto& node : nodes) {
+        node->frame_thread.join();
+        if (node->receive_thread.joinable()) node->receive_thread.join();
+    }
+
+    // Compare frames after the warm-up, once every follower had time to lock
+    const Node& leader = *nodes[0];
+    const int64_t warmup_end = realNowUs() - (seconds - 3) * int64_t(1000000);
+    std::printf("leader: %u beacons, %u Hz\n", leader.sync->stats().beacons, rate_hz);
+    std::printf("node   ppm  frames  true mean/max us   beacon mean/max us  rate ppm  steps  lost\n");
+
+    int64_t worst = 0;
+    for (size_t i = 1; i < nodes.size(); ++i) {
+        const Node& node = *nodes[i];
+        int64_t sum = 0, max = 0;
+        size_t count = 0;
+        for (const auto& [frame, start] : node.frame_starts) {
+            const auto it = leader.frame_starts.find(frame);
+            if (it == leader.frame_starts.end() || it->second < warmup_end) continue;
+            const int64_t error = std::llabs(start - it->second);
+            sum += error;
+            max = std::max(max, error);
+            ++count;
+        }
+        const SyncStats stats = node.sync->stats();
+        std::printf("%4zu %5.0f %7zu %9lld / %-7lld %10u / %-7u %8d %6u %5u\n", i, node.clock.ppm, count,
+                    count ? static_cast<long long>(sum / int64_t(count)) : -1LL, static_cast<long long>(max),
+                    stats.mean_abs_error_us, stats.max_abs_error_us, stats.rate_ppm, stats.steps, stats.lost);
+        worst = std::max(worst, count ? max : INT64_MAX);
+    }
+    std::printf("worst frame start error: %lld us (%.1f%% of a frame)\n", static_cast<long long>(worst),
+                100.0 * worst * rate_hz / 1e6);
+    return 0;
+}
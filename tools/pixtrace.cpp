@@ -0,0 +1,190 @@
+/* pixtrace: simulates the driver's frame pipeline on this host with tracing compiled in
+ * (see include/pixel_trace.h) and writes the events as Chrome trace JSON
+ *
+ * Build:  g++ -std=c++20 -O2 -pthread -Iinclude tools/pixtrace.cpp -o pixtrace
+ *
+ *   pixtrace [channels] [pixels] [rate_hz] [seconds] [out.json]
+ *
+ * A driver thread renders, limits and encodes every channel each frame and kicks a
+ * transmit thread, which starts each channel's simulated DMA (WS2812 wire time) and
+ * retires it when it would have finished. An API thread commits to a simulated NVS once
+ * a second, holding the flash lock the render path also needs, the way a flash write
+ * stalls code running from flash. Open the output in chrome://tracing or ui.perfetto.dev.
+ */
+#define PIXDRIVER_TRACE 1
+#define PIXDRIVER_TRACE_EVENTS 32768
+#include "pixel_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t WIRE_US_PER_PIXEL = 30;  // 24 bits at 800 kHz
+constexpr uint32_t RESET_US = 300;
+constexpr uint32_t NVS_COMMIT_US = 12000;
+
+struct Channel {
+    int32_t id = 0;
+    std::vector<uint8_t> pixels;   // RGB
+    std::vector<uint8_t> encoded;  // Three wire bits per data bit
+};
+
+std::mutex flash_lock;  // Held by the NVS commit; the render path runs from "flash"
+
+void render(Channel& ch, uint32_t frame) {
+    std::lock_guard<std::mutex> lock(flash_lock);
+    const size_t count = ch.pixels.size() / 3;
+    for (size_t i = 0; i < count; ++i) {
+        const auto hue = static_cast<uint8_t>(i * 256 / count + frame * 2);
+        ch.pixels[i * 3 + 0] = hue;
+        ch.pixels[i * 3 + 1] = static_cast<uint8_t>(255 - hue);
+        ch.pixels[i * 3 + 2] = static_cast<uint8_t>(hue * 3);
+    }
+}
+
+void limit(Channel& ch, uint32_t budget_ma) {
+    uint32_t ma = 0;
+    for (const uint8_t v : ch.pixels) ma += v * 20u / 255;
+    if (ma <= budget_ma) return;
+    const uint32_t scale = budget_ma * 256 / ma;
+    for (uint8_t& v : ch.pixels) v = static_cast<uint8_t>(v * scale >> 8);
+}
+
+void encode(Channel& ch) {
+    size_t pos = 0;
+    for (const uint8_t v : ch.pixels) {
+        uint32_t bits = 0;
+        for (int b = 7; b >= 0; --b) bits = (bits << 3) | ((v >> b) & 1 ? 0b110u : 0b100u);
+        ch.encoded[pos++] = static_cast<uint8_t>(bits >> 16);
+        ch.encoded[pos++] = static_cast<uint8_t>(bits >> 8);
+        ch.encoded[pos++] = static_cast<uint8_t>(bits);
+    }
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    const int channels = argc > 1 ? std::atoi(argv[1]) : 4;
+    const int pixels = argc > 2 ? std::atoi(argv[2]) : 300;
+    const int rate_hz = argc > 3 ? std::atoi(argv[3]) : 60;
+    const int seconds = argc > 4 ? std::atoi(argv[4]) : 5;
+    const char* out_path = argc > 5 ? argv[5] : "pixtrace.json";
+    if (channels < 1 || channels > 32 || pixels < 1 || rate_hz < 1 || seconds < 1) {
+        std::fprintf(stderr, "usage: pixtrace [channels 1-32] [pixels] [rate_hz] [seconds] [out.json]\n");
+        return 2;
+    }
+
+    std::vector<Channel> chans(channels);
+    for (int i = 0; i < channels; ++i) {
+        chans[i].id = i;
+        chans[i].pixels.resize(pixels * 3);
+        chans[i].encoded.resize(pixels * 9);
+    }
+    const uint32_t wire_us = pixels * WIRE_US_PER_PIXEL + RESET_US;
+    const auto frame_period = std::chrono::microseconds(1000000 / rate_hz);
+
+    std::atomic<bool> running{true};
+    std::mutex kick_mutex;
+    std::condition_variable kick_cv;
+    bool kicked = false;
+
+    std::thread transmit([&] {
+        while (true) {
+            std::unique_lock<std::mutex> lock(kick_mutex);
+            kick_cv.wait(lock, [&] { return kicked || !running; });
+            if (!kicked) return;
+            kicked = false;
+            lock.unlock();
+
+            // All channels start back to back and run for the same wire time
+            uint32_t done_us = 0;
+            {
+                PIXTRACE_SCOPE("start frame", TraceLane::Transmit);
+                for (const Channel& ch : chans) PIXTRACE_BEGIN("dma", TraceLane::Dma, ch.id);
+                done_us = traceNowUs() + wire_us;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(wire_us));
+            for (const Channel& ch : chans) PIXTRACE_END_AT(done_us, "dma", TraceLane::Dma, ch.id);
+            PIXTRACE_SCOPE("present", TraceLane::Transmit);
+        }
+    });
+
+    std::thread api([&] {
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            PIXTRACE_SCOPE("nvs save", TraceLane::Api, 0);
+            std::lock_guard<std::mutex> lock(flash_lock);
+            std::this_thread::sleep_for(std::chrono::microseconds(NVS_COMMIT_US));
+        }
+    });
+
+    uint32_t frames = 0;
+    uint32_t late = 0;
+    uint32_t worst_us = 0;
+    auto next = std::chrono::steady_clock::now();
+    const auto end = next + std::chrono::seconds(seconds);
+    while (next < end) {
+        const uint32_t start_us = traceNowUs();
+        PIXTRACE_BEGIN("frame", TraceLane::Driver);
+        for (Channel& ch : chans) {
+            PIXTRACE_BEGIN("render", TraceLane::Driver, ch.id);
+            render(ch, frames);
+            PIXTRACE_END("render", TraceLane::Driver, ch.id);
+        }
+        for (Channel& ch : chans) {
+            PIXTRACE_BEGIN("limit", TraceLane::Driver, ch.id);
+            limit(ch, 2000);
+            PIXTRACE_END("limit", TraceLane::Driver, ch.id);
+        }
+        for (Channel& ch : chans) {
+            PIXTRACE_BEGIN("encode", TraceLane::Driver, ch.id);
+            encode(ch);
+            PIXTRACE_END("encode", TraceLane::Driver, ch.id);
+        }
+        PIXTRACE_INSTANT("kick", TraceLane::Driver);
+        {
+            std::lock_guard<std::mutex> lock(kick_mutex);
+            kicked = true;
+        }
+        kick_cv.notify_one();
+        PIXTRACE_END("frame", TraceLane::Driver);
+
+        const uint32_t work_us = traceNowUs() - start_us;
+        worst_us = std::max(worst_us, work_us);
+        if (std::chrono::microseconds(work_us) > frame_period) ++late;
+        ++frames;
+        next += frame_period;
+        std::this_thread::sleep_until(next);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(kick_mutex);
+        running = false;
+    }
+    kick_cv.notify_one();
+    transmit.join();
+    api.join();
+
+    std::FILE* out = std::fopen(out_path, "w");
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", out_path);
+        return 1;
+    }
+    const size_t events = writeChromeTrace(pixelTrace(), [out](const char* data, size_t length) {
+        std::fwrite(data, 1, length, out);
+    });
+    std::fclose(out);
+
+    std::printf("%u frames, %u over %lld us, worst frame work %u us\n", frames, late,
+                static_cast<long long>(frame_period.count()), worst_us);
+    std::printf("%zu of %u events written to %s\n", events, pixelTrace().recorded(), out_path);
+    return 0;
+}